@@ -17,6 +17,7 @@
 #define SERIALIZER_NUMBER_ERR " errored while serializing number"
 #define SERIALIZER_INVALID_JSON_ERR " trying to serialize invalid json element"
 #define UNREACHABLE_ERR " unreachable code!"
+#define POOLED_NODE_ERR " operation not supported on arena document element"
 
 /* Warnings text */
 #define OVERFLOW_WARN " detected overflow"
@@ -35,7 +36,8 @@ enum {
   InvalidValue = 10,
   SerializerNumberError = 11,
   SerializerInvalidJson = 12,
-  UnreachableCode = 13
+  UnreachableCode = 13,
+  PooledNode = 14
 };
 
 /* Possible Warnings */
@@ -91,6 +93,9 @@ enum { OverflowDetected = 128 };
     case UnreachableCode:                                                      \
       errmsg = filename ":" STRINGIFY(line) UNREACHABLE_ERR "\n";              \
       break;                                                                   \
+    case PooledNode:                                                           \
+      errmsg = filename ":" STRINGIFY(line) POOLED_NODE_ERR "\n";              \
+      break;                                                                   \
     }                                                                          \
     SK_PRINT_ERR(errmsg);                                                      \
   } while (0)
@@ -98,20 +103,20 @@ enum { OverflowDetected = 128 };
 /* Throw error to stderr */
 #define THROW_ERR(err) SK_ERROR_FORMAT(__FILE__, __LINE__, err)
 
-/* Warnings format */
-#define SK_WARNING_FORMAT(warn, ln, col)                                       \
+/* Warnings format, byte offset of the offending token is only known at runtime */
+#define SK_WARNING_FORMAT(warn, offset)                                        \
   do {                                                                         \
     const char *warnmsg;                                                       \
     switch (warn) {                                                            \
     case OverflowDetected:                                                     \
-      warnmsg = STRINGIFY(ln) ":" STRINGIFY(col) OVERFLOW_WARN;                \
+      warnmsg = OVERFLOW_WARN;                                                 \
       break;                                                                   \
     }                                                                          \
-    SK_PRINT_ERR(warnmsg);                                                     \
+    fprintf(stderr, "offset %lu:%s\n", (unsigned long)(offset), warnmsg);      \
   } while (0)
 
-/* Throw warning to stderr */
-#define THROW_WARN(warn, scanner)                                              \
-  SK_WARNING_FORMAT(warn, scanner->iter.state.ln, scanner->iter.state.col)
+/* Throw warning to stderr. Only the byte 'offset' is reported, line and
+ * column would mean rescanning the buffer for every warning. */
+#define THROW_WARN(warn, offset) SK_WARNING_FORMAT(warn, offset)
 
 #endif
@@ -6,6 +6,7 @@
 #include "skutils.h"
 #include "skvec.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define has_key_destructor(table) (table) != NULL && (table)->free_key != NULL
 #define has_val_destructor(table) (table) != NULL && (table)->free_val != NULL
@@ -124,6 +125,9 @@ static bool _skHashTable_expand(skHashTable* table)
     skVec*         old_storage;
     unsigned char* old_allocation;
     skHashCell*    current;
+#ifdef SK_DBUG
+    size_t old_len;
+#endif
 
     if(is_null(table)) {
         return false;
@@ -145,6 +149,8 @@ static bool _skHashTable_expand(skHashTable* table)
                 return false;
             }
 
+            /* Empty cells are the ones that are not taken */
+            memset(skVec_inner_unsafe(new_storage), 0, prime * ele_size);
             break;
         }
     }
@@ -163,8 +169,12 @@ static bool _skHashTable_expand(skHashTable* table)
 
     old_allocation = skVec_inner_unsafe(old_storage);
     current        = NULL;
+#ifdef SK_DBUG
+    old_len = table->len;
+#endif
+    table->len = 0;
 
-    /* Re-hash all the keys */
+    /* Re-hash all the keys, inserting counts them again */
     while(old_cap--) {
         if((current = (skHashCell*) old_allocation)->taken) {
 #ifdef SK_DBUG
@@ -179,7 +189,7 @@ static bool _skHashTable_expand(skHashTable* table)
     }
 
 #ifdef SK_DBUG
-    assert(skVec_len(old_storage) == skVec_len(table->storage));
+    assert(old_len == table->len);
 #endif
 
     /* Drop the boomer */
@@ -191,22 +201,25 @@ void* _skHashTable_probe(const skHashTable* table, const void* key, bool* found)
 {
     skVec*      cells;
     size_t      storage_size;
+    size_t      home;
     size_t      index;
     skHashCell* cell;
-    int         i;
+    size_t      i;
 
     *found       = false;
     cells        = table->storage;
     storage_size = skVec_capacity(table->storage);
-    index        = (table->hash_fn(key)) % storage_size;
+    home         = (table->hash_fn(key)) % storage_size;
+    index        = home;
     cell         = skVec_index_unsafe(cells, index);
 
     for(i = 1; (!(*found) && cell->taken); i++) {
         if(table->cmp_key(cell->key, key) == 0) {
             *found = true;
         } else {
-            /* Keys didn't match, keep probing */
-            index = (index + (i * i)) % storage_size;
+            /* Keys didn't match, keep probing. Table size is a prime and it is
+             * at most half full so the first half of the sequence hits a free cell. */
+            index = (home + (i * i)) % storage_size;
             cell  = skVec_index_unsafe(cells, index);
         }
     }
@@ -230,6 +243,11 @@ void* skHashTable_get(const skHashTable* table, const void* key)
         return NULL;
     }
 
+    /* Nothing was inserted yet, there are no cells to probe */
+    if(skVec_capacity(table->storage) == 0) {
+        return NULL;
+    }
+
     found = false;
     cell  = _skHashTable_probe(table, key, &found);
 
@@ -0,0 +1,358 @@
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+/* clang-format off */
+#include "skerror.h"
+#include "skindex.h"
+#include "skutils.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SK_SSE2
+#endif
+/* clang-format on */
+
+/* Number of bytes classified at once */
+#define BLOCK_SIZE 32
+/* Mask with a bit set for each byte of the block ('unsigned long' is
+ * at least 32 bits wide so one block always fits into it). */
+#define BLOCK_MASK 0xFFFFFFFFUL
+#define BLOCK_TOP  0x80000000UL
+
+#if defined(__GNUC__)
+#define lowest_bit_pos(mask) __builtin_ctzl(mask)
+#else
+static int lowest_bit_pos(unsigned long mask)
+{
+    int pos;
+    for(pos = 0; !(mask & 1); pos++) {
+        mask >>= 1;
+    }
+    return pos;
+}
+#endif
+
+/* Classification of a single block, each bit corresponds to one byte */
+typedef struct {
+    unsigned long structural; /* '{', '}', '[', ']', ':', ',' */
+    unsigned long quote;      /* '"' */
+    unsigned long backslash;  /* '\\' */
+    unsigned long whitespace; /* ' ', '\t', '\n' */
+} skBlockMasks;
+
+/* State carried over from the previous block */
+typedef struct {
+    unsigned long escaped;   /* First byte of the block is escaped */
+    unsigned long in_string; /* Block starts inside of a string */
+    unsigned long scalar;    /* Last byte of previous block was scalar */
+} skBlockCarry;
+
+#if defined(__AVX2__)
+static unsigned long eq_mask(__m256i block, char c)
+{
+    return (unsigned long) (unsigned int) _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(block, _mm256_set1_epi8(c)));
+}
+
+static void skBlock_classify(const char* bytes, skBlockMasks* masks)
+{
+    __m256i block;
+    __m256i folded;
+
+    block  = _mm256_loadu_si256((const __m256i*) bytes);
+    /* '[' | 0x20 == '{' and ']' | 0x20 == '}' */
+    folded = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+
+    masks->structural = eq_mask(folded, '{') | eq_mask(folded, '}') | eq_mask(block, ':')
+                        | eq_mask(block, ',');
+    masks->quote      = eq_mask(block, '"');
+    masks->backslash  = eq_mask(block, '\\');
+    masks->whitespace = eq_mask(block, ' ') | eq_mask(block, '\t') | eq_mask(block, '\n');
+}
+#elif defined(SK_SSE2)
+static unsigned long eq_mask(__m128i lo, __m128i hi, char c)
+{
+    __m128i needle;
+
+    needle = _mm_set1_epi8(c);
+    return (unsigned long) (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(lo, needle))
+           | ((unsigned long) (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(hi, needle))
+              << 16);
+}
+
+static void skBlock_classify(const char* bytes, skBlockMasks* masks)
+{
+    __m128i lo, hi;
+    __m128i flo, fhi;
+    __m128i case_bit;
+
+    lo       = _mm_loadu_si128((const __m128i*) bytes);
+    hi       = _mm_loadu_si128((const __m128i*) (bytes + 16));
+    /* '[' | 0x20 == '{' and ']' | 0x20 == '}' */
+    case_bit = _mm_set1_epi8(0x20);
+    flo      = _mm_or_si128(lo, case_bit);
+    fhi      = _mm_or_si128(hi, case_bit);
+
+    masks->structural = eq_mask(flo, fhi, '{') | eq_mask(flo, fhi, '}')
+                        | eq_mask(lo, hi, ':') | eq_mask(lo, hi, ',');
+    masks->quote      = eq_mask(lo, hi, '"');
+    masks->backslash  = eq_mask(lo, hi, '\\');
+    masks->whitespace = eq_mask(lo, hi, ' ') | eq_mask(lo, hi, '\t') | eq_mask(lo, hi, '\n');
+}
+#else
+static void skBlock_classify(const char* bytes, skBlockMasks* masks)
+{
+    unsigned long bit;
+    int           i;
+
+    memset(masks, 0, sizeof(skBlockMasks));
+
+    for(i = 0, bit = 1; i < BLOCK_SIZE; i++, bit <<= 1) {
+        switch(bytes[i]) {
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                masks->structural |= bit;
+                break;
+            case '"':
+                masks->quote |= bit;
+                break;
+            case '\\':
+                masks->backslash |= bit;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+                masks->whitespace |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+}
+#endif
+
+/* Returns mask of bytes escaped by a preceding backslash.
+ * Backslashes are rare so we just walk them in order, a backslash that
+ * is itself escaped doesn't escape the following byte. */
+static unsigned long skBlock_escaped(unsigned long backslash, skBlockCarry* carry)
+{
+    unsigned long escaped;
+    unsigned long bit;
+
+    escaped        = carry->escaped;
+    carry->escaped = 0;
+
+    while(backslash) {
+        bit = backslash & (0 - backslash);
+        if(!(escaped & bit)) {
+            if(bit == BLOCK_TOP) {
+                carry->escaped = 1;
+            } else {
+                escaped |= bit << 1;
+            }
+        }
+        backslash ^= bit;
+    }
+
+    return escaped;
+}
+
+/* Sets every bit from each quote up to (but excluding) the next quote */
+static unsigned long prefix_xor(unsigned long mask)
+{
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    return mask & BLOCK_MASK;
+}
+
+/* Returns the mask of indexed bytes in the block */
+static unsigned long skBlock_structurals(const char* bytes, skBlockCarry* carry)
+{
+    skBlockMasks  masks;
+    unsigned long quotes;
+    unsigned long in_string;
+    unsigned long scalar;
+    unsigned long atoms;
+
+    skBlock_classify(bytes, &masks);
+
+    quotes    = masks.quote & ~skBlock_escaped(masks.backslash, carry);
+    in_string = prefix_xor(quotes) ^ (carry->in_string ? BLOCK_MASK : 0);
+
+    carry->in_string = in_string & BLOCK_TOP;
+
+    /* Scalars are bytes outside of strings that are neither
+     * structural, quote or whitespace, we only care where they start. */
+    scalar        = ~(masks.structural | masks.quote | masks.whitespace | in_string) & BLOCK_MASK;
+    atoms         = scalar & ~(((scalar << 1) | (carry->scalar ? 1 : 0)) & BLOCK_MASK);
+    carry->scalar = scalar & BLOCK_TOP;
+
+    return (masks.structural & ~in_string) | quotes | atoms;
+}
+
+/* Makes room for 'additional' elements in the growable 'array' of 'len' elements */
+static bool reserve_array(size_t** array, size_t* capacity, size_t len, size_t additional)
+{
+    size_t  cap;
+    size_t* grown;
+
+    if(*capacity - len >= additional) {
+        return true;
+    }
+
+    cap = (*capacity == 0) ? 64 : *capacity * 2;
+    while(cap - len < additional) {
+        cap *= 2;
+    }
+
+    if(is_null(grown = realloc(*array, cap * sizeof(size_t)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return false;
+    }
+
+    *array    = grown;
+    *capacity = cap;
+    return true;
+}
+
+/* Counts the elements of every container, 'open' holds the positions
+ * in 'sizes' of the containers that are still open. */
+static bool skStructIndex_count(skStructIndex* index, const char* buffer)
+{
+    size_t depth;
+    size_t i;
+    char   c;
+
+    depth = 0;
+
+    for(i = 0; i < index->len; i++) {
+        switch(c = buffer[index->offsets[i]]) {
+            case '{':
+            case '[':
+                if(!reserve_array(&index->sizes, &index->sizes_cap, index->nsizes, 1)
+                   || !reserve_array(&index->open, &index->open_cap, depth, 1))
+                {
+                    return false;
+                }
+                /* Container with anything in it has one more element than commas */
+                c = (i + 1 < index->len) ? buffer[index->offsets[i + 1]] : '\0';
+                index->sizes[index->nsizes] = (c == '}' || c == ']') ? 0 : 1;
+                index->open[depth++]        = index->nsizes++;
+                break;
+            case ',':
+                if(depth > 0) {
+                    index->sizes[index->open[depth - 1]]++;
+                }
+                break;
+            case '}':
+            case ']':
+                if(depth > 0) {
+                    depth--;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return true;
+}
+
+void skStructIndex_init(skStructIndex* index)
+{
+    memset(index, 0, sizeof(skStructIndex));
+}
+
+bool skStructIndex_build(skStructIndex* index, const char* buffer, size_t len)
+{
+    skBlockCarry  carry;
+    unsigned long mask;
+    char          tail[BLOCK_SIZE];
+    const char*   block;
+    size_t        base;
+
+    index->len    = 0;
+    index->nsizes = 0;
+
+    memset(&carry, 0, sizeof(skBlockCarry));
+
+    for(base = 0; base < len; base += BLOCK_SIZE) {
+        if(len - base < BLOCK_SIZE) {
+            /* Pad the last block with whitespace, it never gets indexed */
+            memset(tail, ' ', BLOCK_SIZE);
+            memcpy(tail, buffer + base, len - base);
+            block = tail;
+        } else {
+            block = buffer + base;
+        }
+
+        /* Reserve for the worst case plus the sentinel */
+        if(!reserve_array(&index->offsets, &index->capacity, index->len, BLOCK_SIZE + 1)) {
+            return false;
+        }
+
+        mask = skBlock_structurals(block, &carry);
+        while(mask) {
+            index->offsets[index->len++] = base + lowest_bit_pos(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    if(!reserve_array(&index->offsets, &index->capacity, index->len, 1)) {
+        return false;
+    }
+
+    /* Sentinel */
+    index->offsets[index->len] = len;
+
+    return skStructIndex_count(index, buffer);
+}
+
+void skStructIndex_release(skStructIndex* index)
+{
+    free(index->offsets);
+    free(index->sizes);
+    free(index->open);
+    skStructIndex_init(index);
+}
+
+skStructIndex* skStructIndex_new(const char* buffer, size_t len)
+{
+    skStructIndex* index;
+
+    if(is_null(index = malloc(sizeof(skStructIndex)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return NULL;
+    }
+
+    skStructIndex_init(index);
+
+    if(!skStructIndex_build(index, buffer, len)) {
+        skStructIndex_drop(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+void skStructIndex_drop(skStructIndex* index)
+{
+    if(is_some(index)) {
+        skStructIndex_release(index);
+        free(index);
+    }
+}
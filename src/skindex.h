@@ -0,0 +1,59 @@
+#ifndef __SK_INDEX_H__
+#define __SK_INDEX_H__
+
+#include "sktypes.h"
+#include <stddef.h>
+
+/**
+ * Structural index of the Json buffer (stage 1 of the parser).
+ * Contains offsets of every structural character ('{', '}', '[', ']',
+ * ':', ','), every unescaped quote and the first byte of every scalar
+ * (number, true, false, null) that is not part of the Json string.
+ * Offsets are stored in ascending order and the array is terminated
+ * with a sentinel offset equal to the buffer length.
+ */
+typedef struct {
+  size_t *offsets;
+  size_t len;
+  size_t capacity;
+  /* Element counts of the containers in the order of their opening
+   * brackets, counted from the commas on their level. Only a hint
+   * if the buffer is not a valid Json. */
+  size_t *sizes;
+  size_t nsizes;
+  size_t sizes_cap;
+  /* Scratch stack of the containers open while counting */
+  size_t *open;
+  size_t open_cap;
+} skStructIndex;
+
+/**
+ * Classifies BUFFER of LEN bytes block by block and builds the
+ * structural index, then counts the elements of every container in
+ * one pass over the index. Returns NULL if allocation failed.
+ */
+skStructIndex *skStructIndex_new(const char *buffer, size_t len);
+
+/**
+ * Frees the INDEX and its offsets.
+ */
+void skStructIndex_drop(skStructIndex *index);
+
+/**
+ * Initializes caller owned INDEX to the empty index without allocating.
+ */
+void skStructIndex_init(skStructIndex *index);
+
+/**
+ * Rebuilds caller owned INDEX for BUFFER of LEN bytes, storage of the
+ * previous build is reused and only grows if it is too small.
+ * Returns false if allocation failed, INDEX can be rebuilt afterwards.
+ */
+bool skStructIndex_build(skStructIndex *index, const char *buffer, size_t len);
+
+/**
+ * Frees the storage of caller owned INDEX.
+ */
+void skStructIndex_release(skStructIndex *index);
+
+#endif
@@ -1,14 +1,21 @@
 /* clang-format off */
+#define _POSIX_C_SOURCE 200112L /* mmap and posix_madvise */
 #ifdef SK_DBUG
 #include <assert.h>
 #endif
 #include "skerror.h"
+#include "sknumber.h"
 #include "skparser.h" /* Make sure skparser.h which includes sknode.h is included before skjson.h */
 #include "skjson.h"
+#include "skutf8.h"
 #include "skutils.h"
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /* clang-format on */
 
@@ -17,22 +24,17 @@
 /* Check if the node is valid (not null) and matches the type 't' */
 #define valid_with_type(node, t) ((node) != NULL && (node)->type == (t))
 /* Check if 'node' has a parent. */
-#define has_parent(node)         (is_some((node)->parent_arena.ptr))
-/* Link the node with the parent arena */
-#define link_parent(node, parent)                                             \
-    do {                                                                      \
-        (node)->parent_arena.ptr  = skVec_inner_unsafe(parent->data.j_array); \
-        (node)->parent_arena.type = parent->type;                             \
-    } while(0)
+#define has_parent(node)         ((node)->flags & SK_NODE_LINKED)
+/* Link the node with the parent container */
+#define link_parent(node, parent) \
+    ((node)->flags = ((node)->flags & ~SK_NODE_LINKED) | Node_link_of(parent))
 /* Unlinks the node from the parent */
-#define unlink_parent(node)           \
-    (node)->parent_arena.ptr  = NULL; \
-    (node)->parent_arena.type = SK_NONE_NODE
-/* Copies the link of 'dst' node into 'src' node. Then they will point to the
- * same parent_arena. */
-#define copylink(src, dst)                              \
-    (src)->parent_arena.ptr  = (dst)->parent_arena.ptr; \
-    (src)->parent_arena.type = (dst)->parent_arena.type
+#define unlink_parent(node)      ((node)->flags &= ~SK_NODE_LINKED)
+/* Check if the node owns memory (string, container storage or raw number text) */
+#define has_payload(node) \
+    ((node)->type & (SK_STRING_NODE | SK_ARRAY_NODE | SK_OBJECT_NODE | SK_RAWNUM_NODE))
+/* Check if the node belongs to a document parsed with 'skJson_parse_arena' */
+#define is_pooled(node) ((node)->flags & SK_NODE_POOLED)
 /* Checks if node is SK_NONE_NODE or SK_ERROR_NODE */
 #define err_or_none(node) ((node)->type & (SK_NONE_NODE | SK_ERROR_NODE))
 
@@ -49,12 +51,16 @@ typedef skJsonBool (*CStrPush)(skJson*, const char*);
 /* clang-format off */
 
 /* Internal functions */
+PRIVATE(skJson) skJson_parse_internal(char* buff, size_t bufsize, int flags);
+PRIVATE(skJsonDoc*) skJson_parse_arena_internal(char* buff, size_t bufsize, int flags);
 PRIVATE(void) drop_nonprim_elements(skJson* json);
+PRIVATE(skJsonBool) adopt_element(skJson* element, const skJson* parent);
 PRIVATE(skJson) skJson_string_new_internal(const char* string, skNodeType type, skJson* parent);
 PRIVATE(skJson) skJson_constructor_internal(void* val, skNodeType type, skJson* parent);
 PRIVATE(skJsonBool) skJson_array_insert_internal(skJson* parent, const void* val, skNodeType type, size_t index, skJsonBool push, skJsonBool element);
 PRIVATE(skJsonBool) array_push_node_checked(skJson* json, skJson* node);
 PRIVATE(int) compare_tuples(const skObjTuple* a, const skObjTuple* b);
+PRIVATE(skObjTuple*) object_find(const skJson* json, const char* key, skJsonBool sorted);
 PRIVATE(skJsonBool) skJson_object_insert_internal(skJson* parent, const char* key, const void* val, skNodeType type, size_t index, skJsonBool push, skJsonBool element);
 PRIVATE(Serializer) Serializer_new(size_t bufsize, skJsonBool expand);
 PRIVATE(Serializer) Serializer_from(unsigned char* buffer, size_t bufsize, skJsonBool expand);
@@ -83,106 +89,281 @@ struct _Serializer {
     skJsonBool           user_provided;
 };
 
-PUBLIC(skJson) skJson_parse(char* buff, size_t bufsize)
+PRIVATE(skJson) skJson_parse_internal(char* buff, size_t bufsize, int flags)
 {
-    skScanner* scanner;
-    skJson json;
+    skScanner     scanner;
+    skStructIndex index;
+    skJson        json;
 
     json.type = SK_NONE_NODE;
 
-    if(is_null(buff) || bufsize == 0 || is_null(scanner = skScanner_new(buff, bufsize))) {
+    if(is_null(buff) || bufsize == 0) {
+        return json;
+    }
+
+    /* Scanner lives on the stack, only the index storage is allocated */
+    skStructIndex_init(&index);
+    if(!skStructIndex_build(&index, buff, bufsize)) {
+        skStructIndex_release(&index);
         return json;
     }
 
+    skScanner_init(&scanner, buff, bufsize);
+    scanner.index       = &index;
+    scanner.insitu      = (flags & SKJS_FILE_BORROW) != 0;
+    scanner.raw_numbers = (flags & SKJS_RAW_NUMBERS) != 0;
+
     /* Fetch first token */
-    skScanner_next(scanner); 
+    skScanner_next(&scanner);
     /* Construct the parse tree */
-    json = skJsonNode_parse(scanner, NULL);
+    json = skJsonNode_parse(&scanner, NULL);
     /* We are done scanning */
-    free(scanner);
+    skStructIndex_release(&index);
 
     return json;
 }
 
-PUBLIC(const char*) skJson_error(const skJson* json)
+PUBLIC(skJson) skJson_parse(char* buff, size_t bufsize)
 {
-    if(valid_with_type(json, SK_ERROR_NODE)) {
-        return json->data.j_err;
-    } else {
+    return skJson_parse_internal(buff, bufsize, 0);
+}
+
+PUBLIC(skJson) skJson_parse_insitu(char* buff, size_t bufsize)
+{
+    return skJson_parse_internal(buff, bufsize, SKJS_FILE_BORROW);
+}
+
+PUBLIC(skJson) skJson_parse_flags(char* buff, size_t bufsize, int flags)
+{
+    return skJson_parse_internal(buff, bufsize, flags);
+}
+
+/* Json document, allocated from its own arena together with all of its elements
+ * (if 'pool' is set) and owner of the mapped file its strings might point into. */
+struct skJsonDoc {
+    skPool* pool;
+    skJson  root;
+    void*   map;
+    size_t  maplen;
+};
+
+PRIVATE(skJsonDoc*) skJson_parse_arena_internal(char* buff, size_t bufsize, int flags)
+{
+    skScanner* scanner;
+    skPool*    pool;
+    skJsonDoc* doc;
+
+    if(is_null(buff) || bufsize == 0) {
+        return NULL;
+    }
+
+    /* Parsed tree is usually about as large as the input, start with twice
+     * of that so the most documents fit into the first chunk */
+    if(is_null(pool = skPool_new(bufsize * 2))) {
+        return NULL;
+    }
+
+    if(is_null(doc = skPool_alloc(pool, sizeof(skJsonDoc)))
+       || is_null(scanner = skScanner_new_indexed(buff, bufsize)))
+    {
+        skPool_drop(pool);
+        return NULL;
+    }
+
+    doc->pool            = pool;
+    doc->map             = NULL;
+    doc->maplen          = 0;
+    scanner->pool        = pool;
+    scanner->insitu      = (flags & SKJS_FILE_BORROW) != 0;
+    scanner->raw_numbers = (flags & SKJS_RAW_NUMBERS) != 0;
+
+    /* Fetch first token */
+    skScanner_next(scanner);
+    /* Construct the parse tree */
+    doc->root = skJsonNode_parse(scanner, NULL);
+    /* We are done scanning */
+    skScanner_drop(scanner);
+
+    if(doc->root.type == SK_NONE_NODE) {
+        skPool_drop(pool);
+        return NULL;
+    }
+
+    doc->root.flags |= SK_NODE_POOLED;
+
+    return doc;
+}
+
+PUBLIC(skJsonDoc*) skJson_parse_arena(char* buff, size_t bufsize)
+{
+    return skJson_parse_arena_internal(buff, bufsize, 0);
+}
+
+PUBLIC(skJsonDoc*) skJson_parse_file(const char* path, int flags)
+{
+    struct stat info;
+    skJsonDoc*  doc;
+    char*       map;
+    size_t      len;
+    int         fd;
+    skJsonBool  borrow;
+
+    if(is_null(path) || (fd = open(path, O_RDONLY)) == -1) {
+        return NULL;
+    }
+
+    if(fstat(fd, &info) == -1 || info.st_size <= 0 || (off_t) (len = info.st_size) != info.st_size) {
+        close(fd);
+        return NULL;
+    }
+
+    borrow = (flags & SKJS_FILE_BORROW) != 0;
+    /* Private mapping, terminating the borrowed strings never reaches the file */
+    map = mmap(NULL, len, PROT_READ | (borrow ? PROT_WRITE : 0), MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(map == MAP_FAILED) {
+        return NULL;
+    }
+
+    /* Both the indexing and the parsing pass go through the file front to back */
+    posix_madvise(map, len, POSIX_MADV_SEQUENTIAL);
+
+    if(flags & SKJS_FILE_ARENA) {
+        doc = skJson_parse_arena_internal(map, len, flags);
+    } else if(is_null(doc = malloc(sizeof(skJsonDoc)))) {
 #ifdef SK_ERRMSG
-        THROW_ERR(WrongNodeType);
+        THROW_ERR(OutOfMemory);
 #endif
+    } else {
+        doc->pool = NULL;
+        if((doc->root = skJson_parse_internal(map, len, flags)).type == SK_NONE_NODE) {
+            free(doc);
+            doc = NULL;
+        }
+    }
+
+    if(is_null(doc) || !borrow) {
+        munmap(map, len);
+    }
+
+    if(is_some(doc)) {
+        doc->map    = borrow ? map : NULL;
+        doc->maplen = borrow ? len : 0;
+    }
+
+    return doc;
+}
+
+PUBLIC(skJson*) skJsonDoc_root(skJsonDoc* doc)
+{
+    if(is_null(doc)) {
         return NULL;
     }
+
+    return &doc->root;
 }
 
-/* Drops the node preserving valid json state according to json standard. 
- * Reason for why array and object logic is separated even though it is exactly the same
- * is in case of future updates/rewrites where Json Object might be using different
- * data-structure other than vector internally. That way it will easier to maintain
- * this code, therefore the separate member of union called 'j_object' even though
- * currently it is the same data structure as 'j_array'. */
-PUBLIC(void) skJson_drop(skJson* json)
+PUBLIC(void) skJsonDoc_drop(skJsonDoc* doc)
 {
-    void* arena;
-    skJson null_node;
-    skJson* old_node;
-    size_t  idx;
+    skPool* pool;
 
-    if(is_null(json) || json->type == SK_NONE_NODE) {
+    if(is_null(doc)) {
         return;
     }
 
-    if(is_some((arena = json->parent_arena.ptr))) {
-        switch(json->parent_arena.type) {
-            /* In case we are directly dropping value of the array_node, replace
-             * it with null node instead. Actually removing the entry from array node
-             * is done using array node functions defined on it. */
-            case SK_ARRAY_NODE:
-                idx = ((char*) json - (char*) skVec_inner_unsafe((skVec*)arena)) 
-                    / sizeof(skJson);
+    if(!is_pooled(&doc->root)) {
+        skJsonNode_drop(&doc->root);
+    }
 
-                null_node = RawNode_new(SK_NULL_NODE, NULL);
-                copylink(&null_node, json);
+    /* Strings of the tree might point into the mapping */
+    if(is_some(doc->map)) {
+        munmap(doc->map, doc->maplen);
+    }
 
-                old_node = skVec_index((skVec*) arena, idx);
-                skJsonNode_drop(old_node);
-                memcpy(old_node, &null_node, sizeof(skJson));
+    if(is_some(pool = doc->pool)) {
+        skPool_drop(pool);
+    } else {
+        free(doc);
+    }
+}
 
-                break;
-            case SK_OBJECT_NODE:
-                /* If this 'json' node is a child of object node then replace it
-                 * with null node instead, in order to remove an entry from object node
-                 * you must use the functions defined on the object node. That is the
-                 * only way to soundly drop the key/value pair and preserve json validity. */
-                idx = ((char*) json - (char*) skVec_inner_unsafe((skVec*)arena)) 
-                    / sizeof(skObjTuple);
-
-                null_node = RawNode_new(SK_NULL_NODE, NULL);
-                copylink(&null_node, json);
-
-                /* Returning skObjTuple from the vec but we need only node so cast it 
-                 * into skJson node and drop it. */
-                old_node = skVec_index((skVec*) arena, idx);
-                skJsonNode_drop(old_node);
-                memcpy(old_node, &null_node, sizeof(skJson));
+/* Descriptions of the parse errors indexed by their code */
+static const char* const skJson_errors[] = {
+    NULL, SK_TOKEN_ERR, SK_OBJECT_ERR, SK_ARRAY_ERR, SK_DEPTH_ERR, SK_STRING_ERR, SK_NUMBER_ERR,
+};
 
-                break;
-            default:
+PUBLIC(const char*) skJson_error(const skJson* json)
+{
+    if(valid_with_type(json, SK_ERROR_NODE)) {
+        return skJson_errors[ErrorNode_code(json)];
+    } else {
 #ifdef SK_ERRMSG
-                THROW_ERR(UnreachableCode);
+        THROW_ERR(WrongNodeType);
 #endif
-#ifdef SK_DBUG
-                assert(false);
+        return NULL;
+    }
+}
+
+PUBLIC(skJsonBool) skJson_error_info(const skJson* json, skJsonError* err)
+{
+    if(is_null(err) || !valid_with_type(json, SK_ERROR_NODE)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(WrongNodeType);
 #endif
-                break;
-        }
+        return false;
+    }
+
+    err->code   = ErrorNode_code(json);
+    err->offset = ErrorNode_offset(json);
+    err->depth  = ErrorNode_depth(json);
+    return true;
+}
+
+PUBLIC(size_t) skJson_error_format(const skJson* json, char* buff, size_t bufsize)
+{
+    /* Longest description and two 64-bit numbers fit with room to spare */
+    char   msg[128];
+    size_t len;
+
+    if(is_null(skJson_error(json))) {
+        return 0;
+    }
+
+    len = sprintf(
+        msg,
+        "%s: offset %lu, depth %lu",
+        skJson_errors[ErrorNode_code(json)],
+        (unsigned long) ErrorNode_offset(json),
+        (unsigned long) ErrorNode_depth(json));
+
+    if(is_some(buff) && bufsize > 0) {
+        memcpy(buff, msg, (len < bufsize) ? len : bufsize - 1);
+        buff[(len < bufsize) ? len : bufsize - 1] = '\0';
+    }
+
+    return len;
+}
+
+/* Drops the node preserving valid json state according to json standard.
+ * Element of the array or value of the object member lives in the storage of
+ * its container, it is replaced with null node in place instead. Actually removing
+ * the entry is done using the array/object functions defined on the container,
+ * that is the only way to soundly drop the key/value pair and preserve json validity. */
+PUBLIC(void) skJson_drop(skJson* json)
+{
+    if(is_null(json) || json->type == SK_NONE_NODE) {
+        return;
+    }
+
+    skJsonNode_drop(json);
+
+    if(has_parent(json)) {
+        /* Keeps the flags, key of the object member is still owned the same way */
+        json->type = SK_NULL_NODE;
     } else {
-        skJsonNode_drop(json);
-        unlink_parent(json);
         json->type = SK_NONE_NODE;
     }
-
 }
 
 PUBLIC(int) skJson_type(const skJson* json)
@@ -192,7 +373,7 @@ PUBLIC(int) skJson_type(const skJson* json)
 
 PUBLIC(skJsonBool) skJson_parent(const skJson* json)
 {
-    return is_some(json) && is_some(json->parent_arena.ptr);
+    return is_some(json) && has_parent(json);
 }
 
 PUBLIC(int) skJson_parent_type(const skJson* json)
@@ -201,11 +382,35 @@ PUBLIC(int) skJson_parent_type(const skJson* json)
         return -1;
     }
 
-    return json->parent_arena.type;
+    if(json->flags & SK_NODE_IN_ARRAY) {
+        return SK_ARRAY_NODE;
+    } else if(json->flags & SK_NODE_IN_OBJECT) {
+        return SK_OBJECT_NODE;
+    }
+
+    return SK_NONE_NODE;
+}
+
+/* Scans the text of raw number 'json' again, the scanner stops right after it */
+PRIVATE(skToken) rawnum_scan(const skJson* json)
+{
+    skScanner scanner;
+
+    skScanner_init(&scanner, json->data.j_rawnum, skNumber_lexeme_len(json->data.j_rawnum));
+    return skScanner_next(&scanner);
 }
 
 PUBLIC(long int) skJson_integer_value(const skJson* json, int* cntrl)
 {
+    skToken token;
+    long    integ;
+
+    if(is_some(json) && json->type == SK_RAWNUM_NODE) {
+        token  = rawnum_scan(json);
+        *cntrl = skNumber_to_integer(&token.number, &integ) ? 0 : -1;
+        return (*cntrl == 0) ? integ : 0;
+    }
+
     if(!valid_with_type(json, SK_INT_NODE)) {
 #ifdef SK_ERRMSG
         THROW_ERR(WrongNodeType);
@@ -220,6 +425,14 @@ PUBLIC(long int) skJson_integer_value(const skJson* json, int* cntrl)
 
 PUBLIC(double) skJson_double_value(const skJson* json, int* cntrl)
 {
+    skToken token;
+
+    if(is_some(json) && json->type == SK_RAWNUM_NODE) {
+        token  = rawnum_scan(json);
+        *cntrl = 0;
+        return skNumber_to_double(&token.number, &token.lexeme);
+    }
+
     if(!valid_with_type(json, SK_DOUBLE_NODE)) {
 #ifdef SK_ERRMSG
         THROW_ERR(WrongNodeType);
@@ -232,6 +445,22 @@ PUBLIC(double) skJson_double_value(const skJson* json, int* cntrl)
     return json->data.j_double;
 }
 
+PUBLIC(const char*) skJson_rawnum_value(const skJson* json, size_t* len)
+{
+    if(!valid_with_type(json, SK_RAWNUM_NODE)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(WrongNodeType);
+#endif
+        return NULL;
+    }
+
+    if(is_some(len)) {
+        *len = skNumber_lexeme_len(json->data.j_rawnum);
+    }
+
+    return json->data.j_rawnum;
+}
+
 PUBLIC(skJsonBool) skJson_bool_value(const skJson* json)
 {
     if(!valid_with_type(json, SK_BOOL_NODE)) {
@@ -253,7 +482,7 @@ PUBLIC(char*) skJson_string_value(const skJson* json)
         return NULL;
     }
 
-    return strdup_ansi(json->data.j_string);
+    return strdup_ansi(Node_string(json));
 }
 
 PUBLIC(char*) skJson_string_ref_unsafe(const skJson* json)
@@ -265,19 +494,38 @@ PUBLIC(char*) skJson_string_ref_unsafe(const skJson* json)
         return NULL;
     }
 
-    return json->data.j_string;
+    return Node_string(json);
 }
 
 PRIVATE(void) drop_nonprim_elements(skJson* json)
 {
+    skJsonBool inline_value;
+
+    /* Whatever replaces the string is not stored in the node */
+    inline_value = json->flags & SK_NODE_INLINE_VALUE;
+    json->flags &= ~SK_NODE_INLINE_VALUE;
+
+    /* Pooled payload is freed together with its document */
+    if(is_pooled(json)) {
+        return;
+    }
+
     switch(json->type) {
         case SK_STRING_NODE:
-            free(json->data.j_string);
+            if(!inline_value) {
+                free(json->data.j_string);
+            }
+            break;
+        case SK_RAWNUM_NODE:
+            if(!(json->flags & SK_NODE_BORROWED_VALUE)) {
+                free(json->data.j_rawnum);
+            }
             break;
         case SK_ARRAY_NODE:
             skVec_drop(json->data.j_array, (FreeFn) skJsonNode_drop);
             break;
         case SK_OBJECT_NODE:
+            ObjectNode_drop_index(json);
             skVec_drop(json->data.j_object, (FreeFn) skObjTuple_drop);
             break;
         default:
@@ -339,7 +587,6 @@ PUBLIC(skJson*) skJson_transform_into_bool(skJson* json, skJsonBool boolean)
 
 PUBLIC(skJson*) skJson_transform_into_ref(skJson* json, const char* string_ref)
 {
-    skStrSlice slice;
 
     if(is_null(json)) {
 #ifdef SK_ERRMSG
@@ -348,9 +595,7 @@ PUBLIC(skJson*) skJson_transform_into_ref(skJson* json, const char* string_ref)
         return NULL;
     }
 
-    slice = skSlice_new(string_ref, strlen(string_ref) - 1);
-
-    if(!skJsonString_isvalid(&slice)) {
+    if(!skUtf8_isvalid(string_ref, strlen(string_ref))) {
 #ifdef SK_ERRMSG
         THROW_ERR(InvalidString);
 #endif
@@ -360,6 +605,7 @@ PUBLIC(skJson*) skJson_transform_into_ref(skJson* json, const char* string_ref)
     drop_nonprim_elements(json);
 
     json->data.j_string = discard_const(string_ref);
+    json->flags        &= ~SK_NODE_INLINE_VALUE;
     json->type          = SK_REFERENCE_NODE;
 
     return json;
@@ -367,8 +613,8 @@ PUBLIC(skJson*) skJson_transform_into_ref(skJson* json, const char* string_ref)
 
 PUBLIC(skJson*) skJson_transform_into_string(skJson* json, const char* string)
 {
-    skStrSlice slice;
     char*      new_str;
+    size_t     len;
 
     if(is_null(json)) {
 #ifdef SK_ERRMSG
@@ -377,25 +623,35 @@ PUBLIC(skJson*) skJson_transform_into_string(skJson* json, const char* string)
         return NULL;
     }
 
-    slice = skSlice_new(string, strlen(string) - 1);
+    if(is_pooled(json)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(PooledNode);
+#endif
+        return NULL;
+    }
 
-    if(!skJsonString_isvalid(&slice)) {
+    if(!skUtf8_isvalid(string, len = strlen(string))) {
 #ifdef SK_ERRMSG
         THROW_ERR(InvalidString);
 #endif
         return NULL;
     }
 
-    new_str = strdup_ansi(string);
-
-    if(is_null(new_str)) {
+    /* Short strings are stored in the node, long ones are copied before
+     * anything is dropped so the node stays intact on failure */
+    new_str = NULL;
+    if(len > SK_NODE_INLINE_MAX && is_null(new_str = strdup_ansi(string))) {
         return NULL;
     }
 
     drop_nonprim_elements(json);
 
-    json->data.j_string = new_str;
-    json->type          = SK_STRING_NODE;
+    if(is_null(new_str)) {
+        StringNode_set_inline(json, string, len);
+    } else {
+        json->data.j_string = new_str;
+    }
+    json->type = SK_STRING_NODE;
 
     return json;
 }
@@ -411,7 +667,14 @@ PUBLIC(skJson*) skJson_transform_into_empty_array(skJson* json)
         return NULL;
     }
 
-    array = skVec_new(sizeof(skJson));
+    if(is_pooled(json)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(PooledNode);
+#endif
+        return NULL;
+    }
+
+    array = skVec_with_capacity(sizeof(skJson), SK_CONTAINER_INLINE);
 
     if(is_null(array)) {
         return NULL;
@@ -436,7 +699,14 @@ PUBLIC(skJson*) skJson_transform_into_empty_object(skJson* json)
         return NULL;
     }
 
-    if(is_null(table = skVec_new(sizeof(skObjTuple)))) {
+    if(is_pooled(json)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(PooledNode);
+#endif
+        return NULL;
+    }
+
+    if(is_null(table = skVec_with_slot(sizeof(skObjTuple), SK_CONTAINER_INLINE, NULL))) {
         return NULL;
     }
 
@@ -509,16 +779,13 @@ PUBLIC(skJson) skJson_null_new(void)
 
 PRIVATE(skJson) skJson_string_new_internal(const char* string, skNodeType type, skJson* parent)
 {
-    skStrSlice slice;
     skJson string_node;
 
     /* Guilty until proven innocent */
     string_node.data.j_string = NULL;
     string_node.type = SK_ERROR_NODE;
 
-    slice = skSlice_new(string, strlen(string) - 1);
-
-    if(!skJsonString_isvalid(&slice)) {
+    if(!skUtf8_isvalid(string, strlen(string))) {
 #ifdef SK_ERRMSG
         THROW_ERR(InvalidString);
 #endif
@@ -536,7 +803,7 @@ PUBLIC(skJson) skJson_string_new(const char* string)
 PUBLIC(skJsonBool) skJson_string_set(skJson* json, const char* string)
 {
     char*      new_str;
-    skStrSlice slice;
+    size_t     len;
 
     if(!valid_with_type(json, SK_STRING_NODE)) {
 #ifdef SK_ERRMSG
@@ -545,22 +812,36 @@ PUBLIC(skJsonBool) skJson_string_set(skJson* json, const char* string)
         return false;
     }
 
-    slice = skSlice_new(string, strlen(string) - 1);
+    if(is_pooled(json)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(PooledNode);
+#endif
+        return false;
+    }
 
-    if(!skJsonString_isvalid(&slice)) {
+    if(!skUtf8_isvalid(string, len = strlen(string))) {
 #ifdef SK_ERRMSG
         THROW_ERR(InvalidString);
 #endif
         return false;
     }
 
-    if((new_str = strdup_ansi(string)) == NULL) {
+    new_str = NULL;
+    if(len > SK_NODE_INLINE_MAX && (new_str = strdup_ansi(string)) == NULL) {
         return false;
     }
 
     /* Drop old string and set the new one */
-    free(json->data.j_string);
-    json->data.j_string = new_str;
+    if(!(json->flags & SK_NODE_INLINE_VALUE)) {
+        free(json->data.j_string);
+    }
+    json->flags &= ~SK_NODE_INLINE_VALUE;
+
+    if(is_null(new_str)) {
+        StringNode_set_inline(json, string, len);
+    } else {
+        json->data.j_string = new_str;
+    }
 
     return true;
 }
@@ -572,7 +853,6 @@ PUBLIC(skJson) skJson_ref_new(const char* string)
 
 PUBLIC(skJsonBool) skJson_ref_set(skJson* json, const char* string)
 {
-    skStrSlice slice;
 
     if(!valid_with_type(json, SK_REFERENCE_NODE)) {
 #ifdef SK_ERRMSG
@@ -581,9 +861,7 @@ PUBLIC(skJsonBool) skJson_ref_set(skJson* json, const char* string)
         return false;
     }
 
-    slice = skSlice_new(string, strlen(string) - 1);
-
-    if(!skJsonString_isvalid(&slice)) {
+    if(!skUtf8_isvalid(string, strlen(string))) {
 #ifdef SK_ERRMSG
         THROW_ERR(InvalidString);
 #endif
@@ -591,6 +869,7 @@ PUBLIC(skJsonBool) skJson_ref_set(skJson* json, const char* string)
     }
 
     json->data.j_string = discard_const(string);
+    json->flags        &= ~SK_NODE_INLINE_VALUE;
     return true;
 }
 
@@ -640,6 +919,26 @@ PRIVATE(skJson) skJson_constructor_internal(
     return node;
 }
 
+/* Elements owning memory can't move between an arena document and the heap,
+ * elements without it just take over the ownership of the new 'parent'.
+ * Key the element had in the object it was taken from doesn't come with it. */
+PRIVATE(skJsonBool) adopt_element(skJson* element, const skJson* parent)
+{
+    if(is_pooled(element) != is_pooled(parent)) {
+        if(has_payload(element)) {
+#ifdef SK_ERRMSG
+            THROW_ERR(PooledNode);
+#endif
+            return false;
+        }
+        element->flags ^= SK_NODE_POOLED;
+    }
+
+    /* Key of the new parent is always allocated by us */
+    element->flags &= ~SK_NODE_BORROWED_KEY;
+    return true;
+}
+
 PRIVATE(skJsonBool) skJson_array_insert_internal(
         skJson* parent,
         const void* val,
@@ -660,6 +959,9 @@ PRIVATE(skJsonBool) skJson_array_insert_internal(
         }
     } else {
         node = *(skJson*) val;
+        if(!adopt_element(&node, parent)) {
+            return false;
+        }
         link_parent(&node, parent);
     }
 
@@ -993,6 +1295,9 @@ PUBLIC(skJson) skJson_array_from_nulls(size_t count)
 /* Helper function for 'skJson_array_from_elements'. */
 PRIVATE(skJsonBool) array_push_node_checked(skJson* json, skJson* node)
 {
+    if(!adopt_element(node, json)) {
+        return false;
+    }
     link_parent(node, json);
     if(!skVec_push(json->data.j_array, node)) {
         unlink_parent(node);
@@ -1135,6 +1440,7 @@ PUBLIC(skJsonBool) skJson_object_sort(skJson* json)
         return false;
     }
 
+    ObjectNode_drop_index(json);
     return skVec_sort(json->data.j_object, (CmpFn) compare_tuples);
 }
 
@@ -1147,6 +1453,7 @@ PUBLIC(skJsonBool) skJson_object_sort_by(skJson* json, CmpFn cmp)
         return false;
     }
 
+    ObjectNode_drop_index(json);
     return skVec_sort(json->data.j_object, cmp);
 }
 
@@ -1179,6 +1486,26 @@ PRIVATE(int) compare_tuples(const skObjTuple* a, const skObjTuple* b)
     return strcmp(a->key, b->key);
 }
 
+/* Finds the member with the 'key' through the index if the object has one,
+ * otherwise scans the members ('sorted' ones are searched with bsearch). */
+PRIVATE(skObjTuple*) object_find(const skJson* json, const char* key, skJsonBool sorted)
+{
+    skObjTuple  dummy_tuple;
+    skObjTuple* tuple;
+    skJsonBool  indexed;
+
+    if(is_some(key)) {
+        tuple = ObjectNode_find(json, key, &indexed);
+        if(indexed) {
+            return tuple;
+        }
+    }
+
+    dummy_tuple.key = discard_const(key);
+
+    return skVec_get_by_key(json->data.j_object, &dummy_tuple, (CmpFn) compare_tuples, sorted);
+}
+
 PRIVATE(skJsonBool) skJson_object_insert_internal(
         skJson* parent,
         const char* key,
@@ -1200,10 +1527,19 @@ PRIVATE(skJsonBool) skJson_object_insert_internal(
         }
     } else {
         tuple.value = * (skJson*) val;
+        if(!adopt_element(&tuple.value, parent)) {
+            return false;
+        }
         link_parent(&tuple.value, parent);
     }
 
-    if(is_null(tuple.key = strdup_ansi(key))) {
+    if(is_pooled(parent)) {
+        tuple.key = skPool_strndup(Node_pool(parent), key, strlen(key));
+    } else {
+        tuple.key = strdup_ansi(key);
+    }
+
+    if(is_null(tuple.key)) {
         if(element) {
             unlink_parent(&tuple.value);
         } else {
@@ -1215,6 +1551,7 @@ PRIVATE(skJsonBool) skJson_object_insert_internal(
     if(push) {
         fail = !skVec_push(parent->data.j_object, &tuple);
     } else {
+        ObjectNode_drop_index(parent);
         fail = !skVec_insert(parent->data.j_object, &tuple, index);
     }
 
@@ -1224,7 +1561,9 @@ PRIVATE(skJsonBool) skJson_object_insert_internal(
         } else {
             skJsonNode_drop(&tuple.value);
         }
-        free(tuple.key);
+        if(!is_pooled(parent)) {
+            free(tuple.key);
+        }
         return false;
     }
 
@@ -1424,6 +1763,7 @@ PUBLIC(skJsonBool) skJson_object_remove(skJson* json, size_t index)
         return false;
     }
 
+    ObjectNode_drop_index(json);
     return skVec_remove(json->data.j_object, index, (FreeFn) skObjTuple_drop);
 }
 
@@ -1438,6 +1778,8 @@ PUBLIC(skJsonBool) skJson_object_pop(skJson* json, skObjTuple* tuple)
         return false;
     }
 
+    ObjectNode_drop_index(json);
+
     if(!skVec_pop(json->data.j_object, &popped)) {
         return false;
     }
@@ -1453,7 +1795,7 @@ skJson_object_remove_by_key(
     const char* key,
     skJsonBool        sorted)
 {
-    skObjTuple dummy_tuple;
+    skObjTuple* tuple;
 
     if(!valid_with_type(json, SK_OBJECT_NODE)) {
 #ifdef SK_ERRMSG
@@ -1462,14 +1804,16 @@ skJson_object_remove_by_key(
         return false;
     }
 
-    dummy_tuple.key = discard_const(key);
+    if(is_null(tuple = object_find(json, key, sorted))) {
+        return false;
+    }
 
-    return skVec_remove_by_key(
+    ObjectNode_drop_index(json);
+
+    return skVec_remove(
         json->data.j_object,
-        &dummy_tuple,
-        (CmpFn) compare_tuples,
-        (FreeFn) skObjTuple_drop,
-        sorted);
+        tuple - (skObjTuple*) skVec_front(json->data.j_object),
+        (FreeFn) skObjTuple_drop);
 }
 
 PUBLIC(skObjTuple*) skJson_object_index(const skJson* json, size_t index)
@@ -1490,8 +1834,6 @@ skJson_object_index_by_key(
     const char*       key,
     skJsonBool              sorted)
 {
-    skObjTuple dummy_tuple;
-
     if(!valid_with_type(json, SK_OBJECT_NODE)) {
 #ifdef SK_ERRMSG
         THROW_ERR(WrongNodeType);
@@ -1499,13 +1841,7 @@ skJson_object_index_by_key(
         return NULL;
     }
 
-    dummy_tuple.key = discard_const(key);
-
-    return skVec_get_by_key(
-        json->data.j_object,
-        &dummy_tuple,
-        (CmpFn) compare_tuples,
-        sorted);
+    return object_find(json, key, sorted);
 }
 
 PUBLIC(skObjTuple*)
@@ -1579,8 +1915,6 @@ PUBLIC(size_t) skJson_object_len(const skJson* json)
 PUBLIC(skJsonBool)
 skJson_object_contains(const skJson* json, const char* key, skJsonBool sorted)
 {
-    skObjTuple dummy_tuple;
-
     if(!valid_with_type(json, SK_OBJECT_NODE)) {
 #ifdef SK_ERRMSG
         THROW_ERR(WrongNodeType);
@@ -1588,13 +1922,7 @@ skJson_object_contains(const skJson* json, const char* key, skJsonBool sorted)
         return false;
     }
 
-    dummy_tuple.key = discard_const(key);
-
-    return skVec_contains(
-        json->data.j_object,
-        &dummy_tuple,
-        (CmpFn) compare_tuples,
-        sorted);
+    return is_some(object_find(json, key, sorted));
 }
 
 PUBLIC(void) skJson_object_clear(skJson* json)
@@ -1606,7 +1934,8 @@ PUBLIC(void) skJson_object_clear(skJson* json)
         return;
     }
 
-    skVec_clear(json->data.j_object, (FreeFn) skJsonNode_drop);
+    ObjectNode_drop_index(json);
+    skVec_clear(json->data.j_object, (FreeFn) skObjTuple_drop);
 }
 
 PRIVATE(Serializer) Serializer_new(size_t bufsize, skJsonBool expand)
@@ -1831,9 +2160,10 @@ PRIVATE(skJsonBool) Serializer_serialize(Serializer* serializer, skJson* json)
     switch(json->type) {
         case SK_STRING_NODE:
         case SK_REFERENCE_NODE:
-            return Serializer_serialize_string(serializer, json->data.j_string);
+            return Serializer_serialize_string(serializer, Node_string(json));
         case SK_INT_NODE:
         case SK_DOUBLE_NODE:
+        case SK_RAWNUM_NODE:
             return Serializer_serialize_number(serializer, json);
         case SK_BOOL_NODE:
             return Serializer_serialize_bool(serializer, json->data.j_boolean);
@@ -1854,25 +2184,32 @@ PRIVATE(skJsonBool) Serializer_serialize(Serializer* serializer, skJson* json)
 
 PRIVATE(skJsonBool) Serializer_serialize_number(Serializer* serializer, skJson* json)
 {
-    char           buff[30];
+    char           buff[SK_NUMBER_BUFSIZE];
     unsigned char* out;
-    long int       len;
+    size_t         len;
 #ifdef SK_DBUG
     assert(is_some(serializer));
     assert(is_some(serializer->buffer));
     assert(is_some(json));
 #endif
-    if(json->type == SK_DOUBLE_NODE) {
-        len = sprintf(buff, "%fl", json->data.j_double);
+    if(json->type == SK_RAWNUM_NODE) {
+        /* Written back exactly as it was parsed */
+        len = skNumber_lexeme_len(json->data.j_rawnum);
+        if(is_null(out = Serializer_buffer_ensure(serializer, len + sizeof("")))) {
+            return false;
+        }
+        memcpy((char*) out, json->data.j_rawnum, len);
+        out[len] = '\0';
+        serializer->offset += len;
+        return true;
+    } else if(json->type == SK_DOUBLE_NODE) {
+        /* Json has no representation for NaN and infinity */
+        if(json->data.j_double - json->data.j_double != 0) {
+            return Serializer_serialize_null(serializer);
+        }
+        len = skNumber_format_double(buff, json->data.j_double);
     } else {
-        len = sprintf(buff, "%ld", json->data.j_int);
-    }
-
-    if(len < 0 || len >= 30) {
-#ifdef SK_ERRMSG
-        THROW_ERR(SerializerNumberError);
-#endif
-        return false;
+        len = skNumber_format_integer(buff, json->data.j_int);
     }
 
     out = Serializer_buffer_ensure(serializer, len + sizeof(""));
@@ -1882,7 +2219,7 @@ PRIVATE(skJsonBool) Serializer_serialize_number(Serializer* serializer, skJson*
     }
 
     memcpy((char*) out, buff, len);
-    out[len + 1] = '\0';
+    out[len] = '\0';
     serializer->offset += len;
 
     return true;
@@ -1890,25 +2227,90 @@ PRIVATE(skJsonBool) Serializer_serialize_number(Serializer* serializer, skJson*
 
 PRIVATE(skJsonBool) Serializer_serialize_string(Serializer* serializer, const char* str)
 {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char* in;
     unsigned char* out;
     size_t         len;
+    size_t         escaped;
+    size_t         run;
+    unsigned char  c;
 #ifdef SK_DBUG
     assert(is_some(serializer));
     assert(is_some(serializer->buffer));
 #endif
-    len = strlen(str);
-    out = Serializer_buffer_ensure(serializer, len + sizeof("\"\""));
+    in = (const unsigned char*) str;
+
+    /* Strings are stored decoded, quotes, backslashes and control
+     * characters have to be escaped again */
+    for(len = 0, escaped = 0; (c = in[len]) != '\0'; len++) {
+        if(c < ' ') {
+            escaped += (strchr("\b\f\n\r\t", c) != NULL) ? 1 : 5;
+        } else if(c == '"' || c == '\\') {
+            escaped++;
+        }
+    }
+
+    out = Serializer_buffer_ensure(serializer, len + escaped + sizeof("\"\""));
 
     if(is_null(out)) {
         return false;
     }
 
+    *out++ = '\"';
+
+    if(escaped == 0) {
+        memcpy(out, in, len);
+        out += len;
+    } else {
+        while(*in) {
+            /* Copy the run of bytes that don't need escaping at once */
+            for(run = 0; in[run] >= ' ' && in[run] != '"' && in[run] != '\\'; run++)
+                ;
+            memcpy(out, in, run);
+            out += run;
+            in  += run;
+
+            if((c = *in) == '\0') {
+                break;
+            }
+
+            *out++ = '\\';
+            switch(c) {
+                case '\b':
+                    *out++ = 'b';
+                    break;
+                case '\f':
+                    *out++ = 'f';
+                    break;
+                case '\n':
+                    *out++ = 'n';
+                    break;
+                case '\r':
+                    *out++ = 'r';
+                    break;
+                case '\t':
+                    *out++ = 't';
+                    break;
+                case '"':
+                case '\\':
+                    *out++ = c;
+                    break;
+                default:
+                    *out++ = 'u';
+                    *out++ = '0';
+                    *out++ = '0';
+                    *out++ = hex[c >> 4];
+                    *out++ = hex[c & 0xF];
+                    break;
+            }
+            in++;
+        }
+    }
+
     out[0] = '\"';
-    memcpy(out + 1, str, len);
-    out[len + 1] = '\"';
-    out[len + 2] = '\0';
+    out[1] = '\0';
 
-    Serializer_offset_update(serializer);
+    serializer->offset += len + escaped + 2;
 
     return true;
 }
@@ -2041,16 +2443,19 @@ PRIVATE(skJsonBool) Serializer_serialize_object(Serializer* serializer, skVec* t
             return false;
         }
 
-        if(is_null(out = Serializer_buffer_ensure(serializer, 2))) {
-            return false;
-        }
-
         if(i + 1 != len) {
+            if(is_null(out = Serializer_buffer_ensure(serializer, 1))) {
+                return false;
+            }
             *out = ',';
             serializer->offset++;
         }
     }
 
+    if(is_null(out = Serializer_buffer_ensure(serializer, 2))) {
+        return false;
+    }
+
     *out++             = '}';
     *out               = '\0';
     serializer->offset++;
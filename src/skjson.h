@@ -26,31 +26,214 @@ typedef struct skObjTuple skObjTuple;
 #define SKJS_BOOL   (1 << 7)    /* Boolean Json */
 #define SKJS_NULL   (1 << 8)    /* Null Json */
 #define SKJS_NONE   (1 << 9)    /* None Json (empty) */
+#define SKJS_RAWNUM (1 << 10)   /* Raw Number Json (number kept as its source text) */
 
 /* Parse the Json from 'buff' of size 'bufsize'.
  * If parsing error occured it returns Error Json element which contains error info aka
  * string describing the error and position where it occured. */
 PUBLIC(skJson) skJson_parse(char *buff, size_t bufsize);
-/* Returns null-terminated char array describing the error occured during parsing if 'json' 
- * is of type 'SK_JSERR', otherwise return NULL. */
+/* Parse the Json from 'buff' of size 'bufsize' without copying the strings.
+ * Strings and keys are nul terminated in place inside of 'buff' and the elements
+ * point into it, string values are parsed as Reference Json elements.
+ * 'buff' must stay valid and unmodified for as long as the returned element lives,
+ * after parsing it no longer contains valid Json. */
+PUBLIC(skJson) skJson_parse_insitu(char *buff, size_t bufsize);
+/* Parse the Json from 'buff' of size 'bufsize' according to the 'flags': 'SKJS_FILE_BORROW'
+ * parses it in situ (see 'skJson_parse_insitu') and 'SKJS_RAW_NUMBERS' keeps the numbers as
+ * their source text, they are converted only when their value is read and serialized back
+ * exactly as they were written. Raw numbers parsed in situ point into 'buff' as well. */
+PUBLIC(skJson) skJson_parse_flags(char *buff, size_t bufsize, int flags);
+/* Opaque type representing the parsed Json document that owns all of its elements */
+typedef struct skJsonDoc skJsonDoc;
+/* Parse the Json from 'buff' of size 'bufsize' into a document whose elements, strings
+ * and keys are all allocated from a single arena and are freed together by 'skJsonDoc_drop'.
+ * Elements of the document can be read, removed, and new elements can be inserted into it
+ * (they are allocated from the arena too), but transforming the elements into strings,
+ * arrays or objects and 'skJson_string_set' are not supported and fail.
+ * Returns NULL if 'buff' is empty or allocation failed, parsing errors are reported
+ * through the Error Json root element. */
+PUBLIC(skJsonDoc*) skJson_parse_arena(char *buff, size_t bufsize);
+/* Returns the root element of the 'doc' */
+PUBLIC(skJson*) skJsonDoc_root(skJsonDoc *doc);
+/* Drops the 'doc' and all of its elements at once. */
+PUBLIC(void) skJsonDoc_drop(skJsonDoc *doc);
+/* Flags of 'skJson_parse_file' and 'skJson_parse_flags' */
+#define SKJS_FILE_ARENA     (1 << 0) /* Allocate the elements from the document arena */
+#define SKJS_FILE_BORROW    (1 << 1) /* Strings point into the mapped file (as if parsed in situ) */
+#define SKJS_RAW_NUMBERS    (1 << 2) /* Numbers are parsed as Raw Number Json elements */
+/* Memory maps the file at 'path' (read-only, changes made by borrowing strings are private
+ * to the mapping) and parses it without copying it into the memory first. Document owns the
+ * mapping if strings were borrowed from it, otherwise the file is unmapped before returning.
+ * Returns NULL if the file is empty, can't be mapped or allocation failed, 'skJsonDoc_drop'
+ * drops the returned document whatever the 'flags' were. */
+PUBLIC(skJsonDoc*) skJson_parse_file(const char *path, int flags);
+/* Opaque type representing the incremental Json parser */
+typedef struct skJsonParser skJsonParser;
+/* Creates the incremental parser for the Json that arrives in chunks. */
+PUBLIC(skJsonParser*) skJsonParser_new(void);
+/* Parses the next 'chunk' of size 'len' of the Json document, the chunk can end anywhere
+ * (even inside of a string or a number), only the unfinished token is copied and kept.
+ * Returns false if the document is already known to be invalid or allocation failed. */
+PUBLIC(skJsonBool) skJsonParser_feed(skJsonParser *parser, const char *chunk, size_t len);
+/* Ends the document and returns the same element 'skJson_parse' would return for the
+ * concatenation of all the chunks fed into the 'parser', afterwards 'parser' can be reused. */
+PUBLIC(skJson) skJsonParser_finish(skJsonParser *parser);
+/* Parses the whole 'buff' of size 'bufsize' the same way 'skJson_parse' does, but reuses
+ * the scratch buffers and the container stack of the 'parser' instead of allocating them
+ * for every call. Document that was being fed into the 'parser' is dropped. */
+PUBLIC(skJson) skJsonParser_parse(skJsonParser *parser, char *buff, size_t bufsize);
+/* Same as 'skJsonParser_parse' but the document is allocated from the arena of the 'parser'
+ * (see 'skJson_parse_arena' for what can be done with it). Arena is reused by the next call,
+ * returned root is valid until then or until the 'parser' is dropped and must not be dropped
+ * by the caller. Returns NULL if 'buff' is empty or allocation failed. */
+PUBLIC(skJson*) skJsonParser_parse_arena(skJsonParser *parser, char *buff, size_t bufsize);
+/* Drops the 'parser' including the document it didn't finish. */
+PUBLIC(void) skJsonParser_drop(skJsonParser *parser);
+
+/* Callbacks of the event (SAX) parser, any of them can be NULL. Keys, strings and numbers
+ * are passed as slices of the parsed buffer, they are not nul-terminated and escapes in
+ * strings are kept as they are. Returning false from a callback aborts the parsing. */
+typedef struct {
+    skJsonBool (*start_object)(void *ctx);
+    skJsonBool (*end_object)(void *ctx);
+    skJsonBool (*start_array)(void *ctx);
+    skJsonBool (*end_array)(void *ctx);
+    skJsonBool (*key)(void *ctx, const char *key, size_t len);
+    skJsonBool (*string)(void *ctx, const char *string, size_t len);
+    skJsonBool (*number)(void *ctx, const char *number, size_t len);
+    skJsonBool (*boolean)(void *ctx, skJsonBool boolean);
+    skJsonBool (*null)(void *ctx);
+} skJsonSax;
+
+/* Results of 'skJson_sax_parse' */
+#define SKJS_SAX_OK         (0) /* Whole document was processed */
+#define SKJS_SAX_ABORTED    (1) /* Callback returned false */
+#define SKJS_SAX_INVALID    (2) /* Document is not a valid Json */
+
+/* Parse the Json from 'buff' of size 'bufsize' without building the elements, instead
+ * the callbacks of 'sax' are called with 'ctx' for every element in the document order.
+ * Nothing is allocated. Unlike 'skJson_parse' only whitespace may surround the root. */
+PUBLIC(int) skJson_sax_parse(const char *buff, size_t bufsize, const skJsonSax *sax, void *ctx);
+/* Check that 'buff' of size 'bufsize' holds a valid Json (same grammar as 'skJson_sax_parse')
+ * without allocating anything. If it doesn't and 'err_offset' is not NULL, the offset of the
+ * token where it stopped being valid is stored into it, 'bufsize' if the input ended early. */
+PUBLIC(skJsonBool) skJson_validate(const char *buff, size_t bufsize, size_t *err_offset);
+/* Called for every record of the newline delimited Json in the input order, 'index' counts
+ * the records (blank lines are not records). Callback takes over the 'record' and has to
+ * drop it. Returning false stops the parsing. */
+typedef skJsonBool (*skJsonRecordFn)(void *ctx, size_t index, skJson *record);
+/* Parse newline delimited Json (JSON Lines) from 'buff' of size 'bufsize' on 'nthreads' worker
+ * threads, 0 uses one thread per online processor. Each line is parsed as if by 'skJson_parse'
+ * after its surrounding whitespace is removed. Returns an array of the records in the input
+ * order, lines that failed to parse are error elements of the array. Returns none element
+ * if allocation failed. */
+PUBLIC(skJson) skJson_parse_ndjson(char *buff, size_t bufsize, unsigned int nthreads);
+/* Same as 'skJson_parse_ndjson' but records are handed to 'callback' together with 'ctx'
+ * (always from the calling thread) as soon as all the records before them were handed over,
+ * only a few records per thread are kept in memory. Returns false if allocation failed or
+ * the 'callback' stopped the parsing. */
+PUBLIC(skJsonBool) skJson_parse_ndjson_each(char *buff, size_t bufsize, unsigned int nthreads, skJsonRecordFn callback, void *ctx);
+/* Parses the Json the same way as 'skJson_parse' but if its root is a large array, the array is
+ * split at the commas between its elements (found by the structural index) and the ranges are
+ * parsed on up to 'nthreads' threads (0 means one per online CPU), then joined in order. Result
+ * and errors are exactly the same as with 'skJson_parse', 'buff' is not modified. */
+PUBLIC(skJson) skJson_parse_parallel(char *buff, size_t bufsize, unsigned int nthreads);
+/* Parse error codes */
+#define SKJS_ERR_TOKEN      (1) /* Invalid syntax/token */
+#define SKJS_ERR_OBJECT     (2) /* Malformed Json Object */
+#define SKJS_ERR_ARRAY      (3) /* Malformed Json Array */
+#define SKJS_ERR_DEPTH      (4) /* Maximum nesting depth exceeded */
+#define SKJS_ERR_STRING     (5) /* Invalid Json String */
+#define SKJS_ERR_NUMBER     (6) /* Invalid Json Number */
+/* Parse error carried by the Error Json element */
+typedef struct {
+    int    code;   /* One of SKJS_ERR_* */
+    size_t offset; /* Byte offset of the offending token, length of the input if it ended early */
+    size_t depth;  /* Nesting depth at the offending token, top level is at depth 1 */
+} skJsonError;
+/* Returns null-terminated char array describing the error occured during parsing if 'json'
+ * is of type 'SK_JSERR', otherwise return NULL. Array is static, position of the error is
+ * returned by 'skJson_error_info' and formatted together with it by 'skJson_error_format'. */
 PUBLIC(const char*) skJson_error(const skJson *json);
+/* Stores the error of 'json' into 'err', returns false if 'json' is not of type 'SK_JSERR'. */
+PUBLIC(skJsonBool) skJson_error_info(const skJson *json, skJsonError *err);
+/* Formats the error of 'json' with its position into 'buff' of size 'bufsize', message is
+ * truncated to fit and always null-terminated. Returns the length of the whole message or
+ * 0 if 'json' is not of type 'SK_JSERR'. */
+PUBLIC(size_t) skJson_error_format(const skJson *json, char *buff, size_t bufsize);
+/* Opaque type representing the read-only Json document stored as a flat tape of 64-bit
+ * words, strings are decoded into a single side buffer. Whole document is two allocations
+ * and every container knows where it ends so skipping it is a single step. */
+typedef struct skJsonTape skJsonTape;
+/* Element of the tape document, valid for as long as its tape. Zeroed reference is none. */
+typedef struct {
+    const skJsonTape *tape;
+    size_t            pos;
+} skJsonTapeRef;
+/* Iterator over the elements of the tape array or the members of the tape object */
+typedef struct {
+    const skJsonTape *tape;
+    size_t            pos;
+    size_t            end;
+} skJsonTapeIter;
+/* Parse the Json from 'buff' of size 'bufsize' into the tape document, 'buff' is not modified
+ * and is not needed afterwards. Only whitespace may surround the root. Returns NULL if parsing
+ * failed, the error is stored into 'err' if it is not NULL (its code is 0 if 'buff' is empty
+ * or allocation failed). */
+PUBLIC(skJsonTape*) skJsonTape_parse(const char *buff, size_t bufsize, skJsonError *err);
+/* Drops the 'tape' document, references into it become invalid. */
+PUBLIC(void) skJsonTape_drop(skJsonTape *tape);
+/* Returns the root element of the 'tape' */
+PUBLIC(skJsonTapeRef) skJsonTape_root(const skJsonTape *tape);
+/* Returns the type of the element 'ref' (SKJS_OBJ, SKJS_ARR, SKJS_STR, SKJS_INT, SKJS_DBL,
+ * SKJS_BOOL or SKJS_NULL), SKJS_NONE if 'ref' is none. */
+PUBLIC(int) skJsonTape_type(skJsonTapeRef ref);
+/* Returns the number of elements of the array or members of the object 'ref', 0 otherwise. */
+PUBLIC(size_t) skJsonTape_len(skJsonTapeRef ref);
+/* Finds the value of the member 'key' of the 'object' and stores it into 'value', returns
+ * false if 'object' is not an object or has no such member. Values of the other members are
+ * skipped without being looked at. */
+PUBLIC(skJsonBool) skJsonTape_object_get(skJsonTapeRef object, const char *key, skJsonTapeRef *value);
+/* Starts iterating the elements of the 'array' with 'iter', returns false if it is not an array. */
+PUBLIC(skJsonBool) skJsonTape_array_iter(skJsonTapeRef array, skJsonTapeIter *iter);
+/* Starts iterating the members of the 'object' with 'iter', returns false if it is not an object. */
+PUBLIC(skJsonBool) skJsonTape_object_iter(skJsonTapeRef object, skJsonTapeIter *iter);
+/* Stores the next element into 'value' and for objects the key of the member into 'key' (NULL
+ * for arrays), either can be NULL. Returns false once there are no more elements. */
+PUBLIC(skJsonBool) skJsonTape_iter_next(skJsonTapeIter *iter, const char **key, skJsonTapeRef *value);
+/* Returns the nul-terminated value of the string 'ref' and stores its length into 'len' (if
+ * it is not NULL), NULL if 'ref' is not a string. String is owned by the tape. */
+PUBLIC(const char*) skJsonTape_string(skJsonTapeRef ref, size_t *len);
+/* Returns the value of the integer 'ref', 'cntrl' is set to -1 if 'ref' is not an integer */
+PUBLIC(long int) skJsonTape_integer(skJsonTapeRef ref, int *cntrl);
+/* Returns the value of the double 'ref', 'cntrl' is set to -1 if 'ref' is not a double */
+PUBLIC(double) skJsonTape_double(skJsonTapeRef ref, int *cntrl);
+/* Returns the value of the boolean 'ref', 'cntrl' is set to -1 if 'ref' is not a boolean */
+PUBLIC(skJsonBool) skJsonTape_bool(skJsonTapeRef ref, int *cntrl);
 /* Return 'json' element type */
 PUBLIC(int) skJson_type(const skJson *json);
 /* Returns true if 'json' element has a parent, otherwise false. */
 PUBLIC(skJsonBool) skJson_parent(const skJson *json);
 /* Returns type of parent for 'json' element. */
 PUBLIC(int) skJson_parent_type(const skJson *json);
-/* Return value of 'json' integer element */
+/* Return value of 'json' integer element, Raw Number Json is converted if it is an integer
+ * that fits into 'long int' otherwise 'cntrl' is set to -1 */
 PUBLIC(long int) skJson_integer_value(const skJson* json, int* cntrl);
-/* Return value of 'json' double element */
+/* Return value of 'json' double element, Raw Number Json is converted to the nearest double */
 PUBLIC(double) skJson_double_value(const skJson* json, int* cntrl);
+/* Returns the source text of 'json' Raw Number Json and stores its length into 'len', text
+ * is not null-terminated if it points into the buffer parsed in situ. Returns NULL if 'json'
+ * is not of type 'SKJS_RAWNUM'. */
+PUBLIC(const char*) skJson_rawnum_value(const skJson* json, size_t* len);
 /* Return value of 'json' skJsonBool element */
 PUBLIC(skJsonBool) skJson_bool_value(const skJson* json);
 /* Return duplicated value of 'json' string element */
 PUBLIC(char*) skJson_string_value(const skJson* json);
 /* *UNSAFE*: Returns direct reference to the stored string inside of 'json' element.
  * Use this very carefully because user might introduce Undefined Behaviour or cause
- * json data to become invalid according to the json standard. */
+ * json data to become invalid according to the json standard. Strings of up to 12 bytes
+ * are stored in the element itself, the reference is valid only while the element
+ * stays where it is (containers move their elements when they grow). */
 PUBLIC(char*) skJson_string_ref_unsafe(const skJson* json);
 /* Drops the 'json' element including its sub-elements. */
 PUBLIC(void) skJson_drop(skJson *json);
@@ -212,7 +395,10 @@ PUBLIC(skJsonBool) skJson_object_is_sorted_by(skJson* json, CmpFn cmp_fn);
 PUBLIC(skObjTuple*) skJson_object_index(const skJson *json, size_t index);
 /* Remove element by 'key', if the 'json' object is sorted and 'sorted' is set, search is done using binary
  * search, otherwise key comparison is done using linear search. If the object is not sorted 
- * and users sets the 'sorted' flag then the search is undefined. */
+ * and users sets the 'sorted' flag then the search is undefined.
+ * Objects with many keys (SK_OBJECT_INDEX_MIN, 32 by default) are searched through a hash
+ * index instead, it is built on the first lookup and kept in sync by every change of the
+ * object, 'sorted' is ignored for them. Objects parsed into an arena are always scanned. */
 PUBLIC(skObjTuple*) skJson_object_index_by_key(const skJson* json, const char* key, skJsonBool sorted);
 /* Get element associated with the 'key' from the 'json' object.
  * Searching is done using binary search using 'cmp' function for comparison.
@@ -231,7 +417,8 @@ PUBLIC(size_t) skJson_object_len(const skJson *json);
 /* Checks if there is a Json element associated with the 'key' in the 'json' object.
  * If object is sorted user can set 'sorted' to utilize binary search, if object is not
  * sorted and 'sorted' is set, then the search in undefined and result is undefined. 
- * If 'sorted' is not set then the linear search is performed. */
+ * If 'sorted' is not set then the linear search is performed.
+ * Large objects use the hash index, see 'skJson_object_index_by_key'. */
 PUBLIC(skJsonBool) skJson_object_contains(const skJson* json, const char* key, skJsonBool sorted);
 /* Get element associated with the 'key' from the 'json' object.
  * Searching is done using binary search if 'cmp' function is provided, otherwise linear search is used.
@@ -0,0 +1,324 @@
+/* clang-format off */
+#define _POSIX_C_SOURCE 200112L /* pthreads and sysconf */
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+#include "skerror.h"
+#include "skparser.h" /* Make sure skparser.h which includes sknode.h is included before skjson.h */
+#include "skjson.h"
+#include "skutils.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+/* clang-format on */
+
+/* Buffer is split into units of this many bytes, unit is the smallest piece
+ * of work a thread takes. Records belong to the unit their first byte is in. */
+#ifndef SK_NDJSON_UNIT
+#define SK_NDJSON_UNIT (1 << 20)
+#endif
+/* Number of units per thread that can be parsed ahead of the unit being delivered */
+#define UNITS_AHEAD 4
+
+#define is_blank(c) ((c) == ' ' || (c) == '\t' || (c) == '\r')
+
+/* Parsed records of a single unit */
+typedef struct {
+    skVec*     records; /* NULL if allocation failed */
+    skJsonBool done;
+} skNdUnit;
+
+/* Work shared by the worker threads and the thread delivering the records */
+typedef struct {
+    char*           buff;
+    size_t          bufsize;
+    skNdUnit*       units;
+    size_t          nunits;
+    size_t          next;      /* Next unit to be parsed */
+    size_t          delivered; /* Units already handed out to the callback */
+    size_t          ahead;     /* Max units parsed ahead of 'delivered' */
+    skJsonBool      stop;      /* Set when delivery failed or was stopped */
+    pthread_mutex_t lock;
+    pthread_cond_t  parsed;    /* Some unit got parsed */
+    pthread_cond_t  consumed;  /* Some unit got delivered or job is stopping */
+} skNdJob;
+
+/* Parses every record starting inside of the unit 'idx', returns them in a vector
+ * in the input order or NULL if allocation failed. */
+static skVec* skNdJob_parse_unit(const skNdJob* job, size_t idx)
+{
+    skVec* records;
+    skJson record;
+    char*  buff;
+    char*  end;
+    char*  unit_end;
+    char*  line;
+    char*  eol;
+    char*  next;
+
+    if(is_null(records = skVec_new(sizeof(skJson)))) {
+        return NULL;
+    }
+
+    buff     = job->buff;
+    end      = buff + job->bufsize;
+    line     = buff + idx * SK_NDJSON_UNIT;
+    unit_end = ((size_t) (end - line) > SK_NDJSON_UNIT) ? line + SK_NDJSON_UNIT : end;
+
+    /* Record that started in the previous unit is not ours */
+    if(line != buff && line[-1] != '\n') {
+        if(is_null(line = memchr(line, '\n', end - line))) {
+            return records;
+        }
+        line++;
+    }
+
+    for(; line < unit_end; line = next + 1) {
+        next = memchr(line, '\n', end - line);
+        eol  = is_some(next) ? next : end;
+
+        /* 'skJson_parse' doesn't allow leading whitespace, '\r' comes from CRLF line endings */
+        while(line < eol && is_blank(*line)) {
+            line++;
+        }
+        while(eol > line && is_blank(eol[-1])) {
+            eol--;
+        }
+
+        if(line != eol) {
+            record = skJson_parse(line, eol - line);
+            if(record.type == SK_NONE_NODE || !skVec_push(records, &record)) {
+                skJsonNode_drop(&record);
+                skVec_drop(records, (FreeFn) skJsonNode_drop);
+                return NULL;
+            }
+        }
+
+        if(is_null(next)) {
+            break;
+        }
+    }
+
+    return records;
+}
+
+/* Worker thread, parses units in order until none are left or the job is stopped */
+static void* skNdJob_worker(void* arg)
+{
+    skNdJob* job;
+    skVec*   records;
+    size_t   idx;
+
+    job = arg;
+
+    pthread_mutex_lock(&job->lock);
+    for(;;) {
+        while(!job->stop && job->next < job->nunits && job->next >= job->delivered + job->ahead) {
+            pthread_cond_wait(&job->consumed, &job->lock);
+        }
+
+        if(job->stop || job->next == job->nunits) {
+            break;
+        }
+
+        idx = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        records = skNdJob_parse_unit(job, idx);
+
+        pthread_mutex_lock(&job->lock);
+        job->units[idx].records = records;
+        job->units[idx].done    = true;
+        pthread_cond_signal(&job->parsed);
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    return NULL;
+}
+
+/* Hands over the 'records' to the 'callback', '*count' is the index of the first record.
+ * Records that were not handed over are dropped. Returns false if 'callback' stopped. */
+static skJsonBool
+skNdJob_deliver(skVec* records, size_t* count, skJsonRecordFn callback, void* ctx)
+{
+    skJsonBool ok;
+    skJson*    record;
+    size_t     i, len;
+
+    ok  = true;
+    len = skVec_len(records);
+
+    for(i = 0; i < len && ok; i++) {
+        record = skVec_index_unsafe(records, i);
+        ok     = callback(ctx, (*count)++, record);
+    }
+
+    for(; i < len; i++) {
+        skJsonNode_drop(skVec_index_unsafe(records, i));
+    }
+
+    skVec_drop(records, NULL);
+    return ok;
+}
+
+/* Runs the job on the current thread only */
+static skJsonBool skNdJob_run_serial(skNdJob* job, skJsonRecordFn callback, void* ctx)
+{
+    skVec* records;
+    size_t count;
+    size_t idx;
+
+    for(idx = 0, count = 0; idx < job->nunits; idx++) {
+        if(is_null(records = skNdJob_parse_unit(job, idx))
+           || !skNdJob_deliver(records, &count, callback, ctx))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Runs the job on 'nthreads' workers, records are delivered from the current thread */
+static skJsonBool
+skNdJob_run_parallel(skNdJob* job, size_t nthreads, skJsonRecordFn callback, void* ctx)
+{
+    pthread_t* threads;
+    skVec*     records;
+    skJsonBool ok;
+    size_t     started;
+    size_t     count;
+    size_t     idx;
+
+    if(is_null(job->units = calloc(job->nunits, sizeof(skNdUnit)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return false;
+    }
+
+    if(is_null(threads = malloc(nthreads * sizeof(pthread_t)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        free(job->units);
+        return false;
+    }
+
+    job->ahead = nthreads * UNITS_AHEAD;
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->parsed, NULL);
+    pthread_cond_init(&job->consumed, NULL);
+
+    for(started = 0; started < nthreads; started++) {
+        if(pthread_create(&threads[started], NULL, skNdJob_worker, job) != 0) {
+            break;
+        }
+    }
+
+    /* Fewer workers still get the job done */
+    ok = (started != 0);
+
+    for(idx = 0, count = 0; ok && idx < job->nunits; idx++) {
+        pthread_mutex_lock(&job->lock);
+        while(!job->units[idx].done) {
+            pthread_cond_wait(&job->parsed, &job->lock);
+        }
+        records = job->units[idx].records;
+        pthread_mutex_unlock(&job->lock);
+
+        ok = is_some(records) && skNdJob_deliver(records, &count, callback, ctx);
+        job->units[idx].records = NULL;
+
+        pthread_mutex_lock(&job->lock);
+        job->delivered++;
+        pthread_cond_broadcast(&job->consumed);
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    pthread_mutex_lock(&job->lock);
+    job->stop = !ok;
+    pthread_cond_broadcast(&job->consumed);
+    pthread_mutex_unlock(&job->lock);
+
+    while(started--) {
+        pthread_join(threads[started], NULL);
+    }
+
+    /* Units parsed ahead of the one that failed */
+    for(idx = 0; idx < job->nunits; idx++) {
+        if(is_some(job->units[idx].records)) {
+            skVec_drop(job->units[idx].records, (FreeFn) skJsonNode_drop);
+        }
+    }
+
+    pthread_cond_destroy(&job->consumed);
+    pthread_cond_destroy(&job->parsed);
+    pthread_mutex_destroy(&job->lock);
+    free(threads);
+    free(job->units);
+    return ok;
+}
+
+PUBLIC(skJsonBool)
+skJson_parse_ndjson_each(
+        char* buff,
+        size_t bufsize,
+        unsigned int nthreads,
+        skJsonRecordFn callback,
+        void* ctx)
+{
+    skNdJob job;
+    long    online;
+
+    if(is_null(buff) || is_null(callback)) {
+        return false;
+    }
+
+    if(nthreads == 0) {
+        online   = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (online > 0) ? online : 1;
+    }
+
+    memset(&job, 0, sizeof(skNdJob));
+    job.buff    = buff;
+    job.bufsize = bufsize;
+    job.nunits  = bufsize / SK_NDJSON_UNIT + (bufsize % SK_NDJSON_UNIT != 0);
+
+    /* Threads are not worth it if there is nothing to share */
+    if(nthreads == 1 || job.nunits < 2) {
+        return skNdJob_run_serial(&job, callback, ctx);
+    }
+
+    return skNdJob_run_parallel(&job, (nthreads < job.nunits) ? nthreads : job.nunits, callback, ctx);
+}
+
+/* Callback of 'skJson_parse_ndjson', moves the record into the array 'ctx' */
+static skJsonBool ndjson_collect(void* ctx, size_t index, skJson* record)
+{
+    (void) index;
+
+    if(!skJson_array_push_element(ctx, record)) {
+        skJsonNode_drop(record);
+        return false;
+    }
+
+    return true;
+}
+
+PUBLIC(skJson) skJson_parse_ndjson(char* buff, size_t bufsize, unsigned int nthreads)
+{
+    skJson array;
+
+    if((array = skJson_array_new()).type == SK_NONE_NODE) {
+        return array;
+    }
+
+    if(!skJson_parse_ndjson_each(buff, bufsize, nthreads, ndjson_collect, &array)) {
+        skJsonNode_drop(&array);
+        array.type = SK_NONE_NODE;
+    }
+
+    return array;
+}
@@ -2,90 +2,142 @@
 #include <assert.h>
 #endif
 #include "skerror.h"
+#include "skhashtable.h"
 #include "sknode.h"
 #include "skutils.h"
 #include <stdlib.h>
 #include <string.h>
 
-/* Err msg buffer size */
-#define ERR_SIZE 200
-
 skJson RawNode_new(skNodeType type, const skJson* parent)
 {
     skJson raw_node;
-    raw_node.type = type;
+    raw_node.type  = type;
+    raw_node.flags = 0;
 
     if(is_some(parent)) {
-        /* We could use the same field 'j_array' in both cases it is a union
-         * after all and both the array and object use the vector as arena.
-         * Keep it seperated for future maintenance and readability. */
-        if(parent->type == SK_ARRAY_NODE) {
-            raw_node.parent_arena.ptr = (void*) parent->data.j_array;
-        } else {
-            raw_node.parent_arena.ptr = (void*) parent->data.j_object;
-        }
-        raw_node.parent_arena.type = parent->type;
-    } else {
-        raw_node.parent_arena.ptr  = NULL;
-        raw_node.parent_arena.type = SK_NONE_NODE;
+        /* Children of pooled containers belong to the same pool */
+        raw_node.flags = (parent->flags & SK_NODE_POOLED) | Node_link_of(parent);
     }
 
     return raw_node;
 }
 
-skJson ObjectNode_new(const skJson* parent)
+/* Returns the pool of the container 'node' or NULL if it is not pooled */
+skPool* Node_pool(const skJson* node)
+{
+    if(is_null(node) || !(node->flags & SK_NODE_POOLED)
+       || !(node->type & (SK_OBJECT_NODE | SK_ARRAY_NODE)))
+    {
+        return NULL;
+    }
+    return skVec_pool(node->data.j_array);
+}
+
+/* Container node with room for 'capacity' elements, the storage is allocated
+ * from 'pool' if 'pool' is not NULL */
+static skJson ContainerNode_new(
+        skNodeType type,
+        size_t ele_size,
+        const skJson* parent,
+        skPool* pool,
+        size_t capacity)
 {
-    skJson object_node;
-    object_node = RawNode_new(SK_OBJECT_NODE, parent);
+    skJson node;
+    skVec* vec;
 
-    if(is_null(object_node.data.j_object = skVec_new(sizeof(skObjTuple)))) {
-        object_node.type = SK_NONE_NODE;
+    node = RawNode_new(type, parent);
+
+    if(type == SK_OBJECT_NODE) {
+        /* Slot holds the key index of large objects, see 'ObjectNode_find' */
+        vec = skVec_with_slot(ele_size, capacity, pool);
+    } else if(is_some(pool)) {
+        vec = skVec_with_capacity_in(ele_size, capacity, pool);
+    } else {
+        vec = skVec_with_capacity(ele_size, capacity);
     }
 
-    return object_node;
+    if(is_some(pool)) {
+        node.flags |= SK_NODE_POOLED;
+    }
+
+    if(is_null(node.data.j_array = vec)) {
+        node.type = SK_NONE_NODE;
+    }
+
+    return node;
 }
 
-skJson ArrayNode_new(const skJson* parent)
+skJson ObjectNode_new_sized(const skJson* parent, skPool* pool, size_t capacity)
 {
-    skJson array_node;
-    array_node = RawNode_new(SK_ARRAY_NODE, discard_const(parent));
+    return ContainerNode_new(SK_OBJECT_NODE, sizeof(skObjTuple), parent, pool, capacity);
+}
 
-    if(is_null(array_node.data.j_array = skVec_new(sizeof(skJson)))) {
-        array_node.type = SK_NONE_NODE;
-    }
+skJson ArrayNode_new_sized(const skJson* parent, skPool* pool, size_t capacity)
+{
+    return ContainerNode_new(SK_ARRAY_NODE, sizeof(skJson), parent, pool, capacity);
+}
 
-    return array_node;
+skJson ObjectNode_new_in(const skJson* parent, skPool* pool)
+{
+    return ObjectNode_new_sized(parent, pool, SK_CONTAINER_INLINE);
 }
 
-skJson ErrorNode_new(const skJsonString msg, skJsonState state, const skJson* parent)
+skJson ArrayNode_new_in(const skJson* parent, skPool* pool)
+{
+    return ArrayNode_new_sized(parent, pool, SK_CONTAINER_INLINE);
+}
+
+skJson ObjectNode_new(const skJson* parent)
+{
+    return ObjectNode_new_in(parent, Node_pool(parent));
+}
+
+skJson ArrayNode_new(const skJson* parent)
+{
+    return ArrayNode_new_in(parent, Node_pool(parent));
+}
+
+skJson ErrorNode_new(skParseError code, size_t offset, size_t depth, const skJson* parent)
 {
     skJson err_node;
-    char   errmsg[ERR_SIZE];
 
     err_node = RawNode_new(SK_ERROR_NODE, discard_const(parent));
 
-    sprintf(
-        errmsg,
-        "%s: line %lu, col %lu, depth %lu\n",
-        msg,
-        state.ln,
-        state.col,
-        state.depth);
-
-    if(is_null(err_node.data.j_err = strdup_ansi(errmsg))) {
-        err_node.type = SK_NONE_NODE;
+    if(depth > SK_ERROR_DEPTH_MAX) {
+        depth = SK_ERROR_DEPTH_MAX;
     }
 
+    err_node.data.j_error = ((offset > SK_ERROR_OFFSET_MAX) ? SK_ERROR_OFFSET_MAX : (skU64) offset) << 24
+                            | (skU64) depth << 8 | (skU64) code;
+
     return err_node;
 }
 
+void StringNode_set_inline(skJson* node, const char* str, size_t len)
+{
+    /* Source might be the string the node already stores */
+    memmove(Node_inline(node), str, len);
+    Node_inline(node)[len] = '\0';
+    node->flags |= SK_NODE_INLINE_VALUE;
+}
+
 skJson StringNode_new(const skJsonString str, skNodeType type, const skJson* parent)
 {
     skJson string_node;
+    size_t len;
+
     string_node = RawNode_new(type, discard_const(parent));
 
     if(type == SK_STRING_NODE) {
-        if(is_null(string_node.data.j_string = strdup_ansi(str))) {
+        if((len = strlen(str)) <= SK_NODE_INLINE_MAX) {
+            StringNode_set_inline(&string_node, str, len);
+        } else if(string_node.flags & SK_NODE_POOLED) {
+            string_node.data.j_string = skPool_strndup(Node_pool(parent), str, len);
+        } else {
+            string_node.data.j_string = strdup_ansi(str);
+        }
+
+        if(!(string_node.flags & SK_NODE_INLINE_VALUE) && is_null(string_node.data.j_string)) {
             string_node.type = SK_NONE_NODE;
             return string_node;
         }
@@ -97,6 +149,33 @@ skJson StringNode_new(const skJsonString str, skNodeType type, const skJson* par
     return string_node;
 }
 
+/* Number kept as the copy of its source 'text' of 'len' bytes, the copy is
+ * allocated from 'pool' if 'pool' is not NULL */
+skJson RawNumNode_new(const char* text, size_t len, skPool* pool, const skJson* parent)
+{
+    skJson node;
+    char*  copy;
+
+    node = RawNode_new(SK_RAWNUM_NODE, parent);
+
+    if(is_some(pool)) {
+        copy = skPool_strndup(pool, text, len);
+    } else if(is_some(copy = malloc(len + 1))) {
+        memcpy(copy, text, len);
+        copy[len] = '\0';
+    } else {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+    }
+
+    if(is_null(node.data.j_rawnum = copy)) {
+        node.type = SK_NONE_NODE;
+    }
+
+    return node;
+}
+
 skJson IntNode_new(long int n, const skJson* parent)
 {
     skJson int_node;
@@ -123,18 +202,32 @@ skJson BoolNode_new(bool boolean, const skJson* parent)
 
 void skObjTuple_drop(skObjTuple* tuple)
 {
-    free(tuple->key);
+    if(!(tuple->value.flags & (SK_NODE_POOLED | SK_NODE_BORROWED_KEY))) {
+        free(tuple->key);
+    }
     skJsonNode_drop(&tuple->value);
 }
 
 void skJsonNode_drop(skJson* node)
 {
+    bool inline_value;
+
     if(is_some(node)) {
 #ifdef SK_DBUG
         assert(node->type != SK_NONE_NODE);
 #endif
+        inline_value = node->flags & SK_NODE_INLINE_VALUE;
+        /* Node may be reused (skJson_drop keeps the flags of linked nodes) */
+        node->flags &= ~SK_NODE_INLINE_VALUE;
+
+        /* Whole subtree lives in the pool and goes away with it */
+        if(node->flags & SK_NODE_POOLED) {
+            return;
+        }
+
         switch(node->type) {
             case SK_OBJECT_NODE:
+                ObjectNode_drop_index(node);
                 skVec_drop(node->data.j_object, (FreeFn) skObjTuple_drop);
                 node->data.j_object = NULL;
                 break;
@@ -143,13 +236,102 @@ void skJsonNode_drop(skJson* node)
                 node->data.j_array = NULL;
                 break;
             case SK_STRING_NODE:
-                free(node->data.j_string);
+                if(!inline_value) {
+                    free(node->data.j_string);
+                }
                 break;
-            case SK_ERROR_NODE:
-                free(node->data.j_err);
+            case SK_RAWNUM_NODE:
+                if(!(node->flags & SK_NODE_BORROWED_VALUE)) {
+                    free(node->data.j_rawnum);
+                }
                 break;
             default:
                 break;
         }
     }
 }
+
+/* Maps each key to the position of its last occurrence, same member the
+ * linear scan finds. Positions are stored off by one, table needs non-NULL values. */
+typedef struct {
+    skHashTable* table;
+    size_t       len; /* Number of members indexed so far */
+} ObjectIndex;
+
+void ObjectNode_drop_index(const skJson* node)
+{
+    ObjectIndex** slot;
+
+    slot = (ObjectIndex**) skVec_slot(node->data.j_object);
+
+    if(is_some(*slot)) {
+        skHashTable_drop((*slot)->table);
+        free(*slot);
+        *slot = NULL;
+    }
+}
+
+/* Returns the index of the object 'node' brought up to date with the members
+ * pushed since the last lookup, building it on first use. Returns NULL if the object
+ * is too small, it lives in a pool (index is heap allocated and pool is dropped
+ * without visiting the nodes) or the index could not be allocated. */
+static ObjectIndex* ObjectIndex_get(const skJson* node)
+{
+    skVec*        members;
+    ObjectIndex** slot;
+    ObjectIndex*  index;
+    skObjTuple*   tuple;
+
+    members = node->data.j_object;
+
+    if(skVec_len(members) < SK_OBJECT_INDEX_MIN || (node->flags & SK_NODE_POOLED)) {
+        return NULL;
+    }
+
+    slot = (ObjectIndex**) skVec_slot(members);
+
+    if(is_null(index = *slot)) {
+        if(is_null(index = malloc(sizeof(ObjectIndex)))) {
+#ifdef SK_ERRMSG
+            THROW_ERR(OutOfMemory);
+#endif
+            return NULL;
+        }
+
+        if(is_null(index->table = skHashTable_new(NULL, (CmpKeyFn) strcmp, NULL, NULL))) {
+            free(index);
+            return NULL;
+        }
+
+        index->len = 0;
+        *slot      = index;
+    }
+
+    for(; index->len < skVec_len(members); index->len++) {
+        tuple = skVec_index(members, index->len);
+        if(!skHashTable_insert(index->table, tuple->key, (void*) (index->len + 1))) {
+            /* Partial index would miss keys */
+            ObjectNode_drop_index(node);
+            return NULL;
+        }
+    }
+
+    return index;
+}
+
+skObjTuple* ObjectNode_find(const skJson* node, const char* key, bool* indexed)
+{
+    ObjectIndex* index;
+    void*        position;
+
+    if(is_null(index = ObjectIndex_get(node))) {
+        *indexed = false;
+        return NULL;
+    }
+
+    *indexed = true;
+    position = skHashTable_get(index->table, key);
+
+    return (is_some(position)) ? skVec_index(node->data.j_object, (size_t) position - 1)
+                               : NULL;
+}
@@ -4,6 +4,7 @@
 #include "skscanner.h"
 #include "sktypes.h"
 #include "skvec.h"
+#include <stddef.h>
 
 /********* Json Element types **********/
 typedef enum {
@@ -16,17 +17,58 @@ typedef enum {
   SK_DOUBLE_NODE = 64,
   SK_BOOL_NODE = 128,
   SK_NULL_NODE = 256,
-  SK_NONE_NODE = 512
+  SK_NONE_NODE = 512,
+  SK_RAWNUM_NODE = 1024
 } skNodeType;
 
+/* Node flags */
+/* Node belongs to a pooled document, its payload (string, container storage)
+ * and its key if it is an object member are owned by the pool. */
+#define SK_NODE_POOLED 1
+/* Node is an object member whose key points into the buffer parsed in situ,
+ * the key is owned by the caller of 'skJson_parse_insitu'. */
+#define SK_NODE_BORROWED_KEY 2
+/* Raw number whose text points into the buffer parsed in situ instead of
+ * being owned by the node. */
+#define SK_NODE_BORROWED_VALUE 4
+/* Node is an element of an array or the value of an object member. Only the
+ * kind of the parent is recorded, the node itself is stored in the parent's
+ * storage so it is never needed to find the node. */
+#define SK_NODE_IN_ARRAY 8
+#define SK_NODE_IN_OBJECT 16
+#define SK_NODE_LINKED (SK_NODE_IN_ARRAY | SK_NODE_IN_OBJECT)
+/* String node keeps its (short) string in the node itself instead of
+ * 'data.j_string', see 'Node_string'. */
+#define SK_NODE_INLINE_VALUE 32
+/* Link flag of the child of container PARENT */
+#define Node_link_of(parent)                                                   \
+  (((parent)->type == SK_ARRAY_NODE) ? SK_NODE_IN_ARRAY : SK_NODE_IN_OBJECT)
+/* Gives node DST the parent link of node SRC */
+#define Node_copy_link(dst, src)                                               \
+  ((dst)->flags = ((dst)->flags & ~SK_NODE_LINKED) | ((src)->flags & SK_NODE_LINKED))
+
+/* Parse error codes, public as SKJS_ERR_* */
+typedef enum {
+  SK_PARSE_TOKEN = 1,
+  SK_PARSE_OBJECT = 2,
+  SK_PARSE_ARRAY = 3,
+  SK_PARSE_DEPTH = 4,
+  SK_PARSE_STRING = 5,
+  SK_PARSE_NUMBER = 6
+} skParseError;
+
+/* Parse error is packed into the node data so creating it allocates nothing:
+ * code in the low 8 bits, depth in the next 16 bits and the byte offset in
+ * the remaining 40 bits, depth and offset saturate. */
+#define SK_ERROR_DEPTH_MAX 0xFFFFUL
+#define SK_ERROR_OFFSET_MAX SK_U64C(0xFF, 0xFFFFFFFFUL)
+#define ErrorNode_code(node) ((int)((node)->data.j_error & 0xFF))
+#define ErrorNode_depth(node) ((size_t)(((node)->data.j_error >> 8) & 0xFFFF))
+#define ErrorNode_offset(node) ((size_t)((node)->data.j_error >> 24))
+
 typedef struct _skJsonNode skJson;
 typedef struct skJsonMember skJsonMember;
 
-typedef struct {
-  void *ptr;
-  skNodeType type;
-} skArena;
-
 typedef union skNodeData {
   skVec *j_object;
   skVec *j_array;
@@ -34,31 +76,80 @@ typedef union skNodeData {
   skJsonInteger j_int;
   skJsonDouble j_double;
   skJsonBool j_boolean;
-  skJsonString j_err;
+  skU64 j_error;
+  char *j_rawnum;
+  char j_inline_tail[8];
 } skNodeData;
 
+/* Type tag (one of 'skNodeType') and flags are packed in front of the 8 byte
+ * payload, the whole node is 16 bytes on 64-bit targets. Bytes in between
+ * are the start of a string stored in the node, it continues over 'data'. */
 struct _skJsonNode {
-  skNodeType type;
+  unsigned short type;
+  unsigned char flags;
+  char j_inline[5];
   skNodeData data;
-  skArena parent_arena;
 };
 
+/* Storage of the string stored in NODE, it spans 'j_inline' and 'data' */
+#define Node_inline(node) ((char *)(node) + offsetof(skJson, j_inline))
+/* Longest string (without the terminator) that is stored in the node */
+#define SK_NODE_INLINE_MAX (sizeof(skJson) - offsetof(skJson, j_inline) - 1)
+/* String of the string or reference NODE */
+#define Node_string(node)                                                      \
+  (((node)->flags & SK_NODE_INLINE_VALUE) ? Node_inline(node)                  \
+                                          : (node)->data.j_string)
+
 typedef struct {
   skJson value;
   char *key;
 } skObjTuple;
 
+/* Number of elements containers have room for when their size is not known
+ * up front, the room is allocated together with the container and most
+ * containers never outgrow it. */
+#define SK_CONTAINER_INLINE 4
+
 skJson RawNode_new(skNodeType type, const skJson *parent);
 skJson ObjectNode_new(const skJson *parent);
 skJson ArrayNode_new(const skJson *parent);
+skJson ObjectNode_new_in(const skJson *parent, skPool *pool);
+skJson ArrayNode_new_in(const skJson *parent, skPool *pool);
+/* Containers with storage for exactly CAPACITY elements */
+skJson ObjectNode_new_sized(const skJson *parent, skPool *pool,
+                            size_t capacity);
+skJson ArrayNode_new_sized(const skJson *parent, skPool *pool,
+                           size_t capacity);
+skPool *Node_pool(const skJson *node);
 skJson StringNode_new(skJsonString str, skNodeType type, const skJson *parent);
+/* Stores first LEN bytes of STR (at most SK_NODE_INLINE_MAX) in the string
+ * NODE itself, string it stored before is not freed. */
+void StringNode_set_inline(skJson *node, const char *str, size_t len);
 skJson IntNode_new(skJsonInteger number, const skJson *parent);
 skJson DoubleNode_new(skJsonDouble number, const skJson *parent);
 skJson BoolNode_new(skJsonBool boolean, const skJson *parent);
+skJson RawNumNode_new(const char *text, size_t len, skPool *pool,
+                      const skJson *parent);
 skJson MemberNode_new(const char *key, const skJson *value,
                       const skJson *parent);
-skJson ErrorNode_new(skJsonString msg, skJsonState state, const skJson *parent);
+skJson ErrorNode_new(skParseError code, size_t offset, size_t depth,
+                    const skJson *parent);
 void skJsonNode_drop(skJson *node);
+
+/* Objects with at least this many members look up keys through a hash index
+ * instead of scanning them, smaller ones are faster to scan. */
+#ifndef SK_OBJECT_INDEX_MIN
+#define SK_OBJECT_INDEX_MIN 32
+#endif
+
+/* Finds the member of object NODE with KEY through the index of its keys kept
+ * in the slot of the members vector. Index is built on first use and catches up
+ * with the members pushed since. Sets INDEXED to false if the object has no
+ * index (small or pooled object, out of memory), the members must be scanned. */
+skObjTuple *ObjectNode_find(const skJson *node, const char *key, bool *indexed);
+/* Drops the key index of object NODE, it must be called before the members
+ * are removed, reordered or inserted anywhere but at the end. */
+void ObjectNode_drop_index(const skJson *node);
 void skObjTuple_drop(skObjTuple *tuple);
 
 #endif
@@ -0,0 +1,1647 @@
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+/* clang-format off */
+#include "sknumber.h"
+#include <float.h>
+#include <limits.h>
+#include <string.h>
+/* clang-format on */
+
+/* IEEE-754 binary64 layout */
+#define MANTISSA_BITS    52
+#define EXPONENT_BIAS    1023
+#define INFINITE_POWER   0x7FF
+/* Every integer up to 2^53 is exactly representable */
+#define MAX_EXACT_INT    (SK_U64C(0, 1) << (MANTISSA_BITS + 1))
+/* Range of decimal exponents covered by the table of powers of five */
+#define SMALLEST_POWER10 -342
+#define LARGEST_POWER10  308
+/* Range of decimal exponents where the product can be exactly half-way */
+#define MIN_ROUND_TO_EVEN -4
+#define MAX_ROUND_TO_EVEN 23
+
+/* Clinger's fast path needs double arithmetic without extended precision */
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+#define SK_NO_FAST_PATH
+#endif
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 skU128;
+#endif
+
+/* Result of the conversion before it is packed into double */
+typedef struct {
+    skU64 mantissa;
+    int   power2; /* Biased binary exponent */
+} skFloatBits;
+
+/* Normalized approximation of 10^k, f * 2^e */
+typedef struct {
+    skU64 f;
+    int   e;
+    int   k;
+} skCachedPower;
+
+/* Do-It-Yourself floating point number, f * 2^e */
+typedef struct {
+    skU64 f;
+    int   e;
+} skDiyFp;
+
+/* Exactly representable powers of ten */
+static const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/* Two decimal digits for each value in range [0, 99] */
+static const char DIGIT_PAIRS[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+/* Normalized 64-bit approximations of powers of ten (10^-300 up to
+ * 10^340 in steps of 8) for Grisu. */
+static const skCachedPower CACHED_POWERS[] = {
+    { SK_U64C(0xAB70FE17, 0xC79AC6CA), -1060, -300 },
+    { SK_U64C(0xFF77B1FC, 0xBEBCDC4F), -1034, -292 },
+    { SK_U64C(0xBE5691EF, 0x416BD60C), -1007, -284 },
+    { SK_U64C(0x8DD01FAD, 0x907FFC3C), -980, -276 },
+    { SK_U64C(0xD3515C28, 0x31559A83), -954, -268 },
+    { SK_U64C(0x9D71AC8F, 0xADA6C9B5), -927, -260 },
+    { SK_U64C(0xEA9C2277, 0x23EE8BCB), -901, -252 },
+    { SK_U64C(0xAECC4991, 0x4078536D), -874, -244 },
+    { SK_U64C(0x823C1279, 0x5DB6CE57), -847, -236 },
+    { SK_U64C(0xC2109436, 0x4DFB5637), -821, -228 },
+    { SK_U64C(0x9096EA6F, 0x3848984F), -794, -220 },
+    { SK_U64C(0xD77485CB, 0x25823AC7), -768, -212 },
+    { SK_U64C(0xA086CFCD, 0x97BF97F4), -741, -204 },
+    { SK_U64C(0xEF340A98, 0x172AACE5), -715, -196 },
+    { SK_U64C(0xB23867FB, 0x2A35B28E), -688, -188 },
+    { SK_U64C(0x84C8D4DF, 0xD2C63F3B), -661, -180 },
+    { SK_U64C(0xC5DD4427, 0x1AD3CDBA), -635, -172 },
+    { SK_U64C(0x936B9FCE, 0xBB25C996), -608, -164 },
+    { SK_U64C(0xDBAC6C24, 0x7D62A584), -582, -156 },
+    { SK_U64C(0xA3AB6658, 0x0D5FDAF6), -555, -148 },
+    { SK_U64C(0xF3E2F893, 0xDEC3F126), -529, -140 },
+    { SK_U64C(0xB5B5ADA8, 0xAAFF80B8), -502, -132 },
+    { SK_U64C(0x87625F05, 0x6C7C4A8B), -475, -124 },
+    { SK_U64C(0xC9BCFF60, 0x34C13053), -449, -116 },
+    { SK_U64C(0x964E858C, 0x91BA2655), -422, -108 },
+    { SK_U64C(0xDFF97724, 0x70297EBD), -396, -100 },
+    { SK_U64C(0xA6DFBD9F, 0xB8E5B88F), -369, -92 },
+    { SK_U64C(0xF8A95FCF, 0x88747D94), -343, -84 },
+    { SK_U64C(0xB9447093, 0x8FA89BCF), -316, -76 },
+    { SK_U64C(0x8A08F0F8, 0xBF0F156B), -289, -68 },
+    { SK_U64C(0xCDB02555, 0x653131B6), -263, -60 },
+    { SK_U64C(0x993FE2C6, 0xD07B7FAC), -236, -52 },
+    { SK_U64C(0xE45C10C4, 0x2A2B3B06), -210, -44 },
+    { SK_U64C(0xAA242499, 0x697392D3), -183, -36 },
+    { SK_U64C(0xFD87B5F2, 0x8300CA0E), -157, -28 },
+    { SK_U64C(0xBCE50864, 0x92111AEB), -130, -20 },
+    { SK_U64C(0x8CBCCC09, 0x6F5088CC), -103, -12 },
+    { SK_U64C(0xD1B71758, 0xE219652C), -77, -4 },
+    { SK_U64C(0x9C400000, 0x00000000), -50, 4 },
+    { SK_U64C(0xE8D4A510, 0x00000000), -24, 12 },
+    { SK_U64C(0xAD78EBC5, 0xAC620000), 3, 20 },
+    { SK_U64C(0x813F3978, 0xF8940984), 30, 28 },
+    { SK_U64C(0xC097CE7B, 0xC90715B3), 56, 36 },
+    { SK_U64C(0x8F7E32CE, 0x7BEA5C70), 83, 44 },
+    { SK_U64C(0xD5D238A4, 0xABE98068), 109, 52 },
+    { SK_U64C(0x9F4F2726, 0x179A2245), 136, 60 },
+    { SK_U64C(0xED63A231, 0xD4C4FB27), 162, 68 },
+    { SK_U64C(0xB0DE6538, 0x8CC8ADA8), 189, 76 },
+    { SK_U64C(0x83C7088E, 0x1AAB65DB), 216, 84 },
+    { SK_U64C(0xC45D1DF9, 0x42711D9A), 242, 92 },
+    { SK_U64C(0x924D692C, 0xA61BE758), 269, 100 },
+    { SK_U64C(0xDA01EE64, 0x1A708DEA), 295, 108 },
+    { SK_U64C(0xA26DA399, 0x9AEF774A), 322, 116 },
+    { SK_U64C(0xF209787B, 0xB47D6B85), 348, 124 },
+    { SK_U64C(0xB454E4A1, 0x79DD1877), 375, 132 },
+    { SK_U64C(0x865B8692, 0x5B9BC5C2), 402, 140 },
+    { SK_U64C(0xC83553C5, 0xC8965D3D), 428, 148 },
+    { SK_U64C(0x952AB45C, 0xFA97A0B3), 455, 156 },
+    { SK_U64C(0xDE469FBD, 0x99A05FE3), 481, 164 },
+    { SK_U64C(0xA59BC234, 0xDB398C25), 508, 172 },
+    { SK_U64C(0xF6C69A72, 0xA3989F5C), 534, 180 },
+    { SK_U64C(0xB7DCBF53, 0x54E9BECE), 561, 188 },
+    { SK_U64C(0x88FCF317, 0xF22241E2), 588, 196 },
+    { SK_U64C(0xCC20CE9B, 0xD35C78A5), 614, 204 },
+    { SK_U64C(0x98165AF3, 0x7B2153DF), 641, 212 },
+    { SK_U64C(0xE2A0B5DC, 0x971F303A), 667, 220 },
+    { SK_U64C(0xA8D9D153, 0x5CE3B396), 694, 228 },
+    { SK_U64C(0xFB9B7CD9, 0xA4A7443C), 720, 236 },
+    { SK_U64C(0xBB764C4C, 0xA7A44410), 747, 244 },
+    { SK_U64C(0x8BAB8EEF, 0xB6409C1A), 774, 252 },
+    { SK_U64C(0xD01FEF10, 0xA657842C), 800, 260 },
+    { SK_U64C(0x9B10A4E5, 0xE9913129), 827, 268 },
+    { SK_U64C(0xE7109BFB, 0xA19C0C9D), 853, 276 },
+    { SK_U64C(0xAC2820D9, 0x623BF429), 880, 284 },
+    { SK_U64C(0x80444B5E, 0x7AA7CF85), 907, 292 },
+    { SK_U64C(0xBF21E440, 0x03ACDD2D), 933, 300 },
+    { SK_U64C(0x8E679C2F, 0x5E44FF8F), 960, 308 },
+    { SK_U64C(0xD433179D, 0x9C8CB841), 986, 316 },
+    { SK_U64C(0x9E19DB92, 0xB4E31BA9), 1013, 324 },
+    { SK_U64C(0xEB96BF6E, 0xBADF77D9), 1039, 332 },
+    { SK_U64C(0xAF87023B, 0x9BF0EE6B), 1066, 340 },
+};
+
+/* 128-bit approximations of powers of five (5^-342 up to 5^308),
+ * normalized so that the most significant bit is set. Negative powers
+ * are rounded up, positive powers are truncated. */
+static const skU64 POW5_128[][2] = {
+    { SK_U64C(0xEEF453D6, 0x923BD65A), SK_U64C(0x113FAA29, 0x06A13B3F) }, /* 5^-342 */
+    { SK_U64C(0x9558B466, 0x1B6565F8), SK_U64C(0x4AC7CA59, 0xA424C507) }, /* 5^-341 */
+    { SK_U64C(0xBAAEE17F, 0xA23EBF76), SK_U64C(0x5D79BCF0, 0x0D2DF649) }, /* 5^-340 */
+    { SK_U64C(0xE95A99DF, 0x8ACE6F53), SK_U64C(0xF4D82C2C, 0x107973DC) }, /* 5^-339 */
+    { SK_U64C(0x91D8A02B, 0xB6C10594), SK_U64C(0x79071B9B, 0x8A4BE869) }, /* 5^-338 */
+    { SK_U64C(0xB64EC836, 0xA47146F9), SK_U64C(0x9748E282, 0x6CDEE284) }, /* 5^-337 */
+    { SK_U64C(0xE3E27A44, 0x4D8D98B7), SK_U64C(0xFD1B1B23, 0x08169B25) }, /* 5^-336 */
+    { SK_U64C(0x8E6D8C6A, 0xB0787F72), SK_U64C(0xFE30F0F5, 0xE50E20F7) }, /* 5^-335 */
+    { SK_U64C(0xB208EF85, 0x5C969F4F), SK_U64C(0xBDBD2D33, 0x5E51A935) }, /* 5^-334 */
+    { SK_U64C(0xDE8B2B66, 0xB3BC4723), SK_U64C(0xAD2C7880, 0x35E61382) }, /* 5^-333 */
+    { SK_U64C(0x8B16FB20, 0x3055AC76), SK_U64C(0x4C3BCB50, 0x21AFCC31) }, /* 5^-332 */
+    { SK_U64C(0xADDCB9E8, 0x3C6B1793), SK_U64C(0xDF4ABE24, 0x2A1BBF3D) }, /* 5^-331 */
+    { SK_U64C(0xD953E862, 0x4B85DD78), SK_U64C(0xD71D6DAD, 0x34A2AF0D) }, /* 5^-330 */
+    { SK_U64C(0x87D4713D, 0x6F33AA6B), SK_U64C(0x8672648C, 0x40E5AD68) }, /* 5^-329 */
+    { SK_U64C(0xA9C98D8C, 0xCB009506), SK_U64C(0x680EFDAF, 0x511F18C2) }, /* 5^-328 */
+    { SK_U64C(0xD43BF0EF, 0xFDC0BA48), SK_U64C(0x0212BD1B, 0x2566DEF2) }, /* 5^-327 */
+    { SK_U64C(0x84A57695, 0xFE98746D), SK_U64C(0x014BB630, 0xF7604B57) }, /* 5^-326 */
+    { SK_U64C(0xA5CED43B, 0x7E3E9188), SK_U64C(0x419EA3BD, 0x35385E2D) }, /* 5^-325 */
+    { SK_U64C(0xCF42894A, 0x5DCE35EA), SK_U64C(0x52064CAC, 0x828675B9) }, /* 5^-324 */
+    { SK_U64C(0x818995CE, 0x7AA0E1B2), SK_U64C(0x7343EFEB, 0xD1940993) }, /* 5^-323 */
+    { SK_U64C(0xA1EBFB42, 0x19491A1F), SK_U64C(0x1014EBE6, 0xC5F90BF8) }, /* 5^-322 */
+    { SK_U64C(0xCA66FA12, 0x9F9B60A6), SK_U64C(0xD41A26E0, 0x77774EF6) }, /* 5^-321 */
+    { SK_U64C(0xFD00B897, 0x478238D0), SK_U64C(0x8920B098, 0x955522B4) }, /* 5^-320 */
+    { SK_U64C(0x9E20735E, 0x8CB16382), SK_U64C(0x55B46E5F, 0x5D5535B0) }, /* 5^-319 */
+    { SK_U64C(0xC5A89036, 0x2FDDBC62), SK_U64C(0xEB2189F7, 0x34AA831D) }, /* 5^-318 */
+    { SK_U64C(0xF712B443, 0xBBD52B7B), SK_U64C(0xA5E9EC75, 0x01D523E4) }, /* 5^-317 */
+    { SK_U64C(0x9A6BB0AA, 0x55653B2D), SK_U64C(0x47B233C9, 0x2125366E) }, /* 5^-316 */
+    { SK_U64C(0xC1069CD4, 0xEABE89F8), SK_U64C(0x999EC0BB, 0x696E840A) }, /* 5^-315 */
+    { SK_U64C(0xF148440A, 0x256E2C76), SK_U64C(0xC00670EA, 0x43CA250D) }, /* 5^-314 */
+    { SK_U64C(0x96CD2A86, 0x5764DBCA), SK_U64C(0x38040692, 0x6A5E5728) }, /* 5^-313 */
+    { SK_U64C(0xBC807527, 0xED3E12BC), SK_U64C(0xC6050837, 0x04F5ECF2) }, /* 5^-312 */
+    { SK_U64C(0xEBA09271, 0xE88D976B), SK_U64C(0xF7864A44, 0xC633682E) }, /* 5^-311 */
+    { SK_U64C(0x93445B87, 0x31587EA3), SK_U64C(0x7AB3EE6A, 0xFBE0211D) }, /* 5^-310 */
+    { SK_U64C(0xB8157268, 0xFDAE9E4C), SK_U64C(0x5960EA05, 0xBAD82964) }, /* 5^-309 */
+    { SK_U64C(0xE61ACF03, 0x3D1A45DF), SK_U64C(0x6FB92487, 0x298E33BD) }, /* 5^-308 */
+    { SK_U64C(0x8FD0C162, 0x06306BAB), SK_U64C(0xA5D3B6D4, 0x79F8E056) }, /* 5^-307 */
+    { SK_U64C(0xB3C4F1BA, 0x87BC8696), SK_U64C(0x8F48A489, 0x9877186C) }, /* 5^-306 */
+    { SK_U64C(0xE0B62E29, 0x29ABA83C), SK_U64C(0x331ACDAB, 0xFE94DE87) }, /* 5^-305 */
+    { SK_U64C(0x8C71DCD9, 0xBA0B4925), SK_U64C(0x9FF0C08B, 0x7F1D0B14) }, /* 5^-304 */
+    { SK_U64C(0xAF8E5410, 0x288E1B6F), SK_U64C(0x07ECF0AE, 0x5EE44DD9) }, /* 5^-303 */
+    { SK_U64C(0xDB71E914, 0x32B1A24A), SK_U64C(0xC9E82CD9, 0xF69D6150) }, /* 5^-302 */
+    { SK_U64C(0x892731AC, 0x9FAF056E), SK_U64C(0xBE311C08, 0x3A225CD2) }, /* 5^-301 */
+    { SK_U64C(0xAB70FE17, 0xC79AC6CA), SK_U64C(0x6DBD630A, 0x48AAF406) }, /* 5^-300 */
+    { SK_U64C(0xD64D3D9D, 0xB981787D), SK_U64C(0x092CBBCC, 0xDAD5B108) }, /* 5^-299 */
+    { SK_U64C(0x85F04682, 0x93F0EB4E), SK_U64C(0x25BBF560, 0x08C58EA5) }, /* 5^-298 */
+    { SK_U64C(0xA76C5823, 0x38ED2621), SK_U64C(0xAF2AF2B8, 0x0AF6F24E) }, /* 5^-297 */
+    { SK_U64C(0xD1476E2C, 0x07286FAA), SK_U64C(0x1AF5AF66, 0x0DB4AEE1) }, /* 5^-296 */
+    { SK_U64C(0x82CCA4DB, 0x847945CA), SK_U64C(0x50D98D9F, 0xC890ED4D) }, /* 5^-295 */
+    { SK_U64C(0xA37FCE12, 0x6597973C), SK_U64C(0xE50FF107, 0xBAB528A0) }, /* 5^-294 */
+    { SK_U64C(0xCC5FC196, 0xFEFD7D0C), SK_U64C(0x1E53ED49, 0xA96272C8) }, /* 5^-293 */
+    { SK_U64C(0xFF77B1FC, 0xBEBCDC4F), SK_U64C(0x25E8E89C, 0x13BB0F7A) }, /* 5^-292 */
+    { SK_U64C(0x9FAACF3D, 0xF73609B1), SK_U64C(0x77B19161, 0x8C54E9AC) }, /* 5^-291 */
+    { SK_U64C(0xC795830D, 0x75038C1D), SK_U64C(0xD59DF5B9, 0xEF6A2417) }, /* 5^-290 */
+    { SK_U64C(0xF97AE3D0, 0xD2446F25), SK_U64C(0x4B057328, 0x6B44AD1D) }, /* 5^-289 */
+    { SK_U64C(0x9BECCE62, 0x836AC577), SK_U64C(0x4EE367F9, 0x430AEC32) }, /* 5^-288 */
+    { SK_U64C(0xC2E801FB, 0x244576D5), SK_U64C(0x229C41F7, 0x93CDA73F) }, /* 5^-287 */
+    { SK_U64C(0xF3A20279, 0xED56D48A), SK_U64C(0x6B435275, 0x78C1110F) }, /* 5^-286 */
+    { SK_U64C(0x9845418C, 0x345644D6), SK_U64C(0x830A1389, 0x6B78AAA9) }, /* 5^-285 */
+    { SK_U64C(0xBE5691EF, 0x416BD60C), SK_U64C(0x23CC986B, 0xC656D553) }, /* 5^-284 */
+    { SK_U64C(0xEDEC366B, 0x11C6CB8F), SK_U64C(0x2CBFBE86, 0xB7EC8AA8) }, /* 5^-283 */
+    { SK_U64C(0x94B3A202, 0xEB1C3F39), SK_U64C(0x7BF7D714, 0x32F3D6A9) }, /* 5^-282 */
+    { SK_U64C(0xB9E08A83, 0xA5E34F07), SK_U64C(0xDAF5CCD9, 0x3FB0CC53) }, /* 5^-281 */
+    { SK_U64C(0xE858AD24, 0x8F5C22C9), SK_U64C(0xD1B3400F, 0x8F9CFF68) }, /* 5^-280 */
+    { SK_U64C(0x91376C36, 0xD99995BE), SK_U64C(0x23100809, 0xB9C21FA1) }, /* 5^-279 */
+    { SK_U64C(0xB5854744, 0x8FFFFB2D), SK_U64C(0xABD40A0C, 0x2832A78A) }, /* 5^-278 */
+    { SK_U64C(0xE2E69915, 0xB3FFF9F9), SK_U64C(0x16C90C8F, 0x323F516C) }, /* 5^-277 */
+    { SK_U64C(0x8DD01FAD, 0x907FFC3B), SK_U64C(0xAE3DA7D9, 0x7F6792E3) }, /* 5^-276 */
+    { SK_U64C(0xB1442798, 0xF49FFB4A), SK_U64C(0x99CD11CF, 0xDF41779C) }, /* 5^-275 */
+    { SK_U64C(0xDD95317F, 0x31C7FA1D), SK_U64C(0x40405643, 0xD711D583) }, /* 5^-274 */
+    { SK_U64C(0x8A7D3EEF, 0x7F1CFC52), SK_U64C(0x482835EA, 0x666B2572) }, /* 5^-273 */
+    { SK_U64C(0xAD1C8EAB, 0x5EE43B66), SK_U64C(0xDA324365, 0x0005EECF) }, /* 5^-272 */
+    { SK_U64C(0xD863B256, 0x369D4A40), SK_U64C(0x90BED43E, 0x40076A82) }, /* 5^-271 */
+    { SK_U64C(0x873E4F75, 0xE2224E68), SK_U64C(0x5A7744A6, 0xE804A291) }, /* 5^-270 */
+    { SK_U64C(0xA90DE353, 0x5AAAE202), SK_U64C(0x711515D0, 0xA205CB36) }, /* 5^-269 */
+    { SK_U64C(0xD3515C28, 0x31559A83), SK_U64C(0x0D5A5B44, 0xCA873E03) }, /* 5^-268 */
+    { SK_U64C(0x8412D999, 0x1ED58091), SK_U64C(0xE858790A, 0xFE9486C2) }, /* 5^-267 */
+    { SK_U64C(0xA5178FFF, 0x668AE0B6), SK_U64C(0x626E974D, 0xBE39A872) }, /* 5^-266 */
+    { SK_U64C(0xCE5D73FF, 0x402D98E3), SK_U64C(0xFB0A3D21, 0x2DC8128F) }, /* 5^-265 */
+    { SK_U64C(0x80FA687F, 0x881C7F8E), SK_U64C(0x7CE66634, 0xBC9D0B99) }, /* 5^-264 */
+    { SK_U64C(0xA139029F, 0x6A239F72), SK_U64C(0x1C1FFFC1, 0xEBC44E80) }, /* 5^-263 */
+    { SK_U64C(0xC9874347, 0x44AC874E), SK_U64C(0xA327FFB2, 0x66B56220) }, /* 5^-262 */
+    { SK_U64C(0xFBE91419, 0x15D7A922), SK_U64C(0x4BF1FF9F, 0x0062BAA8) }, /* 5^-261 */
+    { SK_U64C(0x9D71AC8F, 0xADA6C9B5), SK_U64C(0x6F773FC3, 0x603DB4A9) }, /* 5^-260 */
+    { SK_U64C(0xC4CE17B3, 0x99107C22), SK_U64C(0xCB550FB4, 0x384D21D3) }, /* 5^-259 */
+    { SK_U64C(0xF6019DA0, 0x7F549B2B), SK_U64C(0x7E2A53A1, 0x46606A48) }, /* 5^-258 */
+    { SK_U64C(0x99C10284, 0x4F94E0FB), SK_U64C(0x2EDA7444, 0xCBFC426D) }, /* 5^-257 */
+    { SK_U64C(0xC0314325, 0x637A1939), SK_U64C(0xFA911155, 0xFEFB5308) }, /* 5^-256 */
+    { SK_U64C(0xF03D93EE, 0xBC589F88), SK_U64C(0x793555AB, 0x7EBA27CA) }, /* 5^-255 */
+    { SK_U64C(0x96267C75, 0x35B763B5), SK_U64C(0x4BC1558B, 0x2F3458DE) }, /* 5^-254 */
+    { SK_U64C(0xBBB01B92, 0x83253CA2), SK_U64C(0x9EB1AAED, 0xFB016F16) }, /* 5^-253 */
+    { SK_U64C(0xEA9C2277, 0x23EE8BCB), SK_U64C(0x465E15A9, 0x79C1CADC) }, /* 5^-252 */
+    { SK_U64C(0x92A1958A, 0x7675175F), SK_U64C(0x0BFACD89, 0xEC191EC9) }, /* 5^-251 */
+    { SK_U64C(0xB749FAED, 0x14125D36), SK_U64C(0xCEF980EC, 0x671F667B) }, /* 5^-250 */
+    { SK_U64C(0xE51C79A8, 0x5916F484), SK_U64C(0x82B7E127, 0x80E7401A) }, /* 5^-249 */
+    { SK_U64C(0x8F31CC09, 0x37AE58D2), SK_U64C(0xD1B2ECB8, 0xB0908810) }, /* 5^-248 */
+    { SK_U64C(0xB2FE3F0B, 0x8599EF07), SK_U64C(0x861FA7E6, 0xDCB4AA15) }, /* 5^-247 */
+    { SK_U64C(0xDFBDCECE, 0x67006AC9), SK_U64C(0x67A791E0, 0x93E1D49A) }, /* 5^-246 */
+    { SK_U64C(0x8BD6A141, 0x006042BD), SK_U64C(0xE0C8BB2C, 0x5C6D24E0) }, /* 5^-245 */
+    { SK_U64C(0xAECC4991, 0x4078536D), SK_U64C(0x58FAE9F7, 0x73886E18) }, /* 5^-244 */
+    { SK_U64C(0xDA7F5BF5, 0x90966848), SK_U64C(0xAF39A475, 0x506A899E) }, /* 5^-243 */
+    { SK_U64C(0x888F9979, 0x7A5E012D), SK_U64C(0x6D8406C9, 0x52429603) }, /* 5^-242 */
+    { SK_U64C(0xAAB37FD7, 0xD8F58178), SK_U64C(0xC8E5087B, 0xA6D33B83) }, /* 5^-241 */
+    { SK_U64C(0xD5605FCD, 0xCF32E1D6), SK_U64C(0xFB1E4A9A, 0x90880A64) }, /* 5^-240 */
+    { SK_U64C(0x855C3BE0, 0xA17FCD26), SK_U64C(0x5CF2EEA0, 0x9A55067F) }, /* 5^-239 */
+    { SK_U64C(0xA6B34AD8, 0xC9DFC06F), SK_U64C(0xF42FAA48, 0xC0EA481E) }, /* 5^-238 */
+    { SK_U64C(0xD0601D8E, 0xFC57B08B), SK_U64C(0xF13B94DA, 0xF124DA26) }, /* 5^-237 */
+    { SK_U64C(0x823C1279, 0x5DB6CE57), SK_U64C(0x76C53D08, 0xD6B70858) }, /* 5^-236 */
+    { SK_U64C(0xA2CB1717, 0xB52481ED), SK_U64C(0x54768C4B, 0x0C64CA6E) }, /* 5^-235 */
+    { SK_U64C(0xCB7DDCDD, 0xA26DA268), SK_U64C(0xA9942F5D, 0xCF7DFD09) }, /* 5^-234 */
+    { SK_U64C(0xFE5D5415, 0x0B090B02), SK_U64C(0xD3F93B35, 0x435D7C4C) }, /* 5^-233 */
+    { SK_U64C(0x9EFA548D, 0x26E5A6E1), SK_U64C(0xC47BC501, 0x4A1A6DAF) }, /* 5^-232 */
+    { SK_U64C(0xC6B8E9B0, 0x709F109A), SK_U64C(0x359AB641, 0x9CA1091B) }, /* 5^-231 */
+    { SK_U64C(0xF867241C, 0x8CC6D4C0), SK_U64C(0xC30163D2, 0x03C94B62) }, /* 5^-230 */
+    { SK_U64C(0x9B407691, 0xD7FC44F8), SK_U64C(0x79E0DE63, 0x425DCF1D) }, /* 5^-229 */
+    { SK_U64C(0xC2109436, 0x4DFB5636), SK_U64C(0x985915FC, 0x12F542E4) }, /* 5^-228 */
+    { SK_U64C(0xF294B943, 0xE17A2BC4), SK_U64C(0x3E6F5B7B, 0x17B2939D) }, /* 5^-227 */
+    { SK_U64C(0x979CF3CA, 0x6CEC5B5A), SK_U64C(0xA705992C, 0xEECF9C42) }, /* 5^-226 */
+    { SK_U64C(0xBD8430BD, 0x08277231), SK_U64C(0x50C6FF78, 0x2A838353) }, /* 5^-225 */
+    { SK_U64C(0xECE53CEC, 0x4A314EBD), SK_U64C(0xA4F8BF56, 0x35246428) }, /* 5^-224 */
+    { SK_U64C(0x940F4613, 0xAE5ED136), SK_U64C(0x871B7795, 0xE136BE99) }, /* 5^-223 */
+    { SK_U64C(0xB9131798, 0x99F68584), SK_U64C(0x28E2557B, 0x59846E3F) }, /* 5^-222 */
+    { SK_U64C(0xE757DD7E, 0xC07426E5), SK_U64C(0x331AEADA, 0x2FE589CF) }, /* 5^-221 */
+    { SK_U64C(0x9096EA6F, 0x3848984F), SK_U64C(0x3FF0D2C8, 0x5DEF7621) }, /* 5^-220 */
+    { SK_U64C(0xB4BCA50B, 0x065ABE63), SK_U64C(0x0FED077A, 0x756B53A9) }, /* 5^-219 */
+    { SK_U64C(0xE1EBCE4D, 0xC7F16DFB), SK_U64C(0xD3E84959, 0x12C62894) }, /* 5^-218 */
+    { SK_U64C(0x8D3360F0, 0x9CF6E4BD), SK_U64C(0x64712DD7, 0xABBBD95C) }, /* 5^-217 */
+    { SK_U64C(0xB080392C, 0xC4349DEC), SK_U64C(0xBD8D794D, 0x96AACFB3) }, /* 5^-216 */
+    { SK_U64C(0xDCA04777, 0xF541C567), SK_U64C(0xECF0D7A0, 0xFC5583A0) }, /* 5^-215 */
+    { SK_U64C(0x89E42CAA, 0xF9491B60), SK_U64C(0xF41686C4, 0x9DB57244) }, /* 5^-214 */
+    { SK_U64C(0xAC5D37D5, 0xB79B6239), SK_U64C(0x311C2875, 0xC522CED5) }, /* 5^-213 */
+    { SK_U64C(0xD77485CB, 0x25823AC7), SK_U64C(0x7D633293, 0x366B828B) }, /* 5^-212 */
+    { SK_U64C(0x86A8D39E, 0xF77164BC), SK_U64C(0xAE5DFF9C, 0x02033197) }, /* 5^-211 */
+    { SK_U64C(0xA8530886, 0xB54DBDEB), SK_U64C(0xD9F57F83, 0x0283FDFC) }, /* 5^-210 */
+    { SK_U64C(0xD267CAA8, 0x62A12D66), SK_U64C(0xD072DF63, 0xC324FD7B) }, /* 5^-209 */
+    { SK_U64C(0x8380DEA9, 0x3DA4BC60), SK_U64C(0x4247CB9E, 0x59F71E6D) }, /* 5^-208 */
+    { SK_U64C(0xA4611653, 0x8D0DEB78), SK_U64C(0x52D9BE85, 0xF074E608) }, /* 5^-207 */
+    { SK_U64C(0xCD795BE8, 0x70516656), SK_U64C(0x67902E27, 0x6C921F8B) }, /* 5^-206 */
+    { SK_U64C(0x806BD971, 0x4632DFF6), SK_U64C(0x00BA1CD8, 0xA3DB53B6) }, /* 5^-205 */
+    { SK_U64C(0xA086CFCD, 0x97BF97F3), SK_U64C(0x80E8A40E, 0xCCD228A4) }, /* 5^-204 */
+    { SK_U64C(0xC8A883C0, 0xFDAF7DF0), SK_U64C(0x6122CD12, 0x8006B2CD) }, /* 5^-203 */
+    { SK_U64C(0xFAD2A4B1, 0x3D1B5D6C), SK_U64C(0x796B8057, 0x20085F81) }, /* 5^-202 */
+    { SK_U64C(0x9CC3A6EE, 0xC6311A63), SK_U64C(0xCBE33036, 0x74053BB0) }, /* 5^-201 */
+    { SK_U64C(0xC3F490AA, 0x77BD60FC), SK_U64C(0xBEDBFC44, 0x11068A9C) }, /* 5^-200 */
+    { SK_U64C(0xF4F1B4D5, 0x15ACB93B), SK_U64C(0xEE92FB55, 0x15482D44) }, /* 5^-199 */
+    { SK_U64C(0x99171105, 0x2D8BF3C5), SK_U64C(0x751BDD15, 0x2D4D1C4A) }, /* 5^-198 */
+    { SK_U64C(0xBF5CD546, 0x78EEF0B6), SK_U64C(0xD262D45A, 0x78A0635D) }, /* 5^-197 */
+    { SK_U64C(0xEF340A98, 0x172AACE4), SK_U64C(0x86FB8971, 0x16C87C34) }, /* 5^-196 */
+    { SK_U64C(0x9580869F, 0x0E7AAC0E), SK_U64C(0xD45D35E6, 0xAE3D4DA0) }, /* 5^-195 */
+    { SK_U64C(0xBAE0A846, 0xD2195712), SK_U64C(0x89748360, 0x59CCA109) }, /* 5^-194 */
+    { SK_U64C(0xE998D258, 0x869FACD7), SK_U64C(0x2BD1A438, 0x703FC94B) }, /* 5^-193 */
+    { SK_U64C(0x91FF8377, 0x5423CC06), SK_U64C(0x7B6306A3, 0x4627DDCF) }, /* 5^-192 */
+    { SK_U64C(0xB67F6455, 0x292CBF08), SK_U64C(0x1A3BC84C, 0x17B1D542) }, /* 5^-191 */
+    { SK_U64C(0xE41F3D6A, 0x7377EECA), SK_U64C(0x20CABA5F, 0x1D9E4A93) }, /* 5^-190 */
+    { SK_U64C(0x8E938662, 0x882AF53E), SK_U64C(0x547EB47B, 0x7282EE9C) }, /* 5^-189 */
+    { SK_U64C(0xB23867FB, 0x2A35B28D), SK_U64C(0xE99E619A, 0x4F23AA43) }, /* 5^-188 */
+    { SK_U64C(0xDEC681F9, 0xF4C31F31), SK_U64C(0x6405FA00, 0xE2EC94D4) }, /* 5^-187 */
+    { SK_U64C(0x8B3C113C, 0x38F9F37E), SK_U64C(0xDE83BC40, 0x8DD3DD04) }, /* 5^-186 */
+    { SK_U64C(0xAE0B158B, 0x4738705E), SK_U64C(0x9624AB50, 0xB148D445) }, /* 5^-185 */
+    { SK_U64C(0xD98DDAEE, 0x19068C76), SK_U64C(0x3BADD624, 0xDD9B0957) }, /* 5^-184 */
+    { SK_U64C(0x87F8A8D4, 0xCFA417C9), SK_U64C(0xE54CA5D7, 0x0A80E5D6) }, /* 5^-183 */
+    { SK_U64C(0xA9F6D30A, 0x038D1DBC), SK_U64C(0x5E9FCF4C, 0xCD211F4C) }, /* 5^-182 */
+    { SK_U64C(0xD47487CC, 0x8470652B), SK_U64C(0x7647C320, 0x0069671F) }, /* 5^-181 */
+    { SK_U64C(0x84C8D4DF, 0xD2C63F3B), SK_U64C(0x29ECD9F4, 0x0041E073) }, /* 5^-180 */
+    { SK_U64C(0xA5FB0A17, 0xC777CF09), SK_U64C(0xF4681071, 0x00525890) }, /* 5^-179 */
+    { SK_U64C(0xCF79CC9D, 0xB955C2CC), SK_U64C(0x7182148D, 0x4066EEB4) }, /* 5^-178 */
+    { SK_U64C(0x81AC1FE2, 0x93D599BF), SK_U64C(0xC6F14CD8, 0x48405530) }, /* 5^-177 */
+    { SK_U64C(0xA21727DB, 0x38CB002F), SK_U64C(0xB8ADA00E, 0x5A506A7C) }, /* 5^-176 */
+    { SK_U64C(0xCA9CF1D2, 0x06FDC03B), SK_U64C(0xA6D90811, 0xF0E4851C) }, /* 5^-175 */
+    { SK_U64C(0xFD442E46, 0x88BD304A), SK_U64C(0x908F4A16, 0x6D1DA663) }, /* 5^-174 */
+    { SK_U64C(0x9E4A9CEC, 0x15763E2E), SK_U64C(0x9A598E4E, 0x043287FE) }, /* 5^-173 */
+    { SK_U64C(0xC5DD4427, 0x1AD3CDBA), SK_U64C(0x40EFF1E1, 0x853F29FD) }, /* 5^-172 */
+    { SK_U64C(0xF7549530, 0xE188C128), SK_U64C(0xD12BEE59, 0xE68EF47C) }, /* 5^-171 */
+    { SK_U64C(0x9A94DD3E, 0x8CF578B9), SK_U64C(0x82BB74F8, 0x301958CE) }, /* 5^-170 */
+    { SK_U64C(0xC13A148E, 0x3032D6E7), SK_U64C(0xE36A5236, 0x3C1FAF01) }, /* 5^-169 */
+    { SK_U64C(0xF18899B1, 0xBC3F8CA1), SK_U64C(0xDC44E6C3, 0xCB279AC1) }, /* 5^-168 */
+    { SK_U64C(0x96F5600F, 0x15A7B7E5), SK_U64C(0x29AB103A, 0x5EF8C0B9) }, /* 5^-167 */
+    { SK_U64C(0xBCB2B812, 0xDB11A5DE), SK_U64C(0x7415D448, 0xF6B6F0E7) }, /* 5^-166 */
+    { SK_U64C(0xEBDF6617, 0x91D60F56), SK_U64C(0x111B495B, 0x3464AD21) }, /* 5^-165 */
+    { SK_U64C(0x936B9FCE, 0xBB25C995), SK_U64C(0xCAB10DD9, 0x00BEEC34) }, /* 5^-164 */
+    { SK_U64C(0xB84687C2, 0x69EF3BFB), SK_U64C(0x3D5D514F, 0x40EEA742) }, /* 5^-163 */
+    { SK_U64C(0xE65829B3, 0x046B0AFA), SK_U64C(0x0CB4A5A3, 0x112A5112) }, /* 5^-162 */
+    { SK_U64C(0x8FF71A0F, 0xE2C2E6DC), SK_U64C(0x47F0E785, 0xEABA72AB) }, /* 5^-161 */
+    { SK_U64C(0xB3F4E093, 0xDB73A093), SK_U64C(0x59ED2167, 0x65690F56) }, /* 5^-160 */
+    { SK_U64C(0xE0F218B8, 0xD25088B8), SK_U64C(0x306869C1, 0x3EC3532C) }, /* 5^-159 */
+    { SK_U64C(0x8C974F73, 0x83725573), SK_U64C(0x1E414218, 0xC73A13FB) }, /* 5^-158 */
+    { SK_U64C(0xAFBD2350, 0x644EEACF), SK_U64C(0xE5D1929E, 0xF90898FA) }, /* 5^-157 */
+    { SK_U64C(0xDBAC6C24, 0x7D62A583), SK_U64C(0xDF45F746, 0xB74ABF39) }, /* 5^-156 */
+    { SK_U64C(0x894BC396, 0xCE5DA772), SK_U64C(0x6B8BBA8C, 0x328EB783) }, /* 5^-155 */
+    { SK_U64C(0xAB9EB47C, 0x81F5114F), SK_U64C(0x066EA92F, 0x3F326564) }, /* 5^-154 */
+    { SK_U64C(0xD686619B, 0xA27255A2), SK_U64C(0xC80A537B, 0x0EFEFEBD) }, /* 5^-153 */
+    { SK_U64C(0x8613FD01, 0x45877585), SK_U64C(0xBD06742C, 0xE95F5F36) }, /* 5^-152 */
+    { SK_U64C(0xA798FC41, 0x96E952E7), SK_U64C(0x2C481138, 0x23B73704) }, /* 5^-151 */
+    { SK_U64C(0xD17F3B51, 0xFCA3A7A0), SK_U64C(0xF75A1586, 0x2CA504C5) }, /* 5^-150 */
+    { SK_U64C(0x82EF8513, 0x3DE648C4), SK_U64C(0x9A984D73, 0xDBE722FB) }, /* 5^-149 */
+    { SK_U64C(0xA3AB6658, 0x0D5FDAF5), SK_U64C(0xC13E60D0, 0xD2E0EBBA) }, /* 5^-148 */
+    { SK_U64C(0xCC963FEE, 0x10B7D1B3), SK_U64C(0x318DF905, 0x079926A8) }, /* 5^-147 */
+    { SK_U64C(0xFFBBCFE9, 0x94E5C61F), SK_U64C(0xFDF17746, 0x497F7052) }, /* 5^-146 */
+    { SK_U64C(0x9FD561F1, 0xFD0F9BD3), SK_U64C(0xFEB6EA8B, 0xEDEFA633) }, /* 5^-145 */
+    { SK_U64C(0xC7CABA6E, 0x7C5382C8), SK_U64C(0xFE64A52E, 0xE96B8FC0) }, /* 5^-144 */
+    { SK_U64C(0xF9BD690A, 0x1B68637B), SK_U64C(0x3DFDCE7A, 0xA3C673B0) }, /* 5^-143 */
+    { SK_U64C(0x9C1661A6, 0x51213E2D), SK_U64C(0x06BEA10C, 0xA65C084E) }, /* 5^-142 */
+    { SK_U64C(0xC31BFA0F, 0xE5698DB8), SK_U64C(0x486E494F, 0xCFF30A62) }, /* 5^-141 */
+    { SK_U64C(0xF3E2F893, 0xDEC3F126), SK_U64C(0x5A89DBA3, 0xC3EFCCFA) }, /* 5^-140 */
+    { SK_U64C(0x986DDB5C, 0x6B3A76B7), SK_U64C(0xF8962946, 0x5A75E01C) }, /* 5^-139 */
+    { SK_U64C(0xBE895233, 0x86091465), SK_U64C(0xF6BBB397, 0xF1135823) }, /* 5^-138 */
+    { SK_U64C(0xEE2BA6C0, 0x678B597F), SK_U64C(0x746AA07D, 0xED582E2C) }, /* 5^-137 */
+    { SK_U64C(0x94DB4838, 0x40B717EF), SK_U64C(0xA8C2A44E, 0xB4571CDC) }, /* 5^-136 */
+    { SK_U64C(0xBA121A46, 0x50E4DDEB), SK_U64C(0x92F34D62, 0x616CE413) }, /* 5^-135 */
+    { SK_U64C(0xE896A0D7, 0xE51E1566), SK_U64C(0x77B020BA, 0xF9C81D17) }, /* 5^-134 */
+    { SK_U64C(0x915E2486, 0xEF32CD60), SK_U64C(0x0ACE1474, 0xDC1D122E) }, /* 5^-133 */
+    { SK_U64C(0xB5B5ADA8, 0xAAFF80B8), SK_U64C(0x0D819992, 0x132456BA) }, /* 5^-132 */
+    { SK_U64C(0xE3231912, 0xD5BF60E6), SK_U64C(0x10E1FFF6, 0x97ED6C69) }, /* 5^-131 */
+    { SK_U64C(0x8DF5EFAB, 0xC5979C8F), SK_U64C(0xCA8D3FFA, 0x1EF463C1) }, /* 5^-130 */
+    { SK_U64C(0xB1736B96, 0xB6FD83B3), SK_U64C(0xBD308FF8, 0xA6B17CB2) }, /* 5^-129 */
+    { SK_U64C(0xDDD0467C, 0x64BCE4A0), SK_U64C(0xAC7CB3F6, 0xD05DDBDE) }, /* 5^-128 */
+    { SK_U64C(0x8AA22C0D, 0xBEF60EE4), SK_U64C(0x6BCDF07A, 0x423AA96B) }, /* 5^-127 */
+    { SK_U64C(0xAD4AB711, 0x2EB3929D), SK_U64C(0x86C16C98, 0xD2C953C6) }, /* 5^-126 */
+    { SK_U64C(0xD89D64D5, 0x7A607744), SK_U64C(0xE871C7BF, 0x077BA8B7) }, /* 5^-125 */
+    { SK_U64C(0x87625F05, 0x6C7C4A8B), SK_U64C(0x11471CD7, 0x64AD4972) }, /* 5^-124 */
+    { SK_U64C(0xA93AF6C6, 0xC79B5D2D), SK_U64C(0xD598E40D, 0x3DD89BCF) }, /* 5^-123 */
+    { SK_U64C(0xD389B478, 0x79823479), SK_U64C(0x4AFF1D10, 0x8D4EC2C3) }, /* 5^-122 */
+    { SK_U64C(0x843610CB, 0x4BF160CB), SK_U64C(0xCEDF722A, 0x585139BA) }, /* 5^-121 */
+    { SK_U64C(0xA54394FE, 0x1EEDB8FE), SK_U64C(0xC2974EB4, 0xEE658828) }, /* 5^-120 */
+    { SK_U64C(0xCE947A3D, 0xA6A9273E), SK_U64C(0x733D2262, 0x29FEEA32) }, /* 5^-119 */
+    { SK_U64C(0x811CCC66, 0x8829B887), SK_U64C(0x0806357D, 0x5A3F525F) }, /* 5^-118 */
+    { SK_U64C(0xA163FF80, 0x2A3426A8), SK_U64C(0xCA07C2DC, 0xB0CF26F7) }, /* 5^-117 */
+    { SK_U64C(0xC9BCFF60, 0x34C13052), SK_U64C(0xFC89B393, 0xDD02F0B5) }, /* 5^-116 */
+    { SK_U64C(0xFC2C3F38, 0x41F17C67), SK_U64C(0xBBAC2078, 0xD443ACE2) }, /* 5^-115 */
+    { SK_U64C(0x9D9BA783, 0x2936EDC0), SK_U64C(0xD54B944B, 0x84AA4C0D) }, /* 5^-114 */
+    { SK_U64C(0xC5029163, 0xF384A931), SK_U64C(0x0A9E795E, 0x65D4DF11) }, /* 5^-113 */
+    { SK_U64C(0xF64335BC, 0xF065D37D), SK_U64C(0x4D4617B5, 0xFF4A16D5) }, /* 5^-112 */
+    { SK_U64C(0x99EA0196, 0x163FA42E), SK_U64C(0x504BCED1, 0xBF8E4E45) }, /* 5^-111 */
+    { SK_U64C(0xC06481FB, 0x9BCF8D39), SK_U64C(0xE45EC286, 0x2F71E1D6) }, /* 5^-110 */
+    { SK_U64C(0xF07DA27A, 0x82C37088), SK_U64C(0x5D767327, 0xBB4E5A4C) }, /* 5^-109 */
+    { SK_U64C(0x964E858C, 0x91BA2655), SK_U64C(0x3A6A07F8, 0xD510F86F) }, /* 5^-108 */
+    { SK_U64C(0xBBE226EF, 0xB628AFEA), SK_U64C(0x890489F7, 0x0A55368B) }, /* 5^-107 */
+    { SK_U64C(0xEADAB0AB, 0xA3B2DBE5), SK_U64C(0x2B45AC74, 0xCCEA842E) }, /* 5^-106 */
+    { SK_U64C(0x92C8AE6B, 0x464FC96F), SK_U64C(0x3B0B8BC9, 0x0012929D) }, /* 5^-105 */
+    { SK_U64C(0xB77ADA06, 0x17E3BBCB), SK_U64C(0x09CE6EBB, 0x40173744) }, /* 5^-104 */
+    { SK_U64C(0xE5599087, 0x9DDCAABD), SK_U64C(0xCC420A6A, 0x101D0515) }, /* 5^-103 */
+    { SK_U64C(0x8F57FA54, 0xC2A9EAB6), SK_U64C(0x9FA94682, 0x4A12232D) }, /* 5^-102 */
+    { SK_U64C(0xB32DF8E9, 0xF3546564), SK_U64C(0x47939822, 0xDC96ABF9) }, /* 5^-101 */
+    { SK_U64C(0xDFF97724, 0x70297EBD), SK_U64C(0x59787E2B, 0x93BC56F7) }, /* 5^-100 */
+    { SK_U64C(0x8BFBEA76, 0xC619EF36), SK_U64C(0x57EB4EDB, 0x3C55B65A) }, /* 5^-99 */
+    { SK_U64C(0xAEFAE514, 0x77A06B03), SK_U64C(0xEDE62292, 0x0B6B23F1) }, /* 5^-98 */
+    { SK_U64C(0xDAB99E59, 0x958885C4), SK_U64C(0xE95FAB36, 0x8E45ECED) }, /* 5^-97 */
+    { SK_U64C(0x88B402F7, 0xFD75539B), SK_U64C(0x11DBCB02, 0x18EBB414) }, /* 5^-96 */
+    { SK_U64C(0xAAE103B5, 0xFCD2A881), SK_U64C(0xD652BDC2, 0x9F26A119) }, /* 5^-95 */
+    { SK_U64C(0xD59944A3, 0x7C0752A2), SK_U64C(0x4BE76D33, 0x46F0495F) }, /* 5^-94 */
+    { SK_U64C(0x857FCAE6, 0x2D8493A5), SK_U64C(0x6F70A440, 0x0C562DDB) }, /* 5^-93 */
+    { SK_U64C(0xA6DFBD9F, 0xB8E5B88E), SK_U64C(0xCB4CCD50, 0x0F6BB952) }, /* 5^-92 */
+    { SK_U64C(0xD097AD07, 0xA71F26B2), SK_U64C(0x7E2000A4, 0x1346A7A7) }, /* 5^-91 */
+    { SK_U64C(0x825ECC24, 0xC873782F), SK_U64C(0x8ED40066, 0x8C0C28C8) }, /* 5^-90 */
+    { SK_U64C(0xA2F67F2D, 0xFA90563B), SK_U64C(0x72890080, 0x2F0F32FA) }, /* 5^-89 */
+    { SK_U64C(0xCBB41EF9, 0x79346BCA), SK_U64C(0x4F2B40A0, 0x3AD2FFB9) }, /* 5^-88 */
+    { SK_U64C(0xFEA126B7, 0xD78186BC), SK_U64C(0xE2F610C8, 0x4987BFA8) }, /* 5^-87 */
+    { SK_U64C(0x9F24B832, 0xE6B0F436), SK_U64C(0x0DD9CA7D, 0x2DF4D7C9) }, /* 5^-86 */
+    { SK_U64C(0xC6EDE63F, 0xA05D3143), SK_U64C(0x91503D1C, 0x79720DBB) }, /* 5^-85 */
+    { SK_U64C(0xF8A95FCF, 0x88747D94), SK_U64C(0x75A44C63, 0x97CE912A) }, /* 5^-84 */
+    { SK_U64C(0x9B69DBE1, 0xB548CE7C), SK_U64C(0xC986AFBE, 0x3EE11ABA) }, /* 5^-83 */
+    { SK_U64C(0xC24452DA, 0x229B021B), SK_U64C(0xFBE85BAD, 0xCE996168) }, /* 5^-82 */
+    { SK_U64C(0xF2D56790, 0xAB41C2A2), SK_U64C(0xFAE27299, 0x423FB9C3) }, /* 5^-81 */
+    { SK_U64C(0x97C560BA, 0x6B0919A5), SK_U64C(0xDCCD879F, 0xC967D41A) }, /* 5^-80 */
+    { SK_U64C(0xBDB6B8E9, 0x05CB600F), SK_U64C(0x5400E987, 0xBBC1C920) }, /* 5^-79 */
+    { SK_U64C(0xED246723, 0x473E3813), SK_U64C(0x290123E9, 0xAAB23B68) }, /* 5^-78 */
+    { SK_U64C(0x9436C076, 0x0C86E30B), SK_U64C(0xF9A0B672, 0x0AAF6521) }, /* 5^-77 */
+    { SK_U64C(0xB9447093, 0x8FA89BCE), SK_U64C(0xF808E40E, 0x8D5B3E69) }, /* 5^-76 */
+    { SK_U64C(0xE7958CB8, 0x7392C2C2), SK_U64C(0xB60B1D12, 0x30B20E04) }, /* 5^-75 */
+    { SK_U64C(0x90BD77F3, 0x483BB9B9), SK_U64C(0xB1C6F22B, 0x5E6F48C2) }, /* 5^-74 */
+    { SK_U64C(0xB4ECD5F0, 0x1A4AA828), SK_U64C(0x1E38AEB6, 0x360B1AF3) }, /* 5^-73 */
+    { SK_U64C(0xE2280B6C, 0x20DD5232), SK_U64C(0x25C6DA63, 0xC38DE1B0) }, /* 5^-72 */
+    { SK_U64C(0x8D590723, 0x948A535F), SK_U64C(0x579C487E, 0x5A38AD0E) }, /* 5^-71 */
+    { SK_U64C(0xB0AF48EC, 0x79ACE837), SK_U64C(0x2D835A9D, 0xF0C6D851) }, /* 5^-70 */
+    { SK_U64C(0xDCDB1B27, 0x98182244), SK_U64C(0xF8E43145, 0x6CF88E65) }, /* 5^-69 */
+    { SK_U64C(0x8A08F0F8, 0xBF0F156B), SK_U64C(0x1B8E9ECB, 0x641B58FF) }, /* 5^-68 */
+    { SK_U64C(0xAC8B2D36, 0xEED2DAC5), SK_U64C(0xE272467E, 0x3D222F3F) }, /* 5^-67 */
+    { SK_U64C(0xD7ADF884, 0xAA879177), SK_U64C(0x5B0ED81D, 0xCC6ABB0F) }, /* 5^-66 */
+    { SK_U64C(0x86CCBB52, 0xEA94BAEA), SK_U64C(0x98E94712, 0x9FC2B4E9) }, /* 5^-65 */
+    { SK_U64C(0xA87FEA27, 0xA539E9A5), SK_U64C(0x3F2398D7, 0x47B36224) }, /* 5^-64 */
+    { SK_U64C(0xD29FE4B1, 0x8E88640E), SK_U64C(0x8EEC7F0D, 0x19A03AAD) }, /* 5^-63 */
+    { SK_U64C(0x83A3EEEE, 0xF9153E89), SK_U64C(0x1953CF68, 0x300424AC) }, /* 5^-62 */
+    { SK_U64C(0xA48CEAAA, 0xB75A8E2B), SK_U64C(0x5FA8C342, 0x3C052DD7) }, /* 5^-61 */
+    { SK_U64C(0xCDB02555, 0x653131B6), SK_U64C(0x3792F412, 0xCB06794D) }, /* 5^-60 */
+    { SK_U64C(0x808E1755, 0x5F3EBF11), SK_U64C(0xE2BBD88B, 0xBEE40BD0) }, /* 5^-59 */
+    { SK_U64C(0xA0B19D2A, 0xB70E6ED6), SK_U64C(0x5B6ACEAE, 0xAE9D0EC4) }, /* 5^-58 */
+    { SK_U64C(0xC8DE0475, 0x64D20A8B), SK_U64C(0xF245825A, 0x5A445275) }, /* 5^-57 */
+    { SK_U64C(0xFB158592, 0xBE068D2E), SK_U64C(0xEED6E2F0, 0xF0D56712) }, /* 5^-56 */
+    { SK_U64C(0x9CED737B, 0xB6C4183D), SK_U64C(0x55464DD6, 0x9685606B) }, /* 5^-55 */
+    { SK_U64C(0xC428D05A, 0xA4751E4C), SK_U64C(0xAA97E14C, 0x3C26B886) }, /* 5^-54 */
+    { SK_U64C(0xF5330471, 0x4D9265DF), SK_U64C(0xD53DD99F, 0x4B3066A8) }, /* 5^-53 */
+    { SK_U64C(0x993FE2C6, 0xD07B7FAB), SK_U64C(0xE546A803, 0x8EFE4029) }, /* 5^-52 */
+    { SK_U64C(0xBF8FDB78, 0x849A5F96), SK_U64C(0xDE985204, 0x72BDD033) }, /* 5^-51 */
+    { SK_U64C(0xEF73D256, 0xA5C0F77C), SK_U64C(0x963E6685, 0x8F6D4440) }, /* 5^-50 */
+    { SK_U64C(0x95A86376, 0x27989AAD), SK_U64C(0xDDE70013, 0x79A44AA8) }, /* 5^-49 */
+    { SK_U64C(0xBB127C53, 0xB17EC159), SK_U64C(0x5560C018, 0x580D5D52) }, /* 5^-48 */
+    { SK_U64C(0xE9D71B68, 0x9DDE71AF), SK_U64C(0xAAB8F01E, 0x6E10B4A6) }, /* 5^-47 */
+    { SK_U64C(0x92267121, 0x62AB070D), SK_U64C(0xCAB39613, 0x04CA70E8) }, /* 5^-46 */
+    { SK_U64C(0xB6B00D69, 0xBB55C8D1), SK_U64C(0x3D607B97, 0xC5FD0D22) }, /* 5^-45 */
+    { SK_U64C(0xE45C10C4, 0x2A2B3B05), SK_U64C(0x8CB89A7D, 0xB77C506A) }, /* 5^-44 */
+    { SK_U64C(0x8EB98A7A, 0x9A5B04E3), SK_U64C(0x77F3608E, 0x92ADB242) }, /* 5^-43 */
+    { SK_U64C(0xB267ED19, 0x40F1C61C), SK_U64C(0x55F038B2, 0x37591ED3) }, /* 5^-42 */
+    { SK_U64C(0xDF01E85F, 0x912E37A3), SK_U64C(0x6B6C46DE, 0xC52F6688) }, /* 5^-41 */
+    { SK_U64C(0x8B61313B, 0xBABCE2C6), SK_U64C(0x2323AC4B, 0x3B3DA015) }, /* 5^-40 */
+    { SK_U64C(0xAE397D8A, 0xA96C1B77), SK_U64C(0xABEC975E, 0x0A0D081A) }, /* 5^-39 */
+    { SK_U64C(0xD9C7DCED, 0x53C72255), SK_U64C(0x96E7BD35, 0x8C904A21) }, /* 5^-38 */
+    { SK_U64C(0x881CEA14, 0x545C7575), SK_U64C(0x7E50D641, 0x77DA2E54) }, /* 5^-37 */
+    { SK_U64C(0xAA242499, 0x697392D2), SK_U64C(0xDDE50BD1, 0xD5D0B9E9) }, /* 5^-36 */
+    { SK_U64C(0xD4AD2DBF, 0xC3D07787), SK_U64C(0x955E4EC6, 0x4B44E864) }, /* 5^-35 */
+    { SK_U64C(0x84EC3C97, 0xDA624AB4), SK_U64C(0xBD5AF13B, 0xEF0B113E) }, /* 5^-34 */
+    { SK_U64C(0xA6274BBD, 0xD0FADD61), SK_U64C(0xECB1AD8A, 0xEACDD58E) }, /* 5^-33 */
+    { SK_U64C(0xCFB11EAD, 0x453994BA), SK_U64C(0x67DE18ED, 0xA5814AF2) }, /* 5^-32 */
+    { SK_U64C(0x81CEB32C, 0x4B43FCF4), SK_U64C(0x80EACF94, 0x8770CED7) }, /* 5^-31 */
+    { SK_U64C(0xA2425FF7, 0x5E14FC31), SK_U64C(0xA1258379, 0xA94D028D) }, /* 5^-30 */
+    { SK_U64C(0xCAD2F7F5, 0x359A3B3E), SK_U64C(0x096EE458, 0x13A04330) }, /* 5^-29 */
+    { SK_U64C(0xFD87B5F2, 0x8300CA0D), SK_U64C(0x8BCA9D6E, 0x188853FC) }, /* 5^-28 */
+    { SK_U64C(0x9E74D1B7, 0x91E07E48), SK_U64C(0x775EA264, 0xCF55347E) }, /* 5^-27 */
+    { SK_U64C(0xC6120625, 0x76589DDA), SK_U64C(0x95364AFE, 0x032A819E) }, /* 5^-26 */
+    { SK_U64C(0xF79687AE, 0xD3EEC551), SK_U64C(0x3A83DDBD, 0x83F52205) }, /* 5^-25 */
+    { SK_U64C(0x9ABE14CD, 0x44753B52), SK_U64C(0xC4926A96, 0x72793543) }, /* 5^-24 */
+    { SK_U64C(0xC16D9A00, 0x95928A27), SK_U64C(0x75B7053C, 0x0F178294) }, /* 5^-23 */
+    { SK_U64C(0xF1C90080, 0xBAF72CB1), SK_U64C(0x5324C68B, 0x12DD6339) }, /* 5^-22 */
+    { SK_U64C(0x971DA050, 0x74DA7BEE), SK_U64C(0xD3F6FC16, 0xEBCA5E04) }, /* 5^-21 */
+    { SK_U64C(0xBCE50864, 0x92111AEA), SK_U64C(0x88F4BB1C, 0xA6BCF585) }, /* 5^-20 */
+    { SK_U64C(0xEC1E4A7D, 0xB69561A5), SK_U64C(0x2B31E9E3, 0xD06C32E6) }, /* 5^-19 */
+    { SK_U64C(0x9392EE8E, 0x921D5D07), SK_U64C(0x3AFF322E, 0x62439FD0) }, /* 5^-18 */
+    { SK_U64C(0xB877AA32, 0x36A4B449), SK_U64C(0x09BEFEB9, 0xFAD487C3) }, /* 5^-17 */
+    { SK_U64C(0xE69594BE, 0xC44DE15B), SK_U64C(0x4C2EBE68, 0x7989A9B4) }, /* 5^-16 */
+    { SK_U64C(0x901D7CF7, 0x3AB0ACD9), SK_U64C(0x0F9D3701, 0x4BF60A11) }, /* 5^-15 */
+    { SK_U64C(0xB424DC35, 0x095CD80F), SK_U64C(0x538484C1, 0x9EF38C95) }, /* 5^-14 */
+    { SK_U64C(0xE12E1342, 0x4BB40E13), SK_U64C(0x2865A5F2, 0x06B06FBA) }, /* 5^-13 */
+    { SK_U64C(0x8CBCCC09, 0x6F5088CB), SK_U64C(0xF93F87B7, 0x442E45D4) }, /* 5^-12 */
+    { SK_U64C(0xAFEBFF0B, 0xCB24AAFE), SK_U64C(0xF78F69A5, 0x1539D749) }, /* 5^-11 */
+    { SK_U64C(0xDBE6FECE, 0xBDEDD5BE), SK_U64C(0xB573440E, 0x5A884D1C) }, /* 5^-10 */
+    { SK_U64C(0x89705F41, 0x36B4A597), SK_U64C(0x31680A88, 0xF8953031) }, /* 5^-9 */
+    { SK_U64C(0xABCC7711, 0x8461CEFC), SK_U64C(0xFDC20D2B, 0x36BA7C3E) }, /* 5^-8 */
+    { SK_U64C(0xD6BF94D5, 0xE57A42BC), SK_U64C(0x3D329076, 0x04691B4D) }, /* 5^-7 */
+    { SK_U64C(0x8637BD05, 0xAF6C69B5), SK_U64C(0xA63F9A49, 0xC2C1B110) }, /* 5^-6 */
+    { SK_U64C(0xA7C5AC47, 0x1B478423), SK_U64C(0x0FCF80DC, 0x33721D54) }, /* 5^-5 */
+    { SK_U64C(0xD1B71758, 0xE219652B), SK_U64C(0xD3C36113, 0x404EA4A9) }, /* 5^-4 */
+    { SK_U64C(0x83126E97, 0x8D4FDF3B), SK_U64C(0x645A1CAC, 0x083126EA) }, /* 5^-3 */
+    { SK_U64C(0xA3D70A3D, 0x70A3D70A), SK_U64C(0x3D70A3D7, 0x0A3D70A4) }, /* 5^-2 */
+    { SK_U64C(0xCCCCCCCC, 0xCCCCCCCC), SK_U64C(0xCCCCCCCC, 0xCCCCCCCD) }, /* 5^-1 */
+    { SK_U64C(0x80000000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^0 */
+    { SK_U64C(0xA0000000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^1 */
+    { SK_U64C(0xC8000000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^2 */
+    { SK_U64C(0xFA000000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^3 */
+    { SK_U64C(0x9C400000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^4 */
+    { SK_U64C(0xC3500000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^5 */
+    { SK_U64C(0xF4240000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^6 */
+    { SK_U64C(0x98968000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^7 */
+    { SK_U64C(0xBEBC2000, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^8 */
+    { SK_U64C(0xEE6B2800, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^9 */
+    { SK_U64C(0x9502F900, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^10 */
+    { SK_U64C(0xBA43B740, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^11 */
+    { SK_U64C(0xE8D4A510, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^12 */
+    { SK_U64C(0x9184E72A, 0x00000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^13 */
+    { SK_U64C(0xB5E620F4, 0x80000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^14 */
+    { SK_U64C(0xE35FA931, 0xA0000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^15 */
+    { SK_U64C(0x8E1BC9BF, 0x04000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^16 */
+    { SK_U64C(0xB1A2BC2E, 0xC5000000), SK_U64C(0x00000000, 0x00000000) }, /* 5^17 */
+    { SK_U64C(0xDE0B6B3A, 0x76400000), SK_U64C(0x00000000, 0x00000000) }, /* 5^18 */
+    { SK_U64C(0x8AC72304, 0x89E80000), SK_U64C(0x00000000, 0x00000000) }, /* 5^19 */
+    { SK_U64C(0xAD78EBC5, 0xAC620000), SK_U64C(0x00000000, 0x00000000) }, /* 5^20 */
+    { SK_U64C(0xD8D726B7, 0x177A8000), SK_U64C(0x00000000, 0x00000000) }, /* 5^21 */
+    { SK_U64C(0x87867832, 0x6EAC9000), SK_U64C(0x00000000, 0x00000000) }, /* 5^22 */
+    { SK_U64C(0xA968163F, 0x0A57B400), SK_U64C(0x00000000, 0x00000000) }, /* 5^23 */
+    { SK_U64C(0xD3C21BCE, 0xCCEDA100), SK_U64C(0x00000000, 0x00000000) }, /* 5^24 */
+    { SK_U64C(0x84595161, 0x401484A0), SK_U64C(0x00000000, 0x00000000) }, /* 5^25 */
+    { SK_U64C(0xA56FA5B9, 0x9019A5C8), SK_U64C(0x00000000, 0x00000000) }, /* 5^26 */
+    { SK_U64C(0xCECB8F27, 0xF4200F3A), SK_U64C(0x00000000, 0x00000000) }, /* 5^27 */
+    { SK_U64C(0x813F3978, 0xF8940984), SK_U64C(0x40000000, 0x00000000) }, /* 5^28 */
+    { SK_U64C(0xA18F07D7, 0x36B90BE5), SK_U64C(0x50000000, 0x00000000) }, /* 5^29 */
+    { SK_U64C(0xC9F2C9CD, 0x04674EDE), SK_U64C(0xA4000000, 0x00000000) }, /* 5^30 */
+    { SK_U64C(0xFC6F7C40, 0x45812296), SK_U64C(0x4D000000, 0x00000000) }, /* 5^31 */
+    { SK_U64C(0x9DC5ADA8, 0x2B70B59D), SK_U64C(0xF0200000, 0x00000000) }, /* 5^32 */
+    { SK_U64C(0xC5371912, 0x364CE305), SK_U64C(0x6C280000, 0x00000000) }, /* 5^33 */
+    { SK_U64C(0xF684DF56, 0xC3E01BC6), SK_U64C(0xC7320000, 0x00000000) }, /* 5^34 */
+    { SK_U64C(0x9A130B96, 0x3A6C115C), SK_U64C(0x3C7F4000, 0x00000000) }, /* 5^35 */
+    { SK_U64C(0xC097CE7B, 0xC90715B3), SK_U64C(0x4B9F1000, 0x00000000) }, /* 5^36 */
+    { SK_U64C(0xF0BDC21A, 0xBB48DB20), SK_U64C(0x1E86D400, 0x00000000) }, /* 5^37 */
+    { SK_U64C(0x96769950, 0xB50D88F4), SK_U64C(0x13144480, 0x00000000) }, /* 5^38 */
+    { SK_U64C(0xBC143FA4, 0xE250EB31), SK_U64C(0x17D955A0, 0x00000000) }, /* 5^39 */
+    { SK_U64C(0xEB194F8E, 0x1AE525FD), SK_U64C(0x5DCFAB08, 0x00000000) }, /* 5^40 */
+    { SK_U64C(0x92EFD1B8, 0xD0CF37BE), SK_U64C(0x5AA1CAE5, 0x00000000) }, /* 5^41 */
+    { SK_U64C(0xB7ABC627, 0x050305AD), SK_U64C(0xF14A3D9E, 0x40000000) }, /* 5^42 */
+    { SK_U64C(0xE596B7B0, 0xC643C719), SK_U64C(0x6D9CCD05, 0xD0000000) }, /* 5^43 */
+    { SK_U64C(0x8F7E32CE, 0x7BEA5C6F), SK_U64C(0xE4820023, 0xA2000000) }, /* 5^44 */
+    { SK_U64C(0xB35DBF82, 0x1AE4F38B), SK_U64C(0xDDA2802C, 0x8A800000) }, /* 5^45 */
+    { SK_U64C(0xE0352F62, 0xA19E306E), SK_U64C(0xD50B2037, 0xAD200000) }, /* 5^46 */
+    { SK_U64C(0x8C213D9D, 0xA502DE45), SK_U64C(0x4526F422, 0xCC340000) }, /* 5^47 */
+    { SK_U64C(0xAF298D05, 0x0E4395D6), SK_U64C(0x9670B12B, 0x7F410000) }, /* 5^48 */
+    { SK_U64C(0xDAF3F046, 0x51D47B4C), SK_U64C(0x3C0CDD76, 0x5F114000) }, /* 5^49 */
+    { SK_U64C(0x88D8762B, 0xF324CD0F), SK_U64C(0xA5880A69, 0xFB6AC800) }, /* 5^50 */
+    { SK_U64C(0xAB0E93B6, 0xEFEE0053), SK_U64C(0x8EEA0D04, 0x7A457A00) }, /* 5^51 */
+    { SK_U64C(0xD5D238A4, 0xABE98068), SK_U64C(0x72A49045, 0x98D6D880) }, /* 5^52 */
+    { SK_U64C(0x85A36366, 0xEB71F041), SK_U64C(0x47A6DA2B, 0x7F864750) }, /* 5^53 */
+    { SK_U64C(0xA70C3C40, 0xA64E6C51), SK_U64C(0x999090B6, 0x5F67D924) }, /* 5^54 */
+    { SK_U64C(0xD0CF4B50, 0xCFE20765), SK_U64C(0xFFF4B4E3, 0xF741CF6D) }, /* 5^55 */
+    { SK_U64C(0x82818F12, 0x81ED449F), SK_U64C(0xBFF8F10E, 0x7A8921A4) }, /* 5^56 */
+    { SK_U64C(0xA321F2D7, 0x226895C7), SK_U64C(0xAFF72D52, 0x192B6A0D) }, /* 5^57 */
+    { SK_U64C(0xCBEA6F8C, 0xEB02BB39), SK_U64C(0x9BF4F8A6, 0x9F764490) }, /* 5^58 */
+    { SK_U64C(0xFEE50B70, 0x25C36A08), SK_U64C(0x02F236D0, 0x4753D5B4) }, /* 5^59 */
+    { SK_U64C(0x9F4F2726, 0x179A2245), SK_U64C(0x01D76242, 0x2C946590) }, /* 5^60 */
+    { SK_U64C(0xC722F0EF, 0x9D80AAD6), SK_U64C(0x424D3AD2, 0xB7B97EF5) }, /* 5^61 */
+    { SK_U64C(0xF8EBAD2B, 0x84E0D58B), SK_U64C(0xD2E08987, 0x65A7DEB2) }, /* 5^62 */
+    { SK_U64C(0x9B934C3B, 0x330C8577), SK_U64C(0x63CC55F4, 0x9F88EB2F) }, /* 5^63 */
+    { SK_U64C(0xC2781F49, 0xFFCFA6D5), SK_U64C(0x3CBF6B71, 0xC76B25FB) }, /* 5^64 */
+    { SK_U64C(0xF316271C, 0x7FC3908A), SK_U64C(0x8BEF464E, 0x3945EF7A) }, /* 5^65 */
+    { SK_U64C(0x97EDD871, 0xCFDA3A56), SK_U64C(0x97758BF0, 0xE3CBB5AC) }, /* 5^66 */
+    { SK_U64C(0xBDE94E8E, 0x43D0C8EC), SK_U64C(0x3D52EEED, 0x1CBEA317) }, /* 5^67 */
+    { SK_U64C(0xED63A231, 0xD4C4FB27), SK_U64C(0x4CA7AAA8, 0x63EE4BDD) }, /* 5^68 */
+    { SK_U64C(0x945E455F, 0x24FB1CF8), SK_U64C(0x8FE8CAA9, 0x3E74EF6A) }, /* 5^69 */
+    { SK_U64C(0xB975D6B6, 0xEE39E436), SK_U64C(0xB3E2FD53, 0x8E122B44) }, /* 5^70 */
+    { SK_U64C(0xE7D34C64, 0xA9C85D44), SK_U64C(0x60DBBCA8, 0x7196B616) }, /* 5^71 */
+    { SK_U64C(0x90E40FBE, 0xEA1D3A4A), SK_U64C(0xBC8955E9, 0x46FE31CD) }, /* 5^72 */
+    { SK_U64C(0xB51D13AE, 0xA4A488DD), SK_U64C(0x6BABAB63, 0x98BDBE41) }, /* 5^73 */
+    { SK_U64C(0xE264589A, 0x4DCDAB14), SK_U64C(0xC696963C, 0x7EED2DD1) }, /* 5^74 */
+    { SK_U64C(0x8D7EB760, 0x70A08AEC), SK_U64C(0xFC1E1DE5, 0xCF543CA2) }, /* 5^75 */
+    { SK_U64C(0xB0DE6538, 0x8CC8ADA8), SK_U64C(0x3B25A55F, 0x43294BCB) }, /* 5^76 */
+    { SK_U64C(0xDD15FE86, 0xAFFAD912), SK_U64C(0x49EF0EB7, 0x13F39EBE) }, /* 5^77 */
+    { SK_U64C(0x8A2DBF14, 0x2DFCC7AB), SK_U64C(0x6E356932, 0x6C784337) }, /* 5^78 */
+    { SK_U64C(0xACB92ED9, 0x397BF996), SK_U64C(0x49C2C37F, 0x07965404) }, /* 5^79 */
+    { SK_U64C(0xD7E77A8F, 0x87DAF7FB), SK_U64C(0xDC33745E, 0xC97BE906) }, /* 5^80 */
+    { SK_U64C(0x86F0AC99, 0xB4E8DAFD), SK_U64C(0x69A028BB, 0x3DED71A3) }, /* 5^81 */
+    { SK_U64C(0xA8ACD7C0, 0x222311BC), SK_U64C(0xC40832EA, 0x0D68CE0C) }, /* 5^82 */
+    { SK_U64C(0xD2D80DB0, 0x2AABD62B), SK_U64C(0xF50A3FA4, 0x90C30190) }, /* 5^83 */
+    { SK_U64C(0x83C7088E, 0x1AAB65DB), SK_U64C(0x792667C6, 0xDA79E0FA) }, /* 5^84 */
+    { SK_U64C(0xA4B8CAB1, 0xA1563F52), SK_U64C(0x577001B8, 0x91185938) }, /* 5^85 */
+    { SK_U64C(0xCDE6FD5E, 0x09ABCF26), SK_U64C(0xED4C0226, 0xB55E6F86) }, /* 5^86 */
+    { SK_U64C(0x80B05E5A, 0xC60B6178), SK_U64C(0x544F8158, 0x315B05B4) }, /* 5^87 */
+    { SK_U64C(0xA0DC75F1, 0x778E39D6), SK_U64C(0x696361AE, 0x3DB1C721) }, /* 5^88 */
+    { SK_U64C(0xC913936D, 0xD571C84C), SK_U64C(0x03BC3A19, 0xCD1E38E9) }, /* 5^89 */
+    { SK_U64C(0xFB587849, 0x4ACE3A5F), SK_U64C(0x04AB48A0, 0x4065C723) }, /* 5^90 */
+    { SK_U64C(0x9D174B2D, 0xCEC0E47B), SK_U64C(0x62EB0D64, 0x283F9C76) }, /* 5^91 */
+    { SK_U64C(0xC45D1DF9, 0x42711D9A), SK_U64C(0x3BA5D0BD, 0x324F8394) }, /* 5^92 */
+    { SK_U64C(0xF5746577, 0x930D6500), SK_U64C(0xCA8F44EC, 0x7EE36479) }, /* 5^93 */
+    { SK_U64C(0x9968BF6A, 0xBBE85F20), SK_U64C(0x7E998B13, 0xCF4E1ECB) }, /* 5^94 */
+    { SK_U64C(0xBFC2EF45, 0x6AE276E8), SK_U64C(0x9E3FEDD8, 0xC321A67E) }, /* 5^95 */
+    { SK_U64C(0xEFB3AB16, 0xC59B14A2), SK_U64C(0xC5CFE94E, 0xF3EA101E) }, /* 5^96 */
+    { SK_U64C(0x95D04AEE, 0x3B80ECE5), SK_U64C(0xBBA1F1D1, 0x58724A12) }, /* 5^97 */
+    { SK_U64C(0xBB445DA9, 0xCA61281F), SK_U64C(0x2A8A6E45, 0xAE8EDC97) }, /* 5^98 */
+    { SK_U64C(0xEA157514, 0x3CF97226), SK_U64C(0xF52D09D7, 0x1A3293BD) }, /* 5^99 */
+    { SK_U64C(0x924D692C, 0xA61BE758), SK_U64C(0x593C2626, 0x705F9C56) }, /* 5^100 */
+    { SK_U64C(0xB6E0C377, 0xCFA2E12E), SK_U64C(0x6F8B2FB0, 0x0C77836C) }, /* 5^101 */
+    { SK_U64C(0xE498F455, 0xC38B997A), SK_U64C(0x0B6DFB9C, 0x0F956447) }, /* 5^102 */
+    { SK_U64C(0x8EDF98B5, 0x9A373FEC), SK_U64C(0x4724BD41, 0x89BD5EAC) }, /* 5^103 */
+    { SK_U64C(0xB2977EE3, 0x00C50FE7), SK_U64C(0x58EDEC91, 0xEC2CB657) }, /* 5^104 */
+    { SK_U64C(0xDF3D5E9B, 0xC0F653E1), SK_U64C(0x2F2967B6, 0x6737E3ED) }, /* 5^105 */
+    { SK_U64C(0x8B865B21, 0x5899F46C), SK_U64C(0xBD79E0D2, 0x0082EE74) }, /* 5^106 */
+    { SK_U64C(0xAE67F1E9, 0xAEC07187), SK_U64C(0xECD85906, 0x80A3AA11) }, /* 5^107 */
+    { SK_U64C(0xDA01EE64, 0x1A708DE9), SK_U64C(0xE80E6F48, 0x20CC9495) }, /* 5^108 */
+    { SK_U64C(0x884134FE, 0x908658B2), SK_U64C(0x3109058D, 0x147FDCDD) }, /* 5^109 */
+    { SK_U64C(0xAA51823E, 0x34A7EEDE), SK_U64C(0xBD4B46F0, 0x599FD415) }, /* 5^110 */
+    { SK_U64C(0xD4E5E2CD, 0xC1D1EA96), SK_U64C(0x6C9E18AC, 0x7007C91A) }, /* 5^111 */
+    { SK_U64C(0x850FADC0, 0x9923329E), SK_U64C(0x03E2CF6B, 0xC604DDB0) }, /* 5^112 */
+    { SK_U64C(0xA6539930, 0xBF6BFF45), SK_U64C(0x84DB8346, 0xB786151C) }, /* 5^113 */
+    { SK_U64C(0xCFE87F7C, 0xEF46FF16), SK_U64C(0xE6126418, 0x65679A63) }, /* 5^114 */
+    { SK_U64C(0x81F14FAE, 0x158C5F6E), SK_U64C(0x4FCB7E8F, 0x3F60C07E) }, /* 5^115 */
+    { SK_U64C(0xA26DA399, 0x9AEF7749), SK_U64C(0xE3BE5E33, 0x0F38F09D) }, /* 5^116 */
+    { SK_U64C(0xCB090C80, 0x01AB551C), SK_U64C(0x5CADF5BF, 0xD3072CC5) }, /* 5^117 */
+    { SK_U64C(0xFDCB4FA0, 0x02162A63), SK_U64C(0x73D9732F, 0xC7C8F7F6) }, /* 5^118 */
+    { SK_U64C(0x9E9F11C4, 0x014DDA7E), SK_U64C(0x2867E7FD, 0xDCDD9AFA) }, /* 5^119 */
+    { SK_U64C(0xC646D635, 0x01A1511D), SK_U64C(0xB281E1FD, 0x541501B8) }, /* 5^120 */
+    { SK_U64C(0xF7D88BC2, 0x4209A565), SK_U64C(0x1F225A7C, 0xA91A4226) }, /* 5^121 */
+    { SK_U64C(0x9AE75759, 0x6946075F), SK_U64C(0x3375788D, 0xE9B06958) }, /* 5^122 */
+    { SK_U64C(0xC1A12D2F, 0xC3978937), SK_U64C(0x0052D6B1, 0x641C83AE) }, /* 5^123 */
+    { SK_U64C(0xF209787B, 0xB47D6B84), SK_U64C(0xC0678C5D, 0xBD23A49A) }, /* 5^124 */
+    { SK_U64C(0x9745EB4D, 0x50CE6332), SK_U64C(0xF840B7BA, 0x963646E0) }, /* 5^125 */
+    { SK_U64C(0xBD176620, 0xA501FBFF), SK_U64C(0xB650E5A9, 0x3BC3D898) }, /* 5^126 */
+    { SK_U64C(0xEC5D3FA8, 0xCE427AFF), SK_U64C(0xA3E51F13, 0x8AB4CEBE) }, /* 5^127 */
+    { SK_U64C(0x93BA47C9, 0x80E98CDF), SK_U64C(0xC66F336C, 0x36B10137) }, /* 5^128 */
+    { SK_U64C(0xB8A8D9BB, 0xE123F017), SK_U64C(0xB80B0047, 0x445D4184) }, /* 5^129 */
+    { SK_U64C(0xE6D3102A, 0xD96CEC1D), SK_U64C(0xA60DC059, 0x157491E5) }, /* 5^130 */
+    { SK_U64C(0x9043EA1A, 0xC7E41392), SK_U64C(0x87C89837, 0xAD68DB2F) }, /* 5^131 */
+    { SK_U64C(0xB454E4A1, 0x79DD1877), SK_U64C(0x29BABE45, 0x98C311FB) }, /* 5^132 */
+    { SK_U64C(0xE16A1DC9, 0xD8545E94), SK_U64C(0xF4296DD6, 0xFEF3D67A) }, /* 5^133 */
+    { SK_U64C(0x8CE2529E, 0x2734BB1D), SK_U64C(0x1899E4A6, 0x5F58660C) }, /* 5^134 */
+    { SK_U64C(0xB01AE745, 0xB101E9E4), SK_U64C(0x5EC05DCF, 0xF72E7F8F) }, /* 5^135 */
+    { SK_U64C(0xDC21A117, 0x1D42645D), SK_U64C(0x76707543, 0xF4FA1F73) }, /* 5^136 */
+    { SK_U64C(0x899504AE, 0x72497EBA), SK_U64C(0x6A06494A, 0x791C53A8) }, /* 5^137 */
+    { SK_U64C(0xABFA45DA, 0x0EDBDE69), SK_U64C(0x0487DB9D, 0x17636892) }, /* 5^138 */
+    { SK_U64C(0xD6F8D750, 0x9292D603), SK_U64C(0x45A9D284, 0x5D3C42B6) }, /* 5^139 */
+    { SK_U64C(0x865B8692, 0x5B9BC5C2), SK_U64C(0x0B8A2392, 0xBA45A9B2) }, /* 5^140 */
+    { SK_U64C(0xA7F26836, 0xF282B732), SK_U64C(0x8E6CAC77, 0x68D7141E) }, /* 5^141 */
+    { SK_U64C(0xD1EF0244, 0xAF2364FF), SK_U64C(0x3207D795, 0x430CD926) }, /* 5^142 */
+    { SK_U64C(0x8335616A, 0xED761F1F), SK_U64C(0x7F44E6BD, 0x49E807B8) }, /* 5^143 */
+    { SK_U64C(0xA402B9C5, 0xA8D3A6E7), SK_U64C(0x5F16206C, 0x9C6209A6) }, /* 5^144 */
+    { SK_U64C(0xCD036837, 0x130890A1), SK_U64C(0x36DBA887, 0xC37A8C0F) }, /* 5^145 */
+    { SK_U64C(0x80222122, 0x6BE55A64), SK_U64C(0xC2494954, 0xDA2C9789) }, /* 5^146 */
+    { SK_U64C(0xA02AA96B, 0x06DEB0FD), SK_U64C(0xF2DB9BAA, 0x10B7BD6C) }, /* 5^147 */
+    { SK_U64C(0xC83553C5, 0xC8965D3D), SK_U64C(0x6F928294, 0x94E5ACC7) }, /* 5^148 */
+    { SK_U64C(0xFA42A8B7, 0x3ABBF48C), SK_U64C(0xCB772339, 0xBA1F17F9) }, /* 5^149 */
+    { SK_U64C(0x9C69A972, 0x84B578D7), SK_U64C(0xFF2A7604, 0x14536EFB) }, /* 5^150 */
+    { SK_U64C(0xC38413CF, 0x25E2D70D), SK_U64C(0xFEF51385, 0x19684ABA) }, /* 5^151 */
+    { SK_U64C(0xF46518C2, 0xEF5B8CD1), SK_U64C(0x7EB25866, 0x5FC25D69) }, /* 5^152 */
+    { SK_U64C(0x98BF2F79, 0xD5993802), SK_U64C(0xEF2F773F, 0xFBD97A61) }, /* 5^153 */
+    { SK_U64C(0xBEEEFB58, 0x4AFF8603), SK_U64C(0xAAFB550F, 0xFACFD8FA) }, /* 5^154 */
+    { SK_U64C(0xEEAABA2E, 0x5DBF6784), SK_U64C(0x95BA2A53, 0xF983CF38) }, /* 5^155 */
+    { SK_U64C(0x952AB45C, 0xFA97A0B2), SK_U64C(0xDD945A74, 0x7BF26183) }, /* 5^156 */
+    { SK_U64C(0xBA756174, 0x393D88DF), SK_U64C(0x94F97111, 0x9AEEF9E4) }, /* 5^157 */
+    { SK_U64C(0xE912B9D1, 0x478CEB17), SK_U64C(0x7A37CD56, 0x01AAB85D) }, /* 5^158 */
+    { SK_U64C(0x91ABB422, 0xCCB812EE), SK_U64C(0xAC62E055, 0xC10AB33A) }, /* 5^159 */
+    { SK_U64C(0xB616A12B, 0x7FE617AA), SK_U64C(0x577B986B, 0x314D6009) }, /* 5^160 */
+    { SK_U64C(0xE39C4976, 0x5FDF9D94), SK_U64C(0xED5A7E85, 0xFDA0B80B) }, /* 5^161 */
+    { SK_U64C(0x8E41ADE9, 0xFBEBC27D), SK_U64C(0x14588F13, 0xBE847307) }, /* 5^162 */
+    { SK_U64C(0xB1D21964, 0x7AE6B31C), SK_U64C(0x596EB2D8, 0xAE258FC8) }, /* 5^163 */
+    { SK_U64C(0xDE469FBD, 0x99A05FE3), SK_U64C(0x6FCA5F8E, 0xD9AEF3BB) }, /* 5^164 */
+    { SK_U64C(0x8AEC23D6, 0x80043BEE), SK_U64C(0x25DE7BB9, 0x480D5854) }, /* 5^165 */
+    { SK_U64C(0xADA72CCC, 0x20054AE9), SK_U64C(0xAF561AA7, 0x9A10AE6A) }, /* 5^166 */
+    { SK_U64C(0xD910F7FF, 0x28069DA4), SK_U64C(0x1B2BA151, 0x8094DA04) }, /* 5^167 */
+    { SK_U64C(0x87AA9AFF, 0x79042286), SK_U64C(0x90FB44D2, 0xF05D0842) }, /* 5^168 */
+    { SK_U64C(0xA99541BF, 0x57452B28), SK_U64C(0x353A1607, 0xAC744A53) }, /* 5^169 */
+    { SK_U64C(0xD3FA922F, 0x2D1675F2), SK_U64C(0x42889B89, 0x97915CE8) }, /* 5^170 */
+    { SK_U64C(0x847C9B5D, 0x7C2E09B7), SK_U64C(0x69956135, 0xFEBADA11) }, /* 5^171 */
+    { SK_U64C(0xA59BC234, 0xDB398C25), SK_U64C(0x43FAB983, 0x7E699095) }, /* 5^172 */
+    { SK_U64C(0xCF02B2C2, 0x1207EF2E), SK_U64C(0x94F967E4, 0x5E03F4BB) }, /* 5^173 */
+    { SK_U64C(0x8161AFB9, 0x4B44F57D), SK_U64C(0x1D1BE0EE, 0xBAC278F5) }, /* 5^174 */
+    { SK_U64C(0xA1BA1BA7, 0x9E1632DC), SK_U64C(0x6462D92A, 0x69731732) }, /* 5^175 */
+    { SK_U64C(0xCA28A291, 0x859BBF93), SK_U64C(0x7D7B8F75, 0x03CFDCFE) }, /* 5^176 */
+    { SK_U64C(0xFCB2CB35, 0xE702AF78), SK_U64C(0x5CDA7352, 0x44C3D43E) }, /* 5^177 */
+    { SK_U64C(0x9DEFBF01, 0xB061ADAB), SK_U64C(0x3A088813, 0x6AFA64A7) }, /* 5^178 */
+    { SK_U64C(0xC56BAEC2, 0x1C7A1916), SK_U64C(0x088AAA18, 0x45B8FDD0) }, /* 5^179 */
+    { SK_U64C(0xF6C69A72, 0xA3989F5B), SK_U64C(0x8AAD549E, 0x57273D45) }, /* 5^180 */
+    { SK_U64C(0x9A3C2087, 0xA63F6399), SK_U64C(0x36AC54E2, 0xF678864B) }, /* 5^181 */
+    { SK_U64C(0xC0CB28A9, 0x8FCF3C7F), SK_U64C(0x84576A1B, 0xB416A7DD) }, /* 5^182 */
+    { SK_U64C(0xF0FDF2D3, 0xF3C30B9F), SK_U64C(0x656D44A2, 0xA11C51D5) }, /* 5^183 */
+    { SK_U64C(0x969EB7C4, 0x7859E743), SK_U64C(0x9F644AE5, 0xA4B1B325) }, /* 5^184 */
+    { SK_U64C(0xBC4665B5, 0x96706114), SK_U64C(0x873D5D9F, 0x0DDE1FEE) }, /* 5^185 */
+    { SK_U64C(0xEB57FF22, 0xFC0C7959), SK_U64C(0xA90CB506, 0xD155A7EA) }, /* 5^186 */
+    { SK_U64C(0x9316FF75, 0xDD87CBD8), SK_U64C(0x09A7F124, 0x42D588F2) }, /* 5^187 */
+    { SK_U64C(0xB7DCBF53, 0x54E9BECE), SK_U64C(0x0C11ED6D, 0x538AEB2F) }, /* 5^188 */
+    { SK_U64C(0xE5D3EF28, 0x2A242E81), SK_U64C(0x8F1668C8, 0xA86DA5FA) }, /* 5^189 */
+    { SK_U64C(0x8FA47579, 0x1A569D10), SK_U64C(0xF96E017D, 0x694487BC) }, /* 5^190 */
+    { SK_U64C(0xB38D92D7, 0x60EC4455), SK_U64C(0x37C981DC, 0xC395A9AC) }, /* 5^191 */
+    { SK_U64C(0xE070F78D, 0x3927556A), SK_U64C(0x85BBE253, 0xF47B1417) }, /* 5^192 */
+    { SK_U64C(0x8C469AB8, 0x43B89562), SK_U64C(0x93956D74, 0x78CCEC8E) }, /* 5^193 */
+    { SK_U64C(0xAF584166, 0x54A6BABB), SK_U64C(0x387AC8D1, 0x970027B2) }, /* 5^194 */
+    { SK_U64C(0xDB2E51BF, 0xE9D0696A), SK_U64C(0x06997B05, 0xFCC0319E) }, /* 5^195 */
+    { SK_U64C(0x88FCF317, 0xF22241E2), SK_U64C(0x441FECE3, 0xBDF81F03) }, /* 5^196 */
+    { SK_U64C(0xAB3C2FDD, 0xEEAAD25A), SK_U64C(0xD527E81C, 0xAD7626C3) }, /* 5^197 */
+    { SK_U64C(0xD60B3BD5, 0x6A5586F1), SK_U64C(0x8A71E223, 0xD8D3B074) }, /* 5^198 */
+    { SK_U64C(0x85C70565, 0x62757456), SK_U64C(0xF6872D56, 0x67844E49) }, /* 5^199 */
+    { SK_U64C(0xA738C6BE, 0xBB12D16C), SK_U64C(0xB428F8AC, 0x016561DB) }, /* 5^200 */
+    { SK_U64C(0xD106F86E, 0x69D785C7), SK_U64C(0xE13336D7, 0x01BEBA52) }, /* 5^201 */
+    { SK_U64C(0x82A45B45, 0x0226B39C), SK_U64C(0xECC00246, 0x61173473) }, /* 5^202 */
+    { SK_U64C(0xA34D7216, 0x42B06084), SK_U64C(0x27F002D7, 0xF95D0190) }, /* 5^203 */
+    { SK_U64C(0xCC20CE9B, 0xD35C78A5), SK_U64C(0x31EC038D, 0xF7B441F4) }, /* 5^204 */
+    { SK_U64C(0xFF290242, 0xC83396CE), SK_U64C(0x7E670471, 0x75A15271) }, /* 5^205 */
+    { SK_U64C(0x9F79A169, 0xBD203E41), SK_U64C(0x0F0062C6, 0xE984D386) }, /* 5^206 */
+    { SK_U64C(0xC75809C4, 0x2C684DD1), SK_U64C(0x52C07B78, 0xA3E60868) }, /* 5^207 */
+    { SK_U64C(0xF92E0C35, 0x37826145), SK_U64C(0xA7709A56, 0xCCDF8A82) }, /* 5^208 */
+    { SK_U64C(0x9BBCC7A1, 0x42B17CCB), SK_U64C(0x88A66076, 0x400BB691) }, /* 5^209 */
+    { SK_U64C(0xC2ABF989, 0x935DDBFE), SK_U64C(0x6ACFF893, 0xD00EA435) }, /* 5^210 */
+    { SK_U64C(0xF356F7EB, 0xF83552FE), SK_U64C(0x0583F6B8, 0xC4124D43) }, /* 5^211 */
+    { SK_U64C(0x98165AF3, 0x7B2153DE), SK_U64C(0xC3727A33, 0x7A8B704A) }, /* 5^212 */
+    { SK_U64C(0xBE1BF1B0, 0x59E9A8D6), SK_U64C(0x744F18C0, 0x592E4C5C) }, /* 5^213 */
+    { SK_U64C(0xEDA2EE1C, 0x7064130C), SK_U64C(0x1162DEF0, 0x6F79DF73) }, /* 5^214 */
+    { SK_U64C(0x9485D4D1, 0xC63E8BE7), SK_U64C(0x8ADDCB56, 0x45AC2BA8) }, /* 5^215 */
+    { SK_U64C(0xB9A74A06, 0x37CE2EE1), SK_U64C(0x6D953E2B, 0xD7173692) }, /* 5^216 */
+    { SK_U64C(0xE8111C87, 0xC5C1BA99), SK_U64C(0xC8FA8DB6, 0xCCDD0437) }, /* 5^217 */
+    { SK_U64C(0x910AB1D4, 0xDB9914A0), SK_U64C(0x1D9C9892, 0x400A22A2) }, /* 5^218 */
+    { SK_U64C(0xB54D5E4A, 0x127F59C8), SK_U64C(0x2503BEB6, 0xD00CAB4B) }, /* 5^219 */
+    { SK_U64C(0xE2A0B5DC, 0x971F303A), SK_U64C(0x2E44AE64, 0x840FD61D) }, /* 5^220 */
+    { SK_U64C(0x8DA471A9, 0xDE737E24), SK_U64C(0x5CEAECFE, 0xD289E5D2) }, /* 5^221 */
+    { SK_U64C(0xB10D8E14, 0x56105DAD), SK_U64C(0x7425A83E, 0x872C5F47) }, /* 5^222 */
+    { SK_U64C(0xDD50F199, 0x6B947518), SK_U64C(0xD12F124E, 0x28F77719) }, /* 5^223 */
+    { SK_U64C(0x8A5296FF, 0xE33CC92F), SK_U64C(0x82BD6B70, 0xD99AAA6F) }, /* 5^224 */
+    { SK_U64C(0xACE73CBF, 0xDC0BFB7B), SK_U64C(0x636CC64D, 0x1001550B) }, /* 5^225 */
+    { SK_U64C(0xD8210BEF, 0xD30EFA5A), SK_U64C(0x3C47F7E0, 0x5401AA4E) }, /* 5^226 */
+    { SK_U64C(0x8714A775, 0xE3E95C78), SK_U64C(0x65ACFAEC, 0x34810A71) }, /* 5^227 */
+    { SK_U64C(0xA8D9D153, 0x5CE3B396), SK_U64C(0x7F1839A7, 0x41A14D0D) }, /* 5^228 */
+    { SK_U64C(0xD31045A8, 0x341CA07C), SK_U64C(0x1EDE4811, 0x1209A050) }, /* 5^229 */
+    { SK_U64C(0x83EA2B89, 0x2091E44D), SK_U64C(0x934AED0A, 0xAB460432) }, /* 5^230 */
+    { SK_U64C(0xA4E4B66B, 0x68B65D60), SK_U64C(0xF81DA84D, 0x5617853F) }, /* 5^231 */
+    { SK_U64C(0xCE1DE406, 0x42E3F4B9), SK_U64C(0x36251260, 0xAB9D668E) }, /* 5^232 */
+    { SK_U64C(0x80D2AE83, 0xE9CE78F3), SK_U64C(0xC1D72B7C, 0x6B426019) }, /* 5^233 */
+    { SK_U64C(0xA1075A24, 0xE4421730), SK_U64C(0xB24CF65B, 0x8612F81F) }, /* 5^234 */
+    { SK_U64C(0xC94930AE, 0x1D529CFC), SK_U64C(0xDEE033F2, 0x6797B627) }, /* 5^235 */
+    { SK_U64C(0xFB9B7CD9, 0xA4A7443C), SK_U64C(0x169840EF, 0x017DA3B1) }, /* 5^236 */
+    { SK_U64C(0x9D412E08, 0x06E88AA5), SK_U64C(0x8E1F2895, 0x60EE864E) }, /* 5^237 */
+    { SK_U64C(0xC491798A, 0x08A2AD4E), SK_U64C(0xF1A6F2BA, 0xB92A27E2) }, /* 5^238 */
+    { SK_U64C(0xF5B5D7EC, 0x8ACB58A2), SK_U64C(0xAE10AF69, 0x6774B1DB) }, /* 5^239 */
+    { SK_U64C(0x9991A6F3, 0xD6BF1765), SK_U64C(0xACCA6DA1, 0xE0A8EF29) }, /* 5^240 */
+    { SK_U64C(0xBFF610B0, 0xCC6EDD3F), SK_U64C(0x17FD090A, 0x58D32AF3) }, /* 5^241 */
+    { SK_U64C(0xEFF394DC, 0xFF8A948E), SK_U64C(0xDDFC4B4C, 0xEF07F5B0) }, /* 5^242 */
+    { SK_U64C(0x95F83D0A, 0x1FB69CD9), SK_U64C(0x4ABDAF10, 0x1564F98E) }, /* 5^243 */
+    { SK_U64C(0xBB764C4C, 0xA7A4440F), SK_U64C(0x9D6D1AD4, 0x1ABE37F1) }, /* 5^244 */
+    { SK_U64C(0xEA53DF5F, 0xD18D5513), SK_U64C(0x84C86189, 0x216DC5ED) }, /* 5^245 */
+    { SK_U64C(0x92746B9B, 0xE2F8552C), SK_U64C(0x32FD3CF5, 0xB4E49BB4) }, /* 5^246 */
+    { SK_U64C(0xB7118682, 0xDBB66A77), SK_U64C(0x3FBC8C33, 0x221DC2A1) }, /* 5^247 */
+    { SK_U64C(0xE4D5E823, 0x92A40515), SK_U64C(0x0FABAF3F, 0xEAA5334A) }, /* 5^248 */
+    { SK_U64C(0x8F05B116, 0x3BA6832D), SK_U64C(0x29CB4D87, 0xF2A7400E) }, /* 5^249 */
+    { SK_U64C(0xB2C71D5B, 0xCA9023F8), SK_U64C(0x743E20E9, 0xEF511012) }, /* 5^250 */
+    { SK_U64C(0xDF78E4B2, 0xBD342CF6), SK_U64C(0x914DA924, 0x6B255416) }, /* 5^251 */
+    { SK_U64C(0x8BAB8EEF, 0xB6409C1A), SK_U64C(0x1AD089B6, 0xC2F7548E) }, /* 5^252 */
+    { SK_U64C(0xAE9672AB, 0xA3D0C320), SK_U64C(0xA184AC24, 0x73B529B1) }, /* 5^253 */
+    { SK_U64C(0xDA3C0F56, 0x8CC4F3E8), SK_U64C(0xC9E5D72D, 0x90A2741E) }, /* 5^254 */
+    { SK_U64C(0x88658996, 0x17FB1871), SK_U64C(0x7E2FA67C, 0x7A658892) }, /* 5^255 */
+    { SK_U64C(0xAA7EEBFB, 0x9DF9DE8D), SK_U64C(0xDDBB901B, 0x98FEEAB7) }, /* 5^256 */
+    { SK_U64C(0xD51EA6FA, 0x85785631), SK_U64C(0x552A7422, 0x7F3EA565) }, /* 5^257 */
+    { SK_U64C(0x8533285C, 0x936B35DE), SK_U64C(0xD53A8895, 0x8F87275F) }, /* 5^258 */
+    { SK_U64C(0xA67FF273, 0xB8460356), SK_U64C(0x8A892ABA, 0xF368F137) }, /* 5^259 */
+    { SK_U64C(0xD01FEF10, 0xA657842C), SK_U64C(0x2D2B7569, 0xB0432D85) }, /* 5^260 */
+    { SK_U64C(0x8213F56A, 0x67F6B29B), SK_U64C(0x9C3B2962, 0x0E29FC73) }, /* 5^261 */
+    { SK_U64C(0xA298F2C5, 0x01F45F42), SK_U64C(0x8349F3BA, 0x91B47B8F) }, /* 5^262 */
+    { SK_U64C(0xCB3F2F76, 0x42717713), SK_U64C(0x241C70A9, 0x36219A73) }, /* 5^263 */
+    { SK_U64C(0xFE0EFB53, 0xD30DD4D7), SK_U64C(0xED238CD3, 0x83AA0110) }, /* 5^264 */
+    { SK_U64C(0x9EC95D14, 0x63E8A506), SK_U64C(0xF4363804, 0x324A40AA) }, /* 5^265 */
+    { SK_U64C(0xC67BB459, 0x7CE2CE48), SK_U64C(0xB143C605, 0x3EDCD0D5) }, /* 5^266 */
+    { SK_U64C(0xF81AA16F, 0xDC1B81DA), SK_U64C(0xDD94B786, 0x8E94050A) }, /* 5^267 */
+    { SK_U64C(0x9B10A4E5, 0xE9913128), SK_U64C(0xCA7CF2B4, 0x191C8326) }, /* 5^268 */
+    { SK_U64C(0xC1D4CE1F, 0x63F57D72), SK_U64C(0xFD1C2F61, 0x1F63A3F0) }, /* 5^269 */
+    { SK_U64C(0xF24A01A7, 0x3CF2DCCF), SK_U64C(0xBC633B39, 0x673C8CEC) }, /* 5^270 */
+    { SK_U64C(0x976E4108, 0x8617CA01), SK_U64C(0xD5BE0503, 0xE085D813) }, /* 5^271 */
+    { SK_U64C(0xBD49D14A, 0xA79DBC82), SK_U64C(0x4B2D8644, 0xD8A74E18) }, /* 5^272 */
+    { SK_U64C(0xEC9C459D, 0x51852BA2), SK_U64C(0xDDF8E7D6, 0x0ED1219E) }, /* 5^273 */
+    { SK_U64C(0x93E1AB82, 0x52F33B45), SK_U64C(0xCABB90E5, 0xC942B503) }, /* 5^274 */
+    { SK_U64C(0xB8DA1662, 0xE7B00A17), SK_U64C(0x3D6A751F, 0x3B936243) }, /* 5^275 */
+    { SK_U64C(0xE7109BFB, 0xA19C0C9D), SK_U64C(0x0CC51267, 0x0A783AD4) }, /* 5^276 */
+    { SK_U64C(0x906A617D, 0x450187E2), SK_U64C(0x27FB2B80, 0x668B24C5) }, /* 5^277 */
+    { SK_U64C(0xB484F9DC, 0x9641E9DA), SK_U64C(0xB1F9F660, 0x802DEDF6) }, /* 5^278 */
+    { SK_U64C(0xE1A63853, 0xBBD26451), SK_U64C(0x5E7873F8, 0xA0396973) }, /* 5^279 */
+    { SK_U64C(0x8D07E334, 0x55637EB2), SK_U64C(0xDB0B487B, 0x6423E1E8) }, /* 5^280 */
+    { SK_U64C(0xB049DC01, 0x6ABC5E5F), SK_U64C(0x91CE1A9A, 0x3D2CDA62) }, /* 5^281 */
+    { SK_U64C(0xDC5C5301, 0xC56B75F7), SK_U64C(0x7641A140, 0xCC7810FB) }, /* 5^282 */
+    { SK_U64C(0x89B9B3E1, 0x1B6329BA), SK_U64C(0xA9E904C8, 0x7FCB0A9D) }, /* 5^283 */
+    { SK_U64C(0xAC2820D9, 0x623BF429), SK_U64C(0x546345FA, 0x9FBDCD44) }, /* 5^284 */
+    { SK_U64C(0xD732290F, 0xBACAF133), SK_U64C(0xA97C1779, 0x47AD4095) }, /* 5^285 */
+    { SK_U64C(0x867F59A9, 0xD4BED6C0), SK_U64C(0x49ED8EAB, 0xCCCC485D) }, /* 5^286 */
+    { SK_U64C(0xA81F3014, 0x49EE8C70), SK_U64C(0x5C68F256, 0xBFFF5A74) }, /* 5^287 */
+    { SK_U64C(0xD226FC19, 0x5C6A2F8C), SK_U64C(0x73832EEC, 0x6FFF3111) }, /* 5^288 */
+    { SK_U64C(0x83585D8F, 0xD9C25DB7), SK_U64C(0xC831FD53, 0xC5FF7EAB) }, /* 5^289 */
+    { SK_U64C(0xA42E74F3, 0xD032F525), SK_U64C(0xBA3E7CA8, 0xB77F5E55) }, /* 5^290 */
+    { SK_U64C(0xCD3A1230, 0xC43FB26F), SK_U64C(0x28CE1BD2, 0xE55F35EB) }, /* 5^291 */
+    { SK_U64C(0x80444B5E, 0x7AA7CF85), SK_U64C(0x7980D163, 0xCF5B81B3) }, /* 5^292 */
+    { SK_U64C(0xA0555E36, 0x1951C366), SK_U64C(0xD7E105BC, 0xC332621F) }, /* 5^293 */
+    { SK_U64C(0xC86AB5C3, 0x9FA63440), SK_U64C(0x8DD9472B, 0xF3FEFAA7) }, /* 5^294 */
+    { SK_U64C(0xFA856334, 0x878FC150), SK_U64C(0xB14F98F6, 0xF0FEB951) }, /* 5^295 */
+    { SK_U64C(0x9C935E00, 0xD4B9D8D2), SK_U64C(0x6ED1BF9A, 0x569F33D3) }, /* 5^296 */
+    { SK_U64C(0xC3B83581, 0x09E84F07), SK_U64C(0x0A862F80, 0xEC4700C8) }, /* 5^297 */
+    { SK_U64C(0xF4A642E1, 0x4C6262C8), SK_U64C(0xCD27BB61, 0x2758C0FA) }, /* 5^298 */
+    { SK_U64C(0x98E7E9CC, 0xCFBD7DBD), SK_U64C(0x8038D51C, 0xB897789C) }, /* 5^299 */
+    { SK_U64C(0xBF21E440, 0x03ACDD2C), SK_U64C(0xE0470A63, 0xE6BD56C3) }, /* 5^300 */
+    { SK_U64C(0xEEEA5D50, 0x04981478), SK_U64C(0x1858CCFC, 0xE06CAC74) }, /* 5^301 */
+    { SK_U64C(0x95527A52, 0x02DF0CCB), SK_U64C(0x0F37801E, 0x0C43EBC8) }, /* 5^302 */
+    { SK_U64C(0xBAA718E6, 0x8396CFFD), SK_U64C(0xD3056025, 0x8F54E6BA) }, /* 5^303 */
+    { SK_U64C(0xE950DF20, 0x247C83FD), SK_U64C(0x47C6B82E, 0xF32A2069) }, /* 5^304 */
+    { SK_U64C(0x91D28B74, 0x16CDD27E), SK_U64C(0x4CDC331D, 0x57FA5441) }, /* 5^305 */
+    { SK_U64C(0xB6472E51, 0x1C81471D), SK_U64C(0xE0133FE4, 0xADF8E952) }, /* 5^306 */
+    { SK_U64C(0xE3D8F9E5, 0x63A198E5), SK_U64C(0x58180FDD, 0xD97723A6) }, /* 5^307 */
+    { SK_U64C(0x8E679C2F, 0x5E44FF8F), SK_U64C(0x570F09EA, 0xA7EA7648) }, /* 5^308 */
+};
+
+static int leading_zeroes(skU64 x)
+{
+    int n;
+
+    n = 0;
+    if(!(x >> 32)) {
+        n += 32;
+        x <<= 32;
+    }
+    if(!(x >> 48)) {
+        n += 16;
+        x <<= 16;
+    }
+    if(!(x >> 56)) {
+        n += 8;
+        x <<= 8;
+    }
+    if(!(x >> 60)) {
+        n += 4;
+        x <<= 4;
+    }
+    if(!(x >> 62)) {
+        n += 2;
+        x <<= 2;
+    }
+    if(!(x >> 63)) {
+        n += 1;
+    }
+    return n;
+}
+
+/* Full 64 x 64 -> 128 bit multiplication */
+static void full_mul(skU64 a, skU64 b, skU64* hi, skU64* lo)
+{
+#if defined(__SIZEOF_INT128__)
+    skU128 r;
+
+    r   = (skU128) a * b;
+    *hi = (skU64) (r >> 64);
+    *lo = (skU64) r;
+#else
+    skU64 a_lo, a_hi, b_lo, b_hi;
+    skU64 p0, p1, p2, p3, mid;
+
+    a_lo = a & 0xFFFFFFFFUL;
+    a_hi = a >> 32;
+    b_lo = b & 0xFFFFFFFFUL;
+    b_hi = b >> 32;
+
+    p0 = a_lo * b_lo;
+    p1 = a_lo * b_hi;
+    p2 = a_hi * b_lo;
+    p3 = a_hi * b_hi;
+
+    mid = (p0 >> 32) + (p1 & 0xFFFFFFFFUL) + (p2 & 0xFFFFFFFFUL);
+    *lo = (mid << 32) | (p0 & 0xFFFFFFFFUL);
+    *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+static double double_from_bits(skFloatBits bits, bool negative)
+{
+    skU64  raw;
+    double dbl;
+
+    raw = bits.mantissa | ((skU64) bits.power2 << MANTISSA_BITS);
+    if(negative) {
+        raw |= SK_U64C(0x80000000, 0);
+    }
+
+    memcpy(&dbl, &raw, sizeof(double));
+    return dbl;
+}
+
+/* Eisel-Lemire algorithm, computes the binary64 closest to W * 10^Q.
+ * The two 128-bit products are always sufficient to round correctly
+ * when W is exact (Mushtak & Lemire, "Fast Number Parsing Without
+ * Fallback"). */
+static skFloatBits eisel_lemire(skU64 w, long q)
+{
+    skFloatBits    bits;
+    const skU64*   pow5;
+    skU64          hi, lo;
+    skU64          second_hi, second_lo;
+    int            lz, upperbit, shift;
+
+    bits.mantissa = 0;
+    bits.power2   = 0;
+
+    if(w == 0 || q < SMALLEST_POWER10) {
+        return bits;
+    }
+
+    if(q > LARGEST_POWER10) {
+        bits.power2 = INFINITE_POWER;
+        return bits;
+    }
+
+    lz = leading_zeroes(w);
+    w <<= lz;
+
+    /* We need 55 significant bits (mantissa, hidden bit, rounding bit
+     * and one spare), take the second product only if those bits might
+     * still change. */
+    pow5 = POW5_128[q - SMALLEST_POWER10];
+    full_mul(w, pow5[0], &hi, &lo);
+    if((hi & 0x1FF) == 0x1FF) {
+        full_mul(w, pow5[1], &second_hi, &second_lo);
+        lo += second_hi;
+        if(second_hi > lo) {
+            hi++;
+        }
+    }
+
+    upperbit      = (int) (hi >> 63);
+    shift         = upperbit + 64 - MANTISSA_BITS - 3;
+    bits.mantissa = hi >> shift;
+    /* floor(log2(10^q)) + 63 */
+    bits.power2   = (int) ((((152170L + 65536L) * q) >> 16) + 63) + upperbit - lz + EXPONENT_BIAS;
+
+    /* Subnormal */
+    if(bits.power2 <= 0) {
+        if(-bits.power2 + 1 >= 64) {
+            bits.mantissa = 0;
+            bits.power2   = 0;
+            return bits;
+        }
+        bits.mantissa >>= -bits.power2 + 1;
+        bits.mantissa += (bits.mantissa & 1);
+        bits.mantissa >>= 1;
+        bits.power2 = (bits.mantissa < (SK_U64C(0, 1) << MANTISSA_BITS)) ? 0 : 1;
+        return bits;
+    }
+
+    /* Exactly half-way between two floats, round to even */
+    if(lo <= 1 && q >= MIN_ROUND_TO_EVEN && q <= MAX_ROUND_TO_EVEN && (bits.mantissa & 3) == 1
+       && (bits.mantissa << shift) == hi)
+    {
+        bits.mantissa &= ~(skU64) 1;
+    }
+
+    bits.mantissa += (bits.mantissa & 1);
+    bits.mantissa >>= 1;
+    if(bits.mantissa >= (SK_U64C(0, 2) << MANTISSA_BITS)) {
+        bits.mantissa = SK_U64C(0, 1) << MANTISSA_BITS;
+        bits.power2++;
+    }
+
+    bits.mantissa &= ~(SK_U64C(0, 1) << MANTISSA_BITS);
+    if(bits.power2 >= INFINITE_POWER) {
+        bits.mantissa = 0;
+        bits.power2   = INFINITE_POWER;
+    }
+
+    return bits;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Slow path, arbitrary precision decimal (simple decimal conversion).
+ * Used only when the mantissa had more than 19 significant digits and
+ * its lower and upper bound round to different doubles. */
+
+/* Max digits kept, the rest only marks the decimal as truncated */
+#define DECIMAL_DIGITS 800
+/* Max shift that can't overflow 'skU64' while shifting */
+#define MAX_SHIFT      60
+
+typedef struct {
+    unsigned char d[DECIMAL_DIGITS]; /* Digits (0-9), most significant first */
+    int           nd;                /* Number of digits used */
+    int           dp;                /* Position of the decimal point */
+    bool          trunc;             /* Non-zero digits were discarded */
+} skDecimal;
+
+/* Binary shift amounts to scale the decimal by 10^n */
+static const int POWTAB[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+
+static void skDecimal_trim(skDecimal* dec)
+{
+    while(dec->nd > 0 && dec->d[dec->nd - 1] == 0) {
+        dec->nd--;
+    }
+    if(dec->nd == 0) {
+        dec->dp = 0;
+    }
+}
+
+static void skDecimal_from_lexeme(skDecimal* dec, const skStrSlice* lexeme)
+{
+    const char* cur;
+    const char* end;
+    bool        saw_dot;
+    bool        exp_negative;
+    long        exp;
+
+    cur          = lexeme->ptr;
+    end          = lexeme->ptr + lexeme->len;
+    dec->nd      = 0;
+    dec->dp      = 0;
+    dec->trunc   = false;
+    saw_dot      = false;
+    exp_negative = false;
+    exp          = 0;
+
+    if(cur < end && *cur == '-') {
+        cur++;
+    }
+
+    for(; cur < end; cur++) {
+        if(*cur == '.') {
+            saw_dot = true;
+            dec->dp = dec->nd;
+        } else if(*cur >= '0' && *cur <= '9') {
+            if(*cur == '0' && dec->nd == 0) {
+                /* Leading zeroes */
+                dec->dp--;
+            } else if(dec->nd < DECIMAL_DIGITS) {
+                dec->d[dec->nd++] = *cur - '0';
+            } else if(*cur != '0') {
+                dec->trunc = true;
+            }
+        } else {
+            break;
+        }
+    }
+
+    if(!saw_dot) {
+        dec->dp = dec->nd;
+    }
+
+    if(cur < end && (*cur == 'e' || *cur == 'E')) {
+        if(++cur < end && (*cur == '+' || *cur == '-')) {
+            exp_negative = (*cur++ == '-');
+        }
+        for(; cur < end && *cur >= '0' && *cur <= '9'; cur++) {
+            if(exp < 10000) {
+                exp = exp * 10 + (*cur - '0');
+            }
+        }
+        dec->dp += (exp_negative) ? -exp : exp;
+    }
+
+    skDecimal_trim(dec);
+}
+
+/* Multiplies the decimal by 2^K */
+static void skDecimal_left_shift(skDecimal* dec, unsigned int k)
+{
+    unsigned char tmp[DECIMAL_DIGITS + 20];
+    skU64         n, quo;
+    int           r, w, nd;
+
+    n = 0;
+    w = sizeof(tmp);
+
+    /* Multiply from the least significant digit, writing backwards */
+    for(r = dec->nd - 1; r >= 0; r--) {
+        n += (skU64) dec->d[r] << k;
+        quo      = n / 10;
+        tmp[--w] = (unsigned char) (n - 10 * quo);
+        n        = quo;
+    }
+    while(n > 0) {
+        quo      = n / 10;
+        tmp[--w] = (unsigned char) (n - 10 * quo);
+        n        = quo;
+    }
+
+    nd = sizeof(tmp) - w;
+    dec->dp += nd - dec->nd;
+
+    if(nd > DECIMAL_DIGITS) {
+        for(r = w + DECIMAL_DIGITS; r < (int) sizeof(tmp); r++) {
+            if(tmp[r] != 0) {
+                dec->trunc = true;
+            }
+        }
+        nd = DECIMAL_DIGITS;
+    }
+
+    memcpy(dec->d, tmp + w, nd);
+    dec->nd = nd;
+    skDecimal_trim(dec);
+}
+
+/* Divides the decimal by 2^K */
+static void skDecimal_right_shift(skDecimal* dec, unsigned int k)
+{
+    skU64 n, mask, dig;
+    int   r, w;
+
+    r = 0;
+    w = 0;
+    n = 0;
+
+    /* Pick up enough leading digits to cover the first shift */
+    for(; (n >> k) == 0; r++) {
+        if(r >= dec->nd) {
+            if(n == 0) {
+                dec->nd = 0;
+                return;
+            }
+            for(; (n >> k) == 0; r++) {
+                n *= 10;
+            }
+            break;
+        }
+        n = n * 10 + dec->d[r];
+    }
+
+    dec->dp -= r - 1;
+    mask = (SK_U64C(0, 1) << k) - 1;
+
+    /* Pick up a digit, put down a digit */
+    for(; r < dec->nd; r++) {
+        dig           = n >> k;
+        n            &= mask;
+        dec->d[w++]   = (unsigned char) dig;
+        n             = n * 10 + dec->d[r];
+    }
+
+    /* Put down the remaining digits */
+    while(n > 0) {
+        dig  = n >> k;
+        n   &= mask;
+        if(w < DECIMAL_DIGITS) {
+            dec->d[w++] = (unsigned char) dig;
+        } else if(dig > 0) {
+            dec->trunc = true;
+        }
+        n *= 10;
+    }
+
+    dec->nd = w;
+    skDecimal_trim(dec);
+}
+
+static void skDecimal_shift(skDecimal* dec, int k)
+{
+    if(dec->nd == 0) {
+        return;
+    }
+
+    if(k > 0) {
+        for(; k > MAX_SHIFT; k -= MAX_SHIFT) {
+            skDecimal_left_shift(dec, MAX_SHIFT);
+        }
+        skDecimal_left_shift(dec, k);
+    } else if(k < 0) {
+        for(; k < -MAX_SHIFT; k += MAX_SHIFT) {
+            skDecimal_right_shift(dec, MAX_SHIFT);
+        }
+        skDecimal_right_shift(dec, -k);
+    }
+}
+
+/* Rounds the integer part of the decimal, half-way rounds to even */
+static skU64 skDecimal_rounded_integer(const skDecimal* dec)
+{
+    skU64 n;
+    int   i;
+    bool  round_up;
+
+    n = 0;
+    for(i = 0; i < dec->dp && i < dec->nd; i++) {
+        n = n * 10 + dec->d[i];
+    }
+    for(; i < dec->dp; i++) {
+        n *= 10;
+    }
+
+    round_up = false;
+    if(dec->dp >= 0 && dec->dp < dec->nd) {
+        if(dec->d[dec->dp] == 5 && dec->dp + 1 == dec->nd) {
+            round_up = dec->trunc || (dec->dp > 0 && (dec->d[dec->dp - 1] & 1));
+        } else {
+            round_up = dec->d[dec->dp] >= 5;
+        }
+    }
+
+    return n + round_up;
+}
+
+static skFloatBits skDecimal_to_bits(skDecimal* dec)
+{
+    skFloatBits bits;
+    int         exp, n;
+
+    bits.mantissa = 0;
+    bits.power2   = 0;
+
+    if(dec->nd == 0 || dec->dp < -330) {
+        return bits;
+    }
+
+    if(dec->dp > 310) {
+        bits.power2 = INFINITE_POWER;
+        return bits;
+    }
+
+    /* Scale by powers of two until in range [0.5, 1) */
+    exp = 0;
+    while(dec->dp > 0) {
+        n = (dec->dp >= 9) ? 27 : POWTAB[dec->dp];
+        skDecimal_shift(dec, -n);
+        exp += n;
+    }
+    while(dec->dp < 0 || (dec->dp == 0 && dec->d[0] < 5)) {
+        n = (-dec->dp >= 9) ? 27 : POWTAB[-dec->dp];
+        skDecimal_shift(dec, n);
+        exp -= n;
+    }
+
+    /* Our range is [0.5, 1) but floating point range is [1, 2) */
+    exp--;
+
+    /* Denormal, shift down to the minimum exponent */
+    if(exp < 1 - EXPONENT_BIAS) {
+        n = 1 - EXPONENT_BIAS - exp;
+        skDecimal_shift(dec, -n);
+        exp += n;
+    }
+
+    if(exp + EXPONENT_BIAS >= INFINITE_POWER) {
+        bits.power2 = INFINITE_POWER;
+        return bits;
+    }
+
+    /* Extract the mantissa with its hidden bit */
+    skDecimal_shift(dec, MANTISSA_BITS + 1);
+    bits.mantissa = skDecimal_rounded_integer(dec);
+
+    /* Rounding might have added a bit */
+    if(bits.mantissa == (SK_U64C(0, 2) << MANTISSA_BITS)) {
+        bits.mantissa >>= 1;
+        exp++;
+        if(exp + EXPONENT_BIAS >= INFINITE_POWER) {
+            bits.mantissa = 0;
+            bits.power2   = INFINITE_POWER;
+            return bits;
+        }
+    }
+
+    /* Denormal numbers don't have the hidden bit */
+    if(!(bits.mantissa & (SK_U64C(0, 1) << MANTISSA_BITS))) {
+        bits.power2 = 0;
+    } else {
+        bits.power2 = exp + EXPONENT_BIAS;
+    }
+
+    bits.mantissa &= ~(SK_U64C(0, 1) << MANTISSA_BITS);
+    return bits;
+}
+
+double skNumber_to_double(const skNumber* number, const skStrSlice* lexeme)
+{
+    skFloatBits bits, upper;
+    skDecimal   dec;
+    double      dbl;
+    skU64       w;
+    long        q;
+
+    w = number->mantissa;
+    q = number->exponent;
+
+#ifndef SK_NO_FAST_PATH
+    /* Clinger's fast path, both the mantissa and the power of ten are
+     * exact doubles so a single operation rounds correctly. */
+    if(!number->truncated && w <= MAX_EXACT_INT && q >= -22 && q <= 22) {
+        dbl = (double) w;
+        dbl = (q < 0) ? dbl / POW10[-q] : dbl * POW10[q];
+        return (number->negative) ? -dbl : dbl;
+    }
+#endif
+
+    bits = eisel_lemire(w, q);
+
+    /* Real value is somewhere between 'w' and 'w + 1', if both round the
+     * same way we are done. */
+    if(number->truncated) {
+        upper = eisel_lemire(w + 1, q);
+        if(upper.mantissa != bits.mantissa || upper.power2 != bits.power2) {
+            skDecimal_from_lexeme(&dec, lexeme);
+            bits = skDecimal_to_bits(&dec);
+        }
+    }
+
+    return double_from_bits(bits, number->negative);
+}
+
+bool skNumber_to_integer(const skNumber* number, long* integer)
+{
+    skU64 limit;
+
+    /* Magnitude of LONG_MIN is LONG_MAX + 1 */
+    limit = (skU64) LONG_MAX + number->negative;
+    if(number->is_double || number->truncated || number->mantissa > limit) {
+        return false;
+    }
+
+    if(number->negative) {
+        *integer = (number->mantissa == limit) ? LONG_MIN : -(long) number->mantissa;
+    } else {
+        *integer = (long) number->mantissa;
+    }
+
+    return true;
+}
+
+size_t skNumber_lexeme_len(const char* text)
+{
+    size_t len;
+
+    for(len = 0;; len++) {
+        switch(text[len]) {
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+            case '-': case '+': case '.': case 'e': case 'E':
+                continue;
+            default:
+                return len;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------ */
+/* Formatting, Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers"). */
+
+/* Grisu requires the scaled exponent to be in range [ALPHA, GAMMA] */
+#define GRISU_ALPHA -60
+#define GRISU_GAMMA -32
+/* Decimal exponent of the first cached power and distance between them */
+#define CACHED_POWERS_MIN_EXP  -300
+#define CACHED_POWERS_EXP_STEP 8
+/* Decimal point positions formatted without the exponent */
+#define FORMAT_MIN_EXP -4
+#define FORMAT_MAX_EXP 15
+
+static skDiyFp skDiyFp_new(skU64 f, int e)
+{
+    skDiyFp fp;
+
+    fp.f = f;
+    fp.e = e;
+    return fp;
+}
+
+/* Upper 64 bits of the product rounded, exponent is adjusted accordingly */
+static skDiyFp skDiyFp_mul(skDiyFp x, skDiyFp y)
+{
+    skU64 hi, lo;
+
+    full_mul(x.f, y.f, &hi, &lo);
+    /* Round, ties up */
+    hi += lo >> 63;
+    return skDiyFp_new(hi, x.e + y.e + 64);
+}
+
+static skDiyFp skDiyFp_normalize(skDiyFp x)
+{
+    int lz;
+
+    lz = leading_zeroes(x.f);
+    return skDiyFp_new(x.f << lz, x.e - lz);
+}
+
+/* Computes the normalized value V and its boundaries M_MINUS and M_PLUS
+ * (half-way to the neighbouring doubles) sharing the exponent of M_PLUS. */
+static void compute_boundaries(double value, skDiyFp* v, skDiyFp* m_minus, skDiyFp* m_plus)
+{
+    skU64   bits, fraction, biased_exp;
+    skDiyFp minus;
+    bool    lower_closer;
+
+    memcpy(&bits, &value, sizeof(double));
+    biased_exp = (bits >> MANTISSA_BITS) & INFINITE_POWER;
+    fraction   = bits & ((SK_U64C(0, 1) << MANTISSA_BITS) - 1);
+
+    if(biased_exp == 0) {
+        *v = skDiyFp_new(fraction, 1 - EXPONENT_BIAS - MANTISSA_BITS);
+    } else {
+        *v = skDiyFp_new(
+            fraction | (SK_U64C(0, 1) << MANTISSA_BITS),
+            (int) biased_exp - EXPONENT_BIAS - MANTISSA_BITS);
+    }
+
+    /* Lower boundary is closer if the value is a power of two
+     * (except for the smallest normal). */
+    lower_closer = fraction == 0 && biased_exp > 1;
+    *m_plus      = skDiyFp_normalize(skDiyFp_new(2 * v->f + 1, v->e - 1));
+    minus        = (lower_closer) ? skDiyFp_new(4 * v->f - 1, v->e - 2)
+                                  : skDiyFp_new(2 * v->f - 1, v->e - 1);
+    *m_minus     = skDiyFp_new(minus.f << (minus.e - m_plus->e), m_plus->e);
+    *v           = skDiyFp_normalize(*v);
+}
+
+/* Returns cached power c = 10^-k such that the exponent of e * c
+ * lands in range [GRISU_ALPHA, GRISU_GAMMA]. */
+static skCachedPower cached_power_for_exponent(int e)
+{
+    long f, k;
+
+    /* k = ceil((ALPHA - e - 1) * log10(2)), with division rounding
+     * towards zero regardless of the compiler. */
+    f = GRISU_ALPHA - e - 1;
+    if(f > 0) {
+        k = (f * 78913L) / (1L << 18) + 1;
+    } else {
+        k = -((-f * 78913L) / (1L << 18));
+    }
+
+    return CACHED_POWERS
+        [(-CACHED_POWERS_MIN_EXP + k + (CACHED_POWERS_EXP_STEP - 1)) / CACHED_POWERS_EXP_STEP];
+}
+
+/* Largest power of ten not greater than N, returns its number of digits */
+static int largest_pow10(unsigned long n, unsigned long* pow10)
+{
+    int digits;
+
+    *pow10 = 1;
+    for(digits = 1; n / *pow10 >= 10; digits++) {
+        *pow10 *= 10;
+    }
+    return digits;
+}
+
+/* Moves the last digit closer to the exact value while it stays
+ * within the boundaries. */
+static void grisu2_round(char* buf, int len, skU64 dist, skU64 delta, skU64 rest, skU64 ten_k)
+{
+    while(rest < dist && delta - rest >= ten_k
+          && (rest + ten_k < dist || dist - rest > rest + ten_k - dist))
+    {
+        buf[len - 1]--;
+        rest += ten_k;
+    }
+}
+
+/* Generates the shortest digits of a value within [M_MINUS, M_PLUS],
+ * closest to W. */
+static void grisu2_digit_gen(
+    char*   buf,
+    int*    len,
+    int*    decimal_exp,
+    skDiyFp m_minus,
+    skDiyFp w,
+    skDiyFp m_plus)
+{
+    skU64         delta, dist, one, p2, rest;
+    unsigned long p1, pow10, digit;
+    int           shift, n, m;
+
+    delta = m_plus.f - m_minus.f;
+    dist  = m_plus.f - w.f;
+    shift = -m_plus.e;
+    one   = SK_U64C(0, 1) << shift;
+
+    /* Integral part fits into 32 bits, exponent is at most GRISU_GAMMA */
+    p1 = (unsigned long) (m_plus.f >> shift);
+    p2 = m_plus.f & (one - 1);
+
+    for(n = largest_pow10(p1, &pow10); n > 0; pow10 /= 10) {
+        digit       = p1 / pow10;
+        p1          = p1 % pow10;
+        buf[(*len)++] = (char) ('0' + digit);
+        n--;
+
+        rest = ((skU64) p1 << shift) + p2;
+        if(rest <= delta) {
+            *decimal_exp += n;
+            grisu2_round(buf, *len, dist, delta, rest, (skU64) pow10 << shift);
+            return;
+        }
+    }
+
+    for(m = 0;;) {
+        p2 *= 10;
+        buf[(*len)++] = (char) ('0' + (p2 >> shift));
+        p2 &= one - 1;
+        m++;
+        delta *= 10;
+        dist *= 10;
+        if(p2 <= delta) {
+            break;
+        }
+    }
+
+    *decimal_exp -= m;
+    grisu2_round(buf, *len, dist, delta, p2, one);
+}
+
+/* Writes exponent E into OUT, returns the number of bytes written */
+static size_t format_exponent(char* out, int e)
+{
+    size_t len;
+
+    len        = 0;
+    out[len++] = 'e';
+    if(e < 0) {
+        out[len++] = '-';
+        e          = -e;
+    }
+
+    if(e >= 100) {
+        out[len++] = (char) ('0' + e / 100);
+        e %= 100;
+        out[len++] = DIGIT_PAIRS[e * 2];
+        out[len++] = DIGIT_PAIRS[e * 2 + 1];
+    } else if(e >= 10) {
+        out[len++] = DIGIT_PAIRS[e * 2];
+        out[len++] = DIGIT_PAIRS[e * 2 + 1];
+    } else {
+        out[len++] = (char) ('0' + e);
+    }
+
+    return len;
+}
+
+/* Places the decimal point into the K digits of BUF, N is the position
+ * of the decimal point relative to the start of the digits. */
+static size_t format_digits(char* buf, int k, int n)
+{
+    if(k <= n && n <= FORMAT_MAX_EXP) {
+        /* digits[000].0 */
+        memset(buf + k, '0', n - k);
+        buf[n]     = '.';
+        buf[n + 1] = '0';
+        return n + 2;
+    }
+
+    if(0 < n && n <= FORMAT_MAX_EXP) {
+        /* dig.its */
+        memmove(buf + n + 1, buf + n, k - n);
+        buf[n] = '.';
+        return k + 1;
+    }
+
+    if(FORMAT_MIN_EXP < n && n <= 0) {
+        /* 0.[000]digits */
+        memmove(buf + 2 - n, buf, k);
+        buf[0] = '0';
+        buf[1] = '.';
+        memset(buf + 2, '0', -n);
+        return 2 - n + k;
+    }
+
+    if(k == 1) {
+        /* de123 */
+        return 1 + format_exponent(buf + 1, n - 1);
+    }
+
+    /* d.igitse123 */
+    memmove(buf + 2, buf + 1, k - 1);
+    buf[1] = '.';
+    return k + 1 + format_exponent(buf + k + 1, n - 1);
+}
+
+size_t skNumber_format_double(char* out, double value)
+{
+    skDiyFp       v, m_minus, m_plus;
+    skDiyFp       w, w_minus, w_plus, c;
+    skCachedPower cached;
+    size_t        sign;
+    int           len, decimal_exp;
+
+#ifdef SK_DBUG
+    assert(value - value == 0); /* Finite */
+#endif
+
+    sign = 0;
+    if(value < 0 || (value == 0 && 1 / value < 0)) {
+        out[sign++] = '-';
+        value       = -value;
+    }
+
+    if(value == 0) {
+        memcpy(out + sign, "0.0", 3);
+        return sign + 3;
+    }
+
+    compute_boundaries(value, &v, &m_minus, &m_plus);
+
+    /* Scale everything by the cached power of ten, boundaries are
+     * moved inwards by one unit to stay safe after the rounding. */
+    cached  = cached_power_for_exponent(m_plus.e);
+    c       = skDiyFp_new(cached.f, cached.e);
+    w       = skDiyFp_mul(v, c);
+    w_minus = skDiyFp_mul(m_minus, c);
+    w_plus  = skDiyFp_mul(m_plus, c);
+    w_minus.f++;
+    w_plus.f--;
+
+    len         = 0;
+    decimal_exp = -cached.k;
+    grisu2_digit_gen(out + sign, &len, &decimal_exp, w_minus, w, w_plus);
+
+    return sign + format_digits(out + sign, len, len + decimal_exp);
+}
+
+size_t skNumber_format_integer(char* out, long value)
+{
+    char          buf[SK_NUMBER_BUFSIZE];
+    char*         cur;
+    unsigned long n, idx;
+    size_t        len;
+
+    cur = buf + sizeof(buf);
+    /* Magnitude without overflowing on LONG_MIN */
+    n   = (value < 0) ? 0UL - (unsigned long) value : (unsigned long) value;
+
+    /* Two digits at a time */
+    while(n >= 100) {
+        idx    = (n % 100) * 2;
+        n     /= 100;
+        *--cur = DIGIT_PAIRS[idx + 1];
+        *--cur = DIGIT_PAIRS[idx];
+    }
+
+    if(n >= 10) {
+        *--cur = DIGIT_PAIRS[n * 2 + 1];
+        *--cur = DIGIT_PAIRS[n * 2];
+    } else {
+        *--cur = (char) ('0' + n);
+    }
+
+    if(value < 0) {
+        *--cur = '-';
+    }
+
+    len = buf + sizeof(buf) - cur;
+    memcpy(out, cur, len);
+    return len;
+}
@@ -0,0 +1,47 @@
+#ifndef __SK_NUMBER_H__
+#define __SK_NUMBER_H__
+
+#include "skslice.h"
+#include "sktoken.h"
+
+/**
+ * Converts scanned Json NUMBER into the nearest double (round to nearest,
+ * ties to even) without going through the C library and its locale.
+ * LEXEME is the token span, it is only read again in the rare case
+ * that the mantissa was truncated and both of its bounds round differently.
+ * Returns signed infinity if the number is out of range.
+ */
+double skNumber_to_double(const skNumber *number, const skStrSlice *lexeme);
+
+/**
+ * Converts scanned Json NUMBER without fraction and exponent part into
+ * INTEGER. Returns false if NUMBER is not such integer or it is out of
+ * the range of 'long'.
+ */
+bool skNumber_to_integer(const skNumber *number, long *integer);
+
+/**
+ * Returns the length of the number lexeme starting at TEXT, it ends at
+ * the first byte that can't be a part of a Json number.
+ */
+size_t skNumber_lexeme_len(const char *text);
+
+/* Enough for the longest output of either of the formatting functions */
+#define SK_NUMBER_BUFSIZE 32
+
+/**
+ * Writes the shortest decimal representation of finite double VALUE into
+ * OUT (Grisu2), that parses back into the same VALUE. Output always has
+ * a fraction or an exponent part ("1.0", "1.5e-7") so it is read back as
+ * a double. OUT must have at least SK_NUMBER_BUFSIZE bytes, it is not
+ * nul terminated. Returns the number of bytes written.
+ */
+size_t skNumber_format_double(char *out, double value);
+
+/**
+ * Writes decimal representation of VALUE into OUT, same requirements
+ * apply as for 'skNumber_format_double'. Returns the number of bytes written.
+ */
+size_t skNumber_format_integer(char *out, long value);
+
+#endif
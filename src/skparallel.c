@@ -0,0 +1,313 @@
+/* clang-format off */
+#define _POSIX_C_SOURCE 200112L /* pthreads and sysconf */
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+#include "skerror.h"
+#include "skparser.h" /* Make sure skparser.h which includes sknode.h is included before skjson.h */
+#include "skjson.h"
+#include "skutils.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+/* clang-format on */
+
+/* Smallest number of bytes worth parsing on a separate thread, smaller
+ * buffers are parsed on the calling thread only. */
+#ifndef SK_PARALLEL_SEGMENT
+#define SK_PARALLEL_SEGMENT (1 << 20)
+#endif
+
+/* Contiguous range of the root array elements parsed by a single thread */
+typedef struct {
+    size_t    start;     /* Offset right past the '[' or ',' preceding the range */
+    size_t    end;       /* Offset of the ',' or ']' following the range */
+    size_t    cursor;    /* Position in the index of the first offset of the range */
+    size_t    container; /* Position in 'index->sizes' of the first container of the range */
+    size_t    count;     /* Number of elements in the range */
+    skVec*    elements;  /* Parsed elements, NULL if parsing failed */
+    pthread_t thread;
+    bool      started;
+} skSegment;
+
+/* Work shared by all the segments, read only while the segments are parsed */
+typedef struct {
+    char*          buff;
+    size_t         bufsize;
+    skStructIndex* index;
+    skJson*        array; /* Root array the elements are linked to */
+    skSegment*     segments;
+    size_t         nsegments;
+} skParJob;
+
+typedef struct {
+    const skParJob* job;
+    skSegment*      segment;
+} skSegmentTask;
+
+/* Splits the root array into at most 'job->nsegments' ranges of about the same size
+ * at the commas between its elements. Returns false if the buffer is not an array,
+ * it doesn't fit a single segment or it is nested too deep, parser deals with those. */
+static bool skParJob_split(skParJob* job)
+{
+    const size_t* offsets;
+    skSegment*    segment;
+    size_t        target;
+    size_t        step;
+    size_t        depth;
+    size_t        containers;
+    size_t        i;
+
+    offsets = job->index->offsets;
+
+    if(job->index->len == 0 || offsets[0] != 0 || job->buff[0] != '[') {
+        return false;
+    }
+
+    step       = job->bufsize / job->nsegments;
+    target     = step;
+    depth      = 1;
+    containers = 1;
+
+    segment            = job->segments;
+    segment->start     = 1;
+    segment->cursor    = 1;
+    segment->container = 1;
+    segment->count     = 1;
+
+    for(i = 1; i < job->index->len; i++) {
+        switch(job->buff[offsets[i]]) {
+            case '{':
+            case '[':
+                if(++depth > SK_MAX_DEPTH) {
+                    return false;
+                }
+                containers++;
+                break;
+            case '}':
+            case ']':
+                if(--depth > 0) {
+                    break;
+                }
+                segment->end   = offsets[i];
+                job->nsegments = segment - job->segments + 1;
+                return job->nsegments > 1;
+            case ',':
+                if(depth > 1) {
+                    break;
+                }
+                if(offsets[i] < target || segment + 1 == job->segments + job->nsegments) {
+                    segment->count++;
+                    break;
+                }
+                segment->end = offsets[i];
+                segment++;
+                segment->start     = offsets[i] + 1;
+                segment->cursor    = i + 1;
+                segment->container = containers;
+                segment->count     = 1;
+                while(target <= offsets[i]) {
+                    target += step;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* Root array is never closed */
+    return false;
+}
+
+/* Parses the elements of the 'segment' into a vector, the scanner is set up the
+ * same way the serial parser would be right after the separator preceding them. */
+static skVec* skSegment_parse(const skParJob* job, const skSegment* segment)
+{
+    skScanner scanner;
+    skVec*    elements;
+    skJson    value;
+
+    if(is_null(elements = skVec_with_capacity(sizeof(skJson), segment->count))) {
+        return NULL;
+    }
+
+    skScanner_init(&scanner, job->buff, job->bufsize);
+    scanner.index     = job->index;
+    scanner.cursor    = segment->cursor;
+    scanner.container = segment->container;
+    scanner.depth     = 2;
+
+    /* Container stack is reused by every element */
+    if(is_null(scanner.stack = skVec_new(sizeof(skJson*)))) {
+        skVec_drop(elements, NULL);
+        return NULL;
+    }
+
+    skCharIter_skip_to(&scanner.iter, job->buff + segment->start);
+    skScanner_next(&scanner);
+    skScanner_skip(&scanner, 2, SK_WS, SK_NL);
+
+    for(;;) {
+        value = skJsonNode_parse(&scanner, job->array);
+
+        if(value.type == SK_NONE_NODE || value.type == SK_ERROR_NODE) {
+            goto fail;
+        }
+
+        if(!skVec_push(elements, &value)) {
+            skJsonNode_drop(&value);
+            goto fail;
+        }
+
+        skScanner_skip(&scanner, 2, SK_WS, SK_NL);
+
+        /* Index and the parser agree on where the range ends */
+        if(scanner.token_start == job->buff + segment->end) {
+            break;
+        }
+
+        if(scanner.token_start > job->buff + segment->end
+           || skScanner_peek(&scanner).type != SK_COMMA)
+        {
+            goto fail;
+        }
+
+        skScanner_next(&scanner);
+        skScanner_skip(&scanner, 2, SK_WS, SK_NL);
+    }
+
+    skVec_drop(scanner.stack, NULL);
+    return elements;
+
+fail:
+    skVec_drop(scanner.stack, NULL);
+    skVec_drop(elements, (FreeFn) skJsonNode_drop);
+    return NULL;
+}
+
+static void* skSegment_worker(void* arg)
+{
+    skSegmentTask* task;
+
+    task                    = arg;
+    task->segment->elements = skSegment_parse(task->job, task->segment);
+    return NULL;
+}
+
+/* Parses every segment, the first one on the calling thread. Segments whose
+ * thread could not be started are parsed on the calling thread as well. */
+static void skParJob_run(skParJob* job, skSegmentTask* tasks)
+{
+    size_t i;
+
+    for(i = 1; i < job->nsegments; i++) {
+        tasks[i].job     = job;
+        tasks[i].segment = &job->segments[i];
+        job->segments[i].started =
+            (pthread_create(&job->segments[i].thread, NULL, skSegment_worker, &tasks[i]) == 0);
+    }
+
+    job->segments[0].elements = skSegment_parse(job, &job->segments[0]);
+
+    for(i = 1; i < job->nsegments; i++) {
+        if(job->segments[i].started) {
+            pthread_join(job->segments[i].thread, NULL);
+        } else {
+            job->segments[i].elements = skSegment_parse(job, &job->segments[i]);
+        }
+    }
+}
+
+/* Moves the parsed segments into the root array in order, the elements are already
+ * linked to it. Returns false if any of the segments failed, nothing is moved then. */
+static bool skParJob_stitch(skParJob* job)
+{
+    size_t i;
+
+    for(i = 0; i < job->nsegments; i++) {
+        if(is_null(job->segments[i].elements)) {
+            return false;
+        }
+    }
+
+    for(i = 0; i < job->nsegments; i++) {
+        if(!skVec_append(job->array->data.j_array, job->segments[i].elements)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+PUBLIC(skJson) skJson_parse_parallel(char* buff, size_t bufsize, unsigned int nthreads)
+{
+    skStructIndex  index;
+    skParJob       job;
+    skSegmentTask* tasks;
+    skJson         array;
+    long           online;
+    size_t         i;
+    bool           ok;
+
+    if(is_null(buff) || bufsize == 0) {
+        return skJson_parse(buff, bufsize);
+    }
+
+    if(nthreads == 0) {
+        online   = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (online > 0) ? online : 1;
+    }
+
+    memset(&job, 0, sizeof(skParJob));
+    job.buff      = buff;
+    job.bufsize   = bufsize;
+    job.nsegments = bufsize / SK_PARALLEL_SEGMENT;
+    if(job.nsegments > nthreads) {
+        job.nsegments = nthreads;
+    }
+
+    /* Threads are not worth it if there is nothing to share */
+    if(job.nsegments < 2) {
+        return skJson_parse(buff, bufsize);
+    }
+
+    skStructIndex_init(&index);
+    job.index    = &index;
+    job.segments = calloc(job.nsegments, sizeof(skSegment));
+    tasks        = calloc(job.nsegments, sizeof(skSegmentTask));
+    array.type   = SK_NONE_NODE;
+    ok           = false;
+
+    if(is_null(job.segments) || is_null(tasks)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+    } else if(skStructIndex_build(&index, buff, bufsize) && skParJob_split(&job)
+              && index.nsizes > 0
+              && (array = ArrayNode_new_sized(NULL, NULL, index.sizes[0])).type == SK_ARRAY_NODE)
+    {
+        job.array = &array;
+        skParJob_run(&job, tasks);
+        ok = skParJob_stitch(&job);
+    }
+
+    if(is_some(job.segments)) {
+        for(i = 0; i < job.nsegments; i++) {
+            skVec_drop(job.segments[i].elements, (FreeFn) skJsonNode_drop);
+        }
+    }
+
+    free(tasks);
+    free(job.segments);
+    skStructIndex_release(&index);
+
+    if(ok) {
+        return array;
+    }
+
+    /* Serial parser reports the error (or runs out of memory) the same way
+     * it always does, the buffer was not touched */
+    skJsonNode_drop(&array);
+    return skJson_parse(buff, bufsize);
+}
@@ -3,256 +3,301 @@
 #include <assert.h>
 #endif
 #include "skerror.h"
+#include "sknumber.h"
 #include "skparser.h"
+#include "skutf8.h"
 #include "skutils.h"
-#include <ctype.h>
-#include <errno.h>
 #include <float.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define set_none(node) (node).type = SK_NONE_NODE;
-
-skJsonString skJsonString_new_internal(skScanner* scanner, skJson* err_node);
-skJson       skparse_json_object(skScanner* scanner, skJson* parent);
-skJson       skparse_json_array(skScanner* scanner, skJson* parent);
-skJson       skparse_json_string(skScanner* scanner, skJson* parent);
-skJson       skparse_json_number(skScanner* scanner, skJson* parent);
-skJson       skparse_json_bool(skScanner* scanner, skJson* parent);
-skJson       skparse_json_null(skScanner* scanner, skJson* parent);
-
+/* Frees the parsed string unless it was allocated from the scanner's pool
+ * or it is borrowed from the scanned buffer */
+#define skparse_free(scanner, str)                           \
+    do {                                                     \
+        if(is_null((scanner)->pool) && !(scanner)->insitu) { \
+            free(str);                                       \
+        }                                                    \
+    } while(0)
+
+/* Drops the container stack unless the scanner owns it */
+#define stack_release(scanner, stack)     \
+    do {                                  \
+        if((stack) != (scanner)->stack) { \
+            skVec_drop(stack, NULL);      \
+        }                                 \
+    } while(0)
+
+skJson skparse_json_value(skScanner* scanner, skJson* parent, bool* open);
+skJson skparse_json_object(skScanner* scanner, skJson* parent);
+skJson skparse_json_array(skScanner* scanner, skJson* parent);
+
+/* Parses the Json element without recursion. Containers that are being filled
+ * are kept on the explicit stack, each one points into the storage of its own
+ * parent (or at the root) which is not touched until the container is closed. */
 skJson skJsonNode_parse(skScanner* scanner, skJson* parent)
 {
-    skToken next;
-
-    /* Peek at current token without advancing */
-    next = skScanner_peek(scanner);
-    switch(next.type) {
-        case SK_LCURLY:
-            return skparse_json_object(scanner, parent);
-        case SK_LBRACK:
-            return skparse_json_array(scanner, parent);
-        case SK_STRING:
-            return skparse_json_string(scanner, parent);
-        case SK_HYPHEN:
-        case SK_ZERO:
-        case SK_DIGIT:
-            return skparse_json_number(scanner, parent);
-        case SK_FALSE:
-        case SK_TRUE:
-            return skparse_json_bool(scanner, parent);
-        case SK_NULL:
-            return skparse_json_null(scanner, parent);
-        case SK_INVALID:
-        default:
-            return ErrorNode_new(
-                "Invalid syntax/token while parsing",
-                scanner->iter.state,
-                parent);
-    }
-}
-
-skJson skparse_json_object(skScanner* scanner, skJson* parent)
-{
-    skJson     object_node;
-    skJson     value;
-    skJson     err_node;
-    skObjTuple tuple;
-    char*      key;
-    skToken    token;
-    bool       err;       /* Error flag */
-    bool       parse_err; /* Parse err flag */
-    bool       start;     /* First iteration flag */
-
-    parse_err = false;
-    err       = false;
-    start     = true;
-
-    err_node.type = SK_NONE_NODE;
-    object_node   = ObjectNode_new(parent);
-    /* Return immediately if allocation failed. */
-    if(object_node.type == SK_NONE_NODE) {
-        return object_node;
+    skJson       root;
+    skJson       value;
+    skJson*      top;   /* Container being filled */
+    skJson*      child; /* Last parsed element of 'top' */
+    skVec*       stack; /* Parents of 'top' */
+    skObjTuple   tuple;
+    skToken      token;
+    char*        key;
+    skParseError code;
+    bool         open;
+
+    root = skparse_json_value(scanner, parent, &open);
+    /* Scalars, errors and empty containers are already complete */
+    if(!open) {
+        return root;
     }
 
-    /* Take the first token after '{' */
-    token = skScanner_next(scanner);
-    skScanner_skip(scanner, 2, SK_WS, SK_NL);
+    scanner->depth++;
 
-    /* If next token is '}', return empty object '{}' */
-    if(skScanner_peek(scanner).type == SK_RCURLY) {
-        skScanner_next(scanner);
-        return object_node;
+    if(is_some(scanner->stack)) {
+        stack = scanner->stack;
+        skVec_clear(stack, NULL);
+    } else if(is_null(stack = skVec_new(sizeof(skJson*)))) {
+        goto oom;
     }
 
-    do {
-        if(!start) {
-            skScanner_next(scanner);
-            skScanner_skip(scanner, 2, SK_WS, SK_NL);
-        } else {
-            start = false;
-        }
+    top = &root;
 
-        if((token = skScanner_peek(scanner)).type == SK_STRING) {
+    for(;;) {
+        /* Scanner is at the first token of the next element of 'top' */
+        if(top->type == SK_OBJECT_NODE) {
+            if(skScanner_peek(scanner).type != SK_STRING) {
+                code = SK_PARSE_OBJECT;
+                goto syntax_err;
+            }
 
-            key = skJsonString_new_internal(scanner, &err_node);
+            set_none(value);
+            key = skJsonString_new_internal(scanner, &value);
 
-            if(err_node.type == SK_ERROR_NODE) {
-                err = parse_err = true;
-                break;
+            if(value.type == SK_ERROR_NODE) {
+                goto parse_err;
             } else if(is_null(key)) {
-                skJsonNode_drop(&object_node);
-                set_none(object_node);
-                return object_node;
+                goto oom;
             }
 
             skScanner_next(scanner);
-            skScanner_skip(scanner, 1, SK_WS);
+            skScanner_skip(scanner, 2, SK_WS, SK_NL);
 
             if(skScanner_peek(scanner).type != SK_COLON) {
-                free(key);
-                err = true;
-                break;
+                skparse_free(scanner, key);
+                code = SK_PARSE_OBJECT;
+                goto syntax_err;
             }
 
             skScanner_next(scanner);
-            skScanner_skip(scanner, 1, SK_WS);
+            skScanner_skip(scanner, 2, SK_WS, SK_NL);
 
-            value = skJsonNode_parse(scanner, &object_node);
+            value = skparse_json_value(scanner, top, &open);
 
             if(value.type == SK_NONE_NODE) {
-                free(key);
-                skJsonNode_drop(&object_node);
-                set_none(object_node);
-                return object_node;
+                skparse_free(scanner, key);
+                goto oom;
             } else if(value.type == SK_ERROR_NODE) {
-                free(key);
-                parse_err = err = true;
-                err_node        = value;
-                break;
+                skparse_free(scanner, key);
+                goto parse_err;
             }
 
             tuple.key   = key;
             tuple.value = value;
+            if(scanner->insitu) {
+                tuple.value.flags |= SK_NODE_BORROWED_KEY;
+            }
 #ifdef SK_DBUG
-            assert(tuple.value.parent_arena.ptr == object_node.data.j_object);
-            assert(tuple.value.parent_arena.type == SK_OBJECT_NODE);
+            assert(tuple.value.flags & SK_NODE_IN_OBJECT);
 #endif
+
+            if(!skVec_push(top->data.j_object, &tuple)) {
+                skObjTuple_drop(&tuple);
+                goto oom;
+            }
+
+            child = &((skObjTuple*) skVec_back(top->data.j_object))->value;
         } else {
-            err = true;
-            break;
+            value = skparse_json_value(scanner, top, &open);
+
+            if(value.type == SK_NONE_NODE) {
+                goto oom;
+            } else if(value.type == SK_ERROR_NODE) {
+                goto parse_err;
+            }
+
+            if(!skVec_push(top->data.j_array, &value)) {
+                skJsonNode_drop(&value);
+                goto oom;
+            }
+
+            child = skVec_back(top->data.j_array);
         }
 
-        if(!skVec_push(object_node.data.j_object, &tuple)) {
-            skObjTuple_drop(&tuple);
-            skJsonNode_drop(&object_node);
-            set_none(object_node);
-            return object_node;
+        /* Root is at depth 1, empty containers count as well */
+        if((child->type & (SK_OBJECT_NODE | SK_ARRAY_NODE)) && skVec_len(stack) + 2 > SK_MAX_DEPTH) {
+            code = SK_PARSE_DEPTH;
+            goto syntax_err;
         }
 
-        skScanner_skip(scanner, 2, SK_WS, SK_NL);
+        /* Descend into the opened container */
+        if(open) {
+            if(!skVec_push(stack, &top)) {
+                goto oom;
+            }
+            top = child;
+            scanner->depth++;
+            continue;
+        }
 
-    } while((token = skScanner_peek(scanner)).type == SK_COMMA);
+        /* Element is complete, close all the containers it completes */
+        for(;;) {
+            skScanner_skip(scanner, 2, SK_WS, SK_NL);
 
-    if(err || token.type != SK_RCURLY) {
-        skJsonNode_drop(&object_node);
-        if(parse_err) {
-            return err_node;
-        } else {
-            return ErrorNode_new("failed parsing Json Object", scanner->iter.state, parent);
+            if((token = skScanner_peek(scanner)).type == SK_COMMA) {
+                skScanner_next(scanner);
+                skScanner_skip(scanner, 2, SK_WS, SK_NL);
+                break;
+            }
+
+            if(top->type == SK_OBJECT_NODE && token.type != SK_RCURLY) {
+                code = SK_PARSE_OBJECT;
+                goto syntax_err;
+            } else if(top->type == SK_ARRAY_NODE && token.type != SK_RBRACK) {
+                code = SK_PARSE_ARRAY;
+                goto syntax_err;
+            }
+
+            skScanner_next(scanner);
+            scanner->depth--;
+
+            if(!skVec_pop(stack, &top)) {
+                /* Closed the root */
+                skScanner_skip(scanner, 2, SK_WS, SK_NL);
+                stack_release(scanner, stack);
+                return root;
+            }
         }
     }
 
-    skScanner_next(scanner);
-    skScanner_skip(scanner, 2, SK_WS, SK_NL);
-#ifdef SK_DBUG
-    assert(is_some(object_node.data.j_object));
-    assert(skVec_len(object_node.data.j_object) > 0);
-#endif
-    return object_node;
+syntax_err:
+    value = skparse_error(scanner, code, parent);
+parse_err:
+    /* Error node takes the place of the dropped root */
+    Node_copy_link(&value, &root);
+    skJsonNode_drop(&root);
+    stack_release(scanner, stack);
+    return value;
+
+oom:
+    skJsonNode_drop(&root);
+    stack_release(scanner, stack);
+    set_none(root);
+    return root;
+}
+
+/* Object and array at the current token are parsed by the same driver */
+skJson skparse_json_object(skScanner* scanner, skJson* parent)
+{
+    return skJsonNode_parse(scanner, parent);
 }
 
 skJson skparse_json_array(skScanner* scanner, skJson* parent)
 {
-    skJson  temp;
-    skJson  array_node;
-    skToken token;
-    bool    err;       /* Error flag */
-    bool    start;     /* First iteration flag */
-    bool    parse_err; /* Parsed value error flag */
-
-    start     = true;
-    err       = false;
-    parse_err = false;
-    token     = skScanner_next(scanner);
-
-    array_node = ArrayNode_new(parent);
-    /* If arena allocation failed return immediately. */
-    if(array_node.type == SK_NONE_NODE) {
-        return array_node;
-    }
+    return skJsonNode_parse(scanner, parent);
+}
 
-    skScanner_skip(scanner, 2, SK_WS, SK_NL);
+/* Parses the element at the current token. Containers are only opened, if the
+ * container is not empty 'open' is set and the scanner is at its first element. */
+skJson skparse_json_value(skScanner* scanner, skJson* parent, bool* open)
+{
+    skJson      node;
+    skTokenType closing;
+    size_t      capacity;
 
-    /* If next token ']' return empty array '[]' */
-    if(token.type == SK_RBRACK) {
-        skScanner_next(scanner);
-        return array_node;
+    *open = false;
+
+    switch(skScanner_peek(scanner).type) {
+        case SK_LCURLY:
+        case SK_LBRACK:
+            /* Index counted the elements up front, containers are opened
+             * in the same order as their brackets appear in the buffer */
+            capacity = SK_CONTAINER_INLINE;
+            if(is_some(scanner->index) && scanner->container < scanner->index->nsizes) {
+                capacity = scanner->index->sizes[scanner->container++];
+            }
+            if(skScanner_peek(scanner).type == SK_LCURLY) {
+                node    = ObjectNode_new_sized(parent, scanner->pool, capacity);
+                closing = SK_RCURLY;
+            } else {
+                node    = ArrayNode_new_sized(parent, scanner->pool, capacity);
+                closing = SK_RBRACK;
+            }
+            break;
+        case SK_STRING:
+            return skparse_json_string(scanner, parent);
+        case SK_NUMBER:
+            return skparse_json_number(scanner, parent);
+        case SK_FALSE:
+        case SK_TRUE:
+            return skparse_json_bool(scanner, parent);
+        case SK_NULL:
+            return skparse_json_null(scanner, parent);
+        case SK_INVALID:
+        default:
+            return skparse_error(scanner, SK_PARSE_TOKEN, parent);
     }
 
-    do {
-        if(!start) {
-            skScanner_next(scanner);
-            skScanner_skip(scanner, 2, SK_WS, SK_NL);
-        } else {
-            start = false;
-        }
+    /* Return immediately if allocation failed. */
+    if(node.type == SK_NONE_NODE) {
+        return node;
+    }
 
-        temp = skJsonNode_parse(scanner, &array_node);
+    skScanner_next(scanner);
+    skScanner_skip(scanner, 2, SK_WS, SK_NL);
 
-        if(temp.type == SK_NONE_NODE) {
-            skJsonNode_drop(&array_node);
-            set_none(array_node);
-            return array_node;
-        } else if(temp.type == SK_ERROR_NODE) {
-            parse_err = err = true;
-            break;
-        }
+    /* Empty container is complete right away */
+    if(skScanner_peek(scanner).type == closing) {
+        skScanner_next(scanner);
+    } else {
+        *open = true;
+    }
 
-        if(!skVec_push(array_node.data.j_array, &temp)) {
-            skJsonNode_drop(&temp);
-            skJsonNode_drop(&array_node);
-            set_none(array_node);
-            return array_node;
-        }
+    return node;
+}
 
-        skScanner_skip(scanner, 2, SK_WS, SK_NL);
+/* Decodes the current string token into 'dst' which has room for the token
+ * and the terminator, decoded string is never longer than the escaped one.
+ * 'dst' can be the token itself, in situ strings are decoded in place and
+ * terminated at most over the closing quote. */
+static bool skJsonString_decode(skScanner* scanner, char* dst, skJson* err)
+{
+    size_t     len;
+    skStrSlice slice;
 
-    } while((token = skScanner_peek(scanner)).type == SK_COMMA);
+    slice = scanner->token.lexeme;
 
-    /* Return ErrorNode if err occured or array isn't enclosed by ']' */
-    if(err || token.type != SK_RBRACK) {
-        skJsonNode_drop(&array_node);
-        if(parse_err) {
-            return temp;
-        } else {
-            return ErrorNode_new("failed parsing Json Array", scanner->iter.state, parent);
+    /* Most strings have no escapes, copy them at once */
+    if(is_null(memchr(slice.ptr, '\\', slice.len))) {
+        if(dst != slice.ptr) {
+            memcpy(dst, slice.ptr, slice.len);
         }
+        len = slice.len;
+    } else if((len = skUtf8_unescape(dst, slice.ptr, slice.len)) == (size_t) -1) {
+        *err = skparse_error(scanner, SK_PARSE_STRING, NULL);
+        return false;
     }
 
-    skScanner_next(scanner);
-    skScanner_skip(scanner, 2, SK_WS, SK_NL);
-#ifdef SK_DBUG
-    assert(is_some(array_node.data.j_array));
-    assert(skVec_len(array_node.data.j_array) > 0);
-#endif
-    return array_node;
+    dst[len] = '\0';
+    return true;
 }
 
 skJsonString skJsonString_new_internal(skScanner* scanner, skJson* err)
 {
-    size_t       bytes;
     skJsonString jstring;
     skStrSlice   slice;
 
@@ -260,73 +305,35 @@ skJsonString skJsonString_new_internal(skScanner* scanner, skJson* err)
     slice   = scanner->token.lexeme;
 
     if(slice.len > 0 && !skJsonString_isvalid(&slice)) {
-        *err = ErrorNode_new("Invalid Json String\n", scanner->iter.state, NULL);
+        *err = skparse_error(scanner, SK_PARSE_STRING, NULL);
         return NULL;
     }
 
-    bytes = slice.len + 1;
-    if(is_null((jstring = malloc(bytes)))) {
+    if(scanner->insitu) {
+        jstring = slice.ptr;
+    } else if(is_some(scanner->pool)) {
+        jstring = skPool_alloc(scanner->pool, slice.len + 1);
+    } else if(is_null(jstring = malloc(slice.len + 1))) {
 #ifdef SK_ERRMSG
         THROW_ERR(OutOfMemory);
 #endif
+    }
+
+    if(is_null(jstring)) {
+        return NULL;
+    }
+
+    if(!skJsonString_decode(scanner, jstring, err)) {
+        skparse_free(scanner, jstring);
         return NULL;
     }
 
-    jstring            = strncpy(jstring, slice.ptr, slice.len);
-    jstring[slice.len] = '\0';
     return jstring;
 }
 
 bool skJsonString_isvalid(const skStrSlice* slice)
 {
-    /* Number of hexadecimal code points for UTF-16 encoding */
-    static const unsigned char UNIC_HEX_UTF16_CODES = 4;
-
-    skCharIter iterator;
-    int        c, count;
-    bool       hex;
-
-    hex      = false;
-    iterator = skCharIter_from_slice(discard_const(slice));
-
-    while((c = skCharIter_next(&iterator)) != EOF) {
-        if(c < 020) {
-            return false;
-        }
-
-        /* Check if the hex value is valid if flag is set */
-        for(count = 0; hex && count < UNIC_HEX_UTF16_CODES; count++) {
-            if(!isxdigit(c)) {
-                return false;
-            }
-        }
-
-        hex = false;
-
-        if(c == '\\') {
-            c = skCharIter_next(&iterator);
-
-            switch(c) {
-                case '\\':
-                case '"':
-                case '/':
-                case 'b':
-                case 'f':
-                case 'n':
-                case 'r':
-                case 't':
-                    break;
-                case 'u':
-                    hex = true;
-                    break;
-                default:
-                    return false;
-                    break;
-            }
-        }
-    }
-
-    return true;
+    return skUtf8_isvalid_json(slice->ptr, slice->len);
 }
 
 skJson skparse_json_string(skScanner* scanner, skJson* parent)
@@ -337,6 +344,23 @@ skJson skparse_json_string(skScanner* scanner, skJson* parent)
 
     set_none(string_node);
     set_none(err_node);
+
+    /* Short strings are decoded right into the node, nothing to allocate */
+    if(!scanner->insitu && scanner->token.lexeme.len <= SK_NODE_INLINE_MAX) {
+        if(scanner->token.lexeme.len > 0 && !skJsonString_isvalid(&scanner->token.lexeme)) {
+            return skparse_error(scanner, SK_PARSE_STRING, NULL);
+        }
+
+        string_node = RawNode_new(SK_STRING_NODE, parent);
+        if(!skJsonString_decode(scanner, Node_inline(&string_node), &err_node)) {
+            return err_node;
+        }
+        string_node.flags |= SK_NODE_INLINE_VALUE;
+
+        skScanner_next(scanner);
+        return string_node;
+    }
+
     jstring = skJsonString_new_internal(scanner, &err_node);
 
     if(err_node.type == SK_ERROR_NODE) {
@@ -345,107 +369,62 @@ skJson skparse_json_string(skScanner* scanner, skJson* parent)
         return string_node;
     }
 
-    string_node               = RawNode_new(SK_STRING_NODE, parent);
+    /* Strings borrowed from the buffer are references, just like the
+     * user provided ones they are not owned by the node. */
+    string_node = RawNode_new(scanner->insitu ? SK_REFERENCE_NODE : SK_STRING_NODE, parent);
     string_node.data.j_string = jstring;
 
     skScanner_next(scanner);
     return string_node;
 }
 
+/* Keeps the number as its text, in situ the text stays in the buffer unless
+ * the number ends the buffer and there is nothing that would terminate it */
+static skJson skparse_json_rawnum(skScanner* scanner, skJson* parent, const skStrSlice* lexeme)
+{
+    skJson node;
+
+    if(scanner->insitu && lexeme->ptr + lexeme->len <= scanner->iter.end) {
+        node                = RawNode_new(SK_RAWNUM_NODE, parent);
+        node.data.j_rawnum  = lexeme->ptr;
+        node.flags         |= SK_NODE_BORROWED_VALUE;
+        return node;
+    }
+
+    return RawNumNode_new(lexeme->ptr, lexeme->len, scanner->pool, parent);
+}
+
 skJson skparse_json_number(skScanner* scanner, skJson* parent)
 {
     skJsonInteger integ;
     skJsonDouble  dbl;
     skToken       token;
-    char*         start;
-    char*         end;
-    bool          negative;
-    bool          integer;
-    bool          fraction;
-
-    negative = false;
-    integer  = false;
-    fraction = false;
 
-    token = skScanner_peek(scanner);
-    /* Start of the number stream */
-    start = token.lexeme.ptr;
-
-    if(token.type == SK_HYPHEN) {
-        negative = true;
-        token    = skScanner_next(scanner);
-    }
-
-    if(token.type == SK_DIGIT || token.type == SK_ZERO) {
-        integer = true;
-
-        if(token.type == SK_ZERO) {
-            token = skScanner_next(scanner);
-            if(token.type == SK_DIGIT || token.type == SK_ZERO) {
-                goto jmp_err;
-            }
-        } else {
-            skScanner_skip(scanner, 2, SK_DIGIT, SK_ZERO);
-        }
-    } else if(negative) {
-        goto jmp_err;
+    /* Grammar was already validated by the scanner */
+    if((token = skScanner_peek(scanner)).type != SK_NUMBER) {
+        return skparse_error(scanner, SK_PARSE_NUMBER, parent);
     }
 
-    if(skScanner_peek(scanner).type == SK_DOT) {
-        if(!integer) {
-            goto jmp_err;
-        } else {
-            skScanner_next(scanner);
-        }
-
-        if((token = skScanner_peek(scanner)).type == SK_DIGIT || token.type == SK_ZERO) {
-            fraction = true;
-            skScanner_skip(scanner, 2, SK_DIGIT, SK_ZERO);
-        }
+    skScanner_next(scanner);
 
-        if(!fraction) {
-            goto jmp_err;
-        }
+    if(scanner->raw_numbers) {
+        return skparse_json_rawnum(scanner, parent, &token.lexeme);
     }
 
-    if(skScanner_peek(scanner).type == SK_EXP) {
-        if(!fraction) {
-            goto jmp_err;
-        }
-
-        if((token = skScanner_next(scanner)).type != SK_HYPHEN && token.type != SK_PLUS) {
-            goto jmp_err;
-        }
-
-        if((token = skScanner_next(scanner)).type == SK_DIGIT || token.type == SK_ZERO) {
-            skScanner_skip(scanner, 2, SK_DIGIT, SK_ZERO);
-        } else {
-            goto jmp_err;
-        }
+    if(skNumber_to_integer(&token.number, &integ)) {
+        return IntNode_new(integ, parent);
     }
 
-    /* End of number stream. */
-    end = skScanner_peek(scanner).lexeme.ptr;
-
-    errno = 0;
-    if(fraction) {
-        dbl = strtod(start, &end);
-        if(errno == ERANGE) {
-            THROW_WARN(OverflowDetected, scanner);
-            dbl = DBL_MAX;
-        }
-        return DoubleNode_new(dbl, parent);
-    } else {
-        integ = strtol(start, &end, 10);
-        if(errno == ERANGE) {
-            THROW_WARN(OverflowDetected, scanner);
-            integ = INT_MAX;
-        }
-        return IntNode_new(integ, parent);
+    /* Integers out of range of 'long' are kept as the nearest double */
+    dbl = skNumber_to_double(&token.number, &token.lexeme);
+    if(dbl > DBL_MAX || dbl < -DBL_MAX) {
+#ifdef SK_ERRMSG
+        THROW_WARN(OverflowDetected, scanner->origin + (token.lexeme.ptr - scanner->base));
+#endif
+        dbl = (dbl < 0) ? -DBL_MAX : DBL_MAX;
     }
 
-jmp_err:
-    return ErrorNode_new("failed to parse Json Number", scanner->iter.state, parent);
+    return DoubleNode_new(dbl, parent);
 }
 
 skJson skparse_json_bool(skScanner* scanner, skJson* parent)
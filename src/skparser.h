@@ -5,8 +5,35 @@
 #include "skscanner.h"
 #include "skslice.h"
 
+/* Maximum nesting depth of Json arrays and objects, deeper documents are
+ * rejected with an error instead of exhausting the memory. */
+#ifndef SK_MAX_DEPTH
+#define SK_MAX_DEPTH 1024
+#endif
+
+/* Error messages of the parser, one for each 'skParseError' */
+#define SK_TOKEN_ERR "Invalid syntax/token while parsing"
+#define SK_OBJECT_ERR "failed parsing Json Object"
+#define SK_ARRAY_ERR "failed parsing Json Array"
+#define SK_DEPTH_ERR "maximum nesting depth exceeded"
+#define SK_STRING_ERR "Invalid Json String"
+#define SK_NUMBER_ERR "failed to parse Json Number"
+
+/* Error node of 'code' at the current token of the 'scanner' */
+#define skparse_error(scanner, code, parent)                                  \
+  ErrorNode_new((code), skScanner_offset(scanner), (scanner)->depth, (parent))
+
 bool skJsonString_isvalid(const skStrSlice *slice);
 
 skJson skJsonNode_parse(skScanner *scanner, skJson *parent);
 
+/* Copies the current string token, sets ERR_NODE if it is not valid */
+skJsonString skJsonString_new_internal(skScanner *scanner, skJson *err_node);
+
+/* Parse the scalar at the current token and advance the scanner past it */
+skJson skparse_json_string(skScanner *scanner, skJson *parent);
+skJson skparse_json_number(skScanner *scanner, skJson *parent);
+skJson skparse_json_bool(skScanner *scanner, skJson *parent);
+skJson skparse_json_null(skScanner *scanner, skJson *parent);
+
 #endif
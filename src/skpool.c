@@ -0,0 +1,171 @@
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+#include "skerror.h"
+#include "skpool.h"
+#include "skutils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Chunks stop growing once they reach this size */
+#define MAX_CHUNK_SIZE (1024 * 1024)
+#define MIN_CHUNK_SIZE 1024
+
+/* Type with the strictest alignment we care about */
+typedef union {
+    void*  ptr;
+    long   l;
+    double d;
+} skMaxAlign;
+
+#define ALIGNMENT        sizeof(skMaxAlign)
+#define align_up(size)   (((size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1))
+
+/* Chunk header, data follows right after it */
+struct skPoolChunk {
+    skPoolChunk* next;
+    size_t       size;
+    size_t       used;
+    skMaxAlign   data[1];
+};
+
+#define CHUNK_HEADER_SIZE offsetof(skPoolChunk, data)
+
+skPool* skPool_new(size_t chunk_size)
+{
+    skPool* pool;
+
+    if(is_null(pool = malloc(sizeof(skPool)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return NULL;
+    }
+
+    pool->head       = NULL;
+    pool->chunk_size = (chunk_size < MIN_CHUNK_SIZE) ? MIN_CHUNK_SIZE : chunk_size;
+
+    return pool;
+}
+
+static skPoolChunk* skPoolChunk_new(size_t size)
+{
+    skPoolChunk* chunk;
+
+    if(is_null(chunk = malloc(CHUNK_HEADER_SIZE + size))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+
+    return chunk;
+}
+
+void* skPool_alloc(skPool* pool, size_t size)
+{
+    skPoolChunk* chunk;
+    void*        mem;
+
+#ifdef SK_DBUG
+    assert(is_some(pool));
+#endif
+
+    size  = align_up(size);
+    chunk = pool->head;
+
+    if(is_null(chunk) || chunk->size - chunk->used < size) {
+        if(size > pool->chunk_size && is_some(chunk)) {
+            /* Large allocation gets a chunk of its own, the current
+             * chunk still has room for the smaller ones. */
+            if(is_null(chunk = skPoolChunk_new(size))) {
+                return NULL;
+            }
+            chunk->next      = pool->head->next;
+            pool->head->next = chunk;
+        } else {
+            if(is_null(chunk = skPoolChunk_new((size > pool->chunk_size) ? size : pool->chunk_size))) {
+                return NULL;
+            }
+            chunk->next = pool->head;
+            pool->head  = chunk;
+
+            /* Geometric growth keeps the number of chunks logarithmic */
+            if(pool->chunk_size < MAX_CHUNK_SIZE) {
+                pool->chunk_size *= 2;
+            }
+        }
+    }
+
+    mem = (unsigned char*) chunk->data + chunk->used;
+    chunk->used += size;
+
+    return mem;
+}
+
+char* skPool_strndup(skPool* pool, const char* str, size_t len)
+{
+    char* dup;
+
+    if(is_null(dup = skPool_alloc(pool, len + 1))) {
+        return NULL;
+    }
+
+    memcpy(dup, str, len);
+    dup[len] = '\0';
+
+    return dup;
+}
+
+void skPool_reset(skPool* pool)
+{
+    skPoolChunk* chunk;
+    skPoolChunk* next;
+    skPoolChunk* keep;
+
+#ifdef SK_DBUG
+    assert(is_some(pool));
+#endif
+
+    keep = pool->head;
+    for(chunk = pool->head; is_some(chunk); chunk = chunk->next) {
+        if(chunk->size > keep->size) {
+            keep = chunk;
+        }
+    }
+
+    for(chunk = pool->head; is_some(chunk); chunk = next) {
+        next = chunk->next;
+        if(chunk != keep) {
+            free(chunk);
+        }
+    }
+
+    if(is_some(keep)) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+
+    pool->head = keep;
+}
+
+void skPool_drop(skPool* pool)
+{
+    skPoolChunk* chunk;
+    skPoolChunk* next;
+
+    if(is_null(pool)) {
+        return;
+    }
+
+    for(chunk = pool->head; is_some(chunk); chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+
+    free(pool);
+}
@@ -0,0 +1,49 @@
+#ifndef __SK_POOL_H__
+#define __SK_POOL_H__
+
+#include "sktypes.h"
+#include <stddef.h>
+
+typedef struct skPoolChunk skPoolChunk;
+
+/**
+ * Bump allocator, memory is handed out from large chunks and is
+ * never freed individually. Dropping the pool frees all of its
+ * chunks at once.
+ */
+typedef struct skPool {
+  skPoolChunk *head; /* Chunk we are currently allocating from */
+  size_t chunk_size; /* Size of the next chunk */
+} skPool;
+
+/**
+ * Creates a new pool, first chunk is allocated lazily and holds at
+ * least CHUNK_SIZE bytes. Returns NULL if allocation failed.
+ */
+skPool *skPool_new(size_t chunk_size);
+
+/**
+ * Returns SIZE bytes of memory suitably aligned for any type or NULL
+ * if allocation failed. Memory is not initialized.
+ */
+void *skPool_alloc(skPool *pool, size_t size);
+
+/**
+ * Copies LEN bytes of STR into the POOL and nul terminates the copy.
+ * Returns NULL if allocation failed.
+ */
+char *skPool_strndup(skPool *pool, const char *str, size_t len);
+
+/**
+ * Invalidates all memory handed out by the POOL so it can be reused.
+ * Only the largest chunk is kept, in the steady state that is the only
+ * chunk and nothing gets freed or allocated.
+ */
+void skPool_reset(skPool *pool);
+
+/**
+ * Frees all chunks of the POOL and the POOL itself.
+ */
+void skPool_drop(skPool *pool);
+
+#endif
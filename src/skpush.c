@@ -0,0 +1,649 @@
+/* clang-format off */
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+#include "skerror.h"
+#include "skparser.h" /* Make sure skparser.h which includes sknode.h is included before skjson.h */
+#include "skjson.h"
+#include "skutils.h"
+#include <stdlib.h>
+#include <string.h>
+/* clang-format on */
+
+/* Bytes of the token at the end of the chunk that could not be completed yet
+ * are kept until the next chunk, tokens that are shorter than the longest
+ * literal ("false") might still turn out valid. */
+#define LITERAL_MAX 5
+
+/* What the parser expects to see next */
+typedef enum {
+    SK_EXPECT_ROOT,
+    SK_EXPECT_VALUE,
+    SK_EXPECT_VALUE_OR_CLOSE, /* First element of the array or ']' */
+    SK_EXPECT_KEY,
+    SK_EXPECT_KEY_OR_CLOSE, /* First key of the object or '}' */
+    SK_EXPECT_COLON,
+    SK_EXPECT_NEXT, /* ',' or the end of the container */
+    SK_EXPECT_DONE, /* Root is complete, rest of the input is ignored */
+    SK_EXPECT_ERROR /* Root holds the error (or none if allocation failed) */
+} skExpect;
+
+/* Incremental parser, the tree is built as the tokens arrive the same way
+ * 'skJsonNode_parse' builds it. Only the token that got split between
+ * the chunks is buffered. */
+struct skJsonParser {
+    skJson      root;
+    skJson*     top;   /* Container being filled, NULL before the root is opened */
+    skVec*      stack; /* Parents of 'top' */
+    char*       key;   /* Key of the member whose value is expected */
+    skExpect    expect;
+    char*       carry; /* Incomplete token from the previous chunk */
+    size_t      carry_len;
+    size_t      carry_cap;
+    bool        carry_escape; /* String in the carry ends with an unfinished escape */
+    size_t      origin; /* Offset of 'carry' in the document */
+    bool        fed;
+    /* Scratch state kept between the documents, nothing of it is
+     * allocated again once it is large enough */
+    skScanner     scanner;
+    skStructIndex index;
+    skPool*       pool;       /* Arena of 'skJsonParser_parse_arena', created lazily */
+    skJson        arena_root; /* Last document parsed into the arena */
+};
+
+/* Nesting depth of the next token, same as the scanner depth in 'skJsonNode_parse' */
+#define skJsonParser_depth(parser) (is_some((parser)->top) ? skVec_len((parser)->stack) + 2 : 1)
+
+static void skJsonParser_reset(skJsonParser* parser)
+{
+    skVec_clear(parser->stack, NULL);
+    free(parser->key);
+    parser->root.type    = SK_NONE_NODE;
+    parser->top          = NULL;
+    parser->key          = NULL;
+    parser->expect       = SK_EXPECT_ROOT;
+    parser->carry_len    = 0;
+    parser->carry_escape = false;
+    parser->origin       = 0;
+    parser->fed          = false;
+}
+
+PUBLIC(skJsonParser*) skJsonParser_new(void)
+{
+    skJsonParser* parser;
+
+    if(is_null(parser = malloc(sizeof(skJsonParser)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return NULL;
+    }
+
+    if(is_null(parser->stack = skVec_new(sizeof(skJson*)))) {
+        free(parser);
+        return NULL;
+    }
+
+    parser->key             = NULL;
+    parser->carry           = NULL;
+    parser->carry_cap       = 0;
+    parser->pool            = NULL;
+    parser->arena_root.type = SK_NONE_NODE;
+    skStructIndex_init(&parser->index);
+    skJsonParser_reset(parser);
+
+    return parser;
+}
+
+/* Drops the last document parsed into the arena, arena memory is reused */
+static void skJsonParser_arena_reset(skJsonParser* parser)
+{
+    /* Whole document is in the arena */
+    parser->arena_root.type = SK_NONE_NODE;
+
+    if(is_some(parser->pool)) {
+        skPool_reset(parser->pool);
+    }
+}
+
+/* Rebuilds the index of 'buff' and points the scanner of the 'parser' at it,
+ * returns NULL if allocation failed */
+static skScanner* skJsonParser_scanner(skJsonParser* parser, char* buff, size_t len)
+{
+    if(!skStructIndex_build(&parser->index, buff, len)) {
+        return NULL;
+    }
+
+    skScanner_init(&parser->scanner, buff, len);
+    parser->scanner.index = &parser->index;
+
+    return &parser->scanner;
+}
+
+PUBLIC(void) skJsonParser_drop(skJsonParser* parser)
+{
+    if(is_null(parser)) {
+        return;
+    }
+
+    if(parser->root.type != SK_NONE_NODE) {
+        skJsonNode_drop(&parser->root);
+    }
+
+    skJsonParser_arena_reset(parser);
+    skPool_drop(parser->pool);
+    skStructIndex_release(&parser->index);
+    free(parser->key);
+    free(parser->carry);
+    skVec_drop(parser->stack, NULL);
+    free(parser);
+}
+
+/* Replaces whatever was parsed with 'err' node or none if 'err' is NULL */
+static void skJsonParser_fail(skJsonParser* parser, skJson* err)
+{
+    if(parser->root.type != SK_NONE_NODE) {
+        skJsonNode_drop(&parser->root);
+    }
+
+    if(is_some(err)) {
+        parser->root = *err;
+        /* Error node takes the place of the dropped root */
+        parser->root.flags &= ~SK_NODE_LINKED;
+    } else {
+        parser->root.type = SK_NONE_NODE;
+    }
+
+    parser->expect = SK_EXPECT_ERROR;
+}
+
+/* Fails with the error 'code' at the current token of the 'scanner' */
+static void skJsonParser_error(skJsonParser* parser, skScanner* scanner, skParseError code)
+{
+    skJson err;
+
+    free(parser->key);
+    parser->key = NULL;
+
+    err = skparse_error(scanner, code, NULL);
+    skJsonParser_fail(parser, &err);
+}
+
+/* Checks if the current token is complete, tokens without the terminator
+ * that end at the end of the chunk might continue in the next one. */
+static bool skJsonParser_token_complete(const skScanner* scanner)
+{
+    switch(scanner->token.type) {
+        case SK_NUMBER:
+        case SK_TRUE:
+        case SK_FALSE:
+        case SK_NULL:
+        case SK_WS:
+        case SK_NL:
+            return is_some(scanner->iter.next);
+        case SK_INVALID:
+            return is_some(scanner->iter.next)
+                   && scanner->iter.end - scanner->token_start + 1 >= LITERAL_MAX;
+        default:
+            return true;
+    }
+}
+
+/* Links the parsed 'value' into the 'top' container or makes it the root.
+ * Returns the address the value ended up at or NULL if allocation failed. */
+static skJson* skJsonParser_attach(skJsonParser* parser, skJson* value)
+{
+    skObjTuple tuple;
+    skJson*    top;
+
+    top = parser->top;
+
+    if(is_null(top)) {
+        parser->root = *value;
+        return &parser->root;
+    }
+
+    if(top->type == SK_ARRAY_NODE) {
+        if(!skVec_push(top->data.j_array, value)) {
+            skJsonNode_drop(value);
+            return NULL;
+        }
+        return skVec_back(top->data.j_array);
+    }
+
+    tuple.key   = parser->key;
+    tuple.value = *value;
+    parser->key = NULL;
+
+    if(!skVec_push(top->data.j_object, &tuple)) {
+        skObjTuple_drop(&tuple);
+        return NULL;
+    }
+
+    return &((skObjTuple*) skVec_back(top->data.j_object))->value;
+}
+
+/* Closes the 'top' container, the current token is its closing bracket */
+static void skJsonParser_close(skJsonParser* parser, skScanner* scanner)
+{
+    skScanner_next(scanner);
+
+    if(!skVec_pop(parser->stack, &parser->top)) {
+        /* Closed the root */
+        parser->top    = NULL;
+        parser->expect = SK_EXPECT_DONE;
+    } else {
+        parser->expect = SK_EXPECT_NEXT;
+    }
+}
+
+/* Parses the value at the current token, containers are only opened */
+static void skJsonParser_value(skJsonParser* parser, skScanner* scanner)
+{
+    skJson  value;
+    skJson* node;
+    size_t  depth;
+
+    switch(skScanner_peek(scanner).type) {
+        case SK_LCURLY:
+        case SK_LBRACK:
+            /* Root is at depth 1 */
+            depth = is_null(parser->top) ? 1 : skVec_len(parser->stack) + 2;
+            if(depth > SK_MAX_DEPTH) {
+                skJsonParser_error(parser, scanner, SK_PARSE_DEPTH);
+                return;
+            }
+            if(skScanner_peek(scanner).type == SK_LCURLY) {
+                value = ObjectNode_new(parser->top);
+            } else {
+                value = ArrayNode_new(parser->top);
+            }
+            if(value.type != SK_NONE_NODE) {
+                skScanner_next(scanner);
+            }
+            break;
+        case SK_STRING:
+            value = skparse_json_string(scanner, parser->top);
+            break;
+        case SK_NUMBER:
+            value = skparse_json_number(scanner, parser->top);
+            break;
+        case SK_FALSE:
+        case SK_TRUE:
+            value = skparse_json_bool(scanner, parser->top);
+            break;
+        case SK_NULL:
+            value = skparse_json_null(scanner, parser->top);
+            break;
+        default:
+            skJsonParser_error(parser, scanner, SK_PARSE_TOKEN);
+            return;
+    }
+
+    if(value.type == SK_ERROR_NODE) {
+        free(parser->key);
+        parser->key = NULL;
+        skJsonParser_fail(parser, &value);
+        return;
+    }
+
+    if(value.type == SK_NONE_NODE || is_null(node = skJsonParser_attach(parser, &value))) {
+        skJsonParser_fail(parser, NULL);
+        return;
+    }
+
+    if(node->type == SK_OBJECT_NODE || node->type == SK_ARRAY_NODE) {
+        if(is_some(parser->top) && !skVec_push(parser->stack, &parser->top)) {
+            skJsonParser_fail(parser, NULL);
+            return;
+        }
+        parser->top    = node;
+        parser->expect = (node->type == SK_OBJECT_NODE) ? SK_EXPECT_KEY_OR_CLOSE
+                                                        : SK_EXPECT_VALUE_OR_CLOSE;
+    } else {
+        parser->expect = is_null(parser->top) ? SK_EXPECT_DONE : SK_EXPECT_NEXT;
+    }
+}
+
+/* Consumes the current (complete) token */
+static void skJsonParser_step(skJsonParser* parser, skScanner* scanner)
+{
+    skToken token;
+    skJson  err;
+
+    token = skScanner_peek(scanner);
+
+    switch(parser->expect) {
+        case SK_EXPECT_VALUE_OR_CLOSE:
+            if(token.type == SK_RBRACK) {
+                skJsonParser_close(parser, scanner);
+                break;
+            }
+            skJsonParser_value(parser, scanner);
+            break;
+        case SK_EXPECT_ROOT:
+        case SK_EXPECT_VALUE:
+            skJsonParser_value(parser, scanner);
+            break;
+        case SK_EXPECT_KEY_OR_CLOSE:
+            if(token.type == SK_RCURLY) {
+                skJsonParser_close(parser, scanner);
+                break;
+            }
+            /* fall through */
+        case SK_EXPECT_KEY:
+            if(token.type != SK_STRING) {
+                skJsonParser_error(parser, scanner, SK_PARSE_OBJECT);
+                break;
+            }
+            err.type    = SK_NONE_NODE;
+            parser->key = skJsonString_new_internal(scanner, &err);
+            if(err.type == SK_ERROR_NODE) {
+                skJsonParser_fail(parser, &err);
+            } else if(is_null(parser->key)) {
+                skJsonParser_fail(parser, NULL);
+            } else {
+                skScanner_next(scanner);
+                parser->expect = SK_EXPECT_COLON;
+            }
+            break;
+        case SK_EXPECT_COLON:
+            if(token.type != SK_COLON) {
+                skJsonParser_error(parser, scanner, SK_PARSE_OBJECT);
+                break;
+            }
+            skScanner_next(scanner);
+            parser->expect = SK_EXPECT_VALUE;
+            break;
+        case SK_EXPECT_NEXT:
+            if(token.type == SK_COMMA) {
+                skScanner_next(scanner);
+                parser->expect = (parser->top->type == SK_OBJECT_NODE) ? SK_EXPECT_KEY
+                                                                       : SK_EXPECT_VALUE;
+            } else if(parser->top->type == SK_OBJECT_NODE) {
+                if(token.type == SK_RCURLY) {
+                    skJsonParser_close(parser, scanner);
+                } else {
+                    skJsonParser_error(parser, scanner, SK_PARSE_OBJECT);
+                }
+            } else {
+                if(token.type == SK_RBRACK) {
+                    skJsonParser_close(parser, scanner);
+                } else {
+                    skJsonParser_error(parser, scanner, SK_PARSE_ARRAY);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Makes sure the carry can hold 'len' bytes */
+static bool skJsonParser_reserve(skJsonParser* parser, size_t len)
+{
+    char*  carry;
+    size_t cap;
+
+    if(parser->carry_cap >= len) {
+        return true;
+    }
+
+    cap = (parser->carry_cap == 0) ? 64 : parser->carry_cap * 2;
+    while(cap < len) {
+        cap *= 2;
+    }
+
+    if(is_null(carry = realloc(parser->carry, cap))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return false;
+    }
+
+    parser->carry     = carry;
+    parser->carry_cap = cap;
+    return true;
+}
+
+/* Parses all complete tokens of 'window', if 'last' is set then the
+ * 'window' is the end of the document and every token is complete. */
+static bool skJsonParser_run(skJsonParser* parser, char* window, size_t len, bool last)
+{
+    skScanner*  scanner;
+    skTokenType type;
+    char*       rest;
+
+    if(is_null(scanner = skJsonParser_scanner(parser, window, len))) {
+        skJsonParser_fail(parser, NULL);
+        return false;
+    }
+
+    scanner->origin = parser->origin;
+    rest            = window + len;
+    skScanner_next(scanner);
+
+    while(parser->expect != SK_EXPECT_DONE && parser->expect != SK_EXPECT_ERROR) {
+        type = skScanner_peek(scanner).type;
+
+        /* Same as 'skJson_parse' the document can't start with whitespace */
+        if((type == SK_WS || type == SK_NL) && parser->expect != SK_EXPECT_ROOT) {
+            skScanner_next(scanner);
+            continue;
+        }
+
+        if(!last && type == SK_EOF) {
+            break;
+        } else if(!last && !skJsonParser_token_complete(scanner)) {
+            rest = scanner->token_start;
+            break;
+        }
+
+        scanner->depth = skJsonParser_depth(parser);
+        skJsonParser_step(parser, scanner);
+    }
+
+    if(parser->expect == SK_EXPECT_DONE || parser->expect == SK_EXPECT_ERROR) {
+        rest = window + len;
+    }
+
+    parser->origin += rest - window;
+
+    /* Window is either the chunk or the carry itself which is large enough */
+    if(!skJsonParser_reserve(parser, window + len - rest)) {
+        skJsonParser_fail(parser, NULL);
+        return false;
+    }
+
+    if((parser->carry_len = window + len - rest) > 0) {
+        memmove(parser->carry, rest, parser->carry_len);
+    }
+
+    /* Odd run of backslashes at the end of a carried string escapes the next byte */
+    parser->carry_escape = false;
+    if(parser->carry_len > 0 && parser->carry[0] == '"') {
+        rest = parser->carry + parser->carry_len - 1;
+        for(; rest > parser->carry && *rest == '\\'; rest--) {
+            parser->carry_escape = !parser->carry_escape;
+        }
+    }
+
+    return parser->expect != SK_EXPECT_ERROR;
+}
+
+/* Checks if the token in the carry continues over the whole 'chunk', then the
+ * chunk is only appended to the carry and the token is scanned once it is
+ * complete instead of on every chunk. Covers the tokens that get long: strings
+ * (until the closing quote) and numbers (digits always extend the number). */
+static bool skJsonParser_carry_continues(skJsonParser* parser, const char* chunk, size_t len)
+{
+    bool   escape;
+    size_t i;
+
+    if(parser->carry[0] == '"') {
+        escape = parser->carry_escape;
+        for(i = 0; i < len; i++) {
+            if(escape) {
+                escape = false;
+            } else if(chunk[i] == '\\') {
+                escape = true;
+            } else if(chunk[i] == '"') {
+                return false;
+            }
+        }
+        parser->carry_escape = escape;
+        return true;
+    }
+
+    if(parser->carry[0] == '-' || (unsigned) (parser->carry[0] - '0') < 10) {
+        for(i = 0; i < len; i++) {
+            if((unsigned) (chunk[i] - '0') >= 10) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+PUBLIC(skJsonBool) skJsonParser_feed(skJsonParser* parser, const char* chunk, size_t len)
+{
+    bool continues;
+
+    if(is_null(parser) || parser->expect == SK_EXPECT_ERROR) {
+        return false;
+    }
+
+    if(is_null(chunk) || len == 0 || parser->expect == SK_EXPECT_DONE) {
+        return true;
+    }
+
+    parser->fed = true;
+
+    /* Nothing was left over, scan the chunk directly */
+    if(parser->carry_len == 0) {
+        return skJsonParser_run(parser, discard_const(chunk), len, false);
+    }
+
+    if(!skJsonParser_reserve(parser, parser->carry_len + len)) {
+        skJsonParser_fail(parser, NULL);
+        return false;
+    }
+
+    continues = skJsonParser_carry_continues(parser, chunk, len);
+    memcpy(parser->carry + parser->carry_len, chunk, len);
+    parser->carry_len += len;
+
+    if(continues) {
+        return true;
+    }
+
+    return skJsonParser_run(parser, parser->carry, parser->carry_len, false);
+}
+
+PUBLIC(skJson) skJsonParser_finish(skJsonParser* parser)
+{
+    skJson       json;
+    skJson       err;
+    skParseError code;
+
+    json.type = SK_NONE_NODE;
+
+    if(is_null(parser)) {
+        return json;
+    }
+
+    if(parser->carry_len > 0) {
+        skJsonParser_run(parser, parser->carry, parser->carry_len, true);
+    }
+
+    /* Document ended while more was expected */
+    if(parser->fed && parser->expect != SK_EXPECT_DONE && parser->expect != SK_EXPECT_ERROR) {
+        switch(parser->expect) {
+            case SK_EXPECT_KEY:
+            case SK_EXPECT_KEY_OR_CLOSE:
+            case SK_EXPECT_COLON:
+                code = SK_PARSE_OBJECT;
+                break;
+            case SK_EXPECT_NEXT:
+                code = (parser->top->type == SK_OBJECT_NODE) ? SK_PARSE_OBJECT : SK_PARSE_ARRAY;
+                break;
+            default:
+                code = SK_PARSE_TOKEN;
+                break;
+        }
+        err = ErrorNode_new(code, parser->origin, skJsonParser_depth(parser), NULL);
+        skJsonParser_fail(parser, &err);
+    }
+
+    json              = parser->root;
+    parser->root.type = SK_NONE_NODE;
+    skJsonParser_reset(parser);
+
+    return json;
+}
+
+/* Parses the whole 'buff' with the scratch state of the 'parser', 'pool' is
+ * the arena of the tree or NULL if it is allocated on the heap */
+static skJson skJsonParser_parse_in(skJsonParser* parser, char* buff, size_t bufsize, skPool* pool)
+{
+    skScanner* scanner;
+    skJson     json;
+
+    json.type = SK_NONE_NODE;
+
+    /* Unfinished incremental document is abandoned */
+    if(parser->root.type != SK_NONE_NODE) {
+        skJsonNode_drop(&parser->root);
+    }
+    skJsonParser_reset(parser);
+
+    if(is_null(scanner = skJsonParser_scanner(parser, buff, bufsize))) {
+        return json;
+    }
+
+    scanner->stack = parser->stack;
+    scanner->pool  = pool;
+
+    /* Fetch first token */
+    skScanner_next(scanner);
+    /* Construct the parse tree */
+    return skJsonNode_parse(scanner, NULL);
+}
+
+PUBLIC(skJson) skJsonParser_parse(skJsonParser* parser, char* buff, size_t bufsize)
+{
+    skJson json;
+
+    if(is_null(parser) || is_null(buff) || bufsize == 0) {
+        json.type = SK_NONE_NODE;
+        return json;
+    }
+
+    return skJsonParser_parse_in(parser, buff, bufsize, NULL);
+}
+
+PUBLIC(skJson*) skJsonParser_parse_arena(skJsonParser* parser, char* buff, size_t bufsize)
+{
+    if(is_null(parser) || is_null(buff) || bufsize == 0) {
+        return NULL;
+    }
+
+    skJsonParser_arena_reset(parser);
+
+    /* Same estimate as 'skJson_parse_arena', the arena grows with the documents */
+    if(is_null(parser->pool) && is_null(parser->pool = skPool_new(bufsize * 2))) {
+        return NULL;
+    }
+
+    parser->arena_root = skJsonParser_parse_in(parser, buff, bufsize, parser->pool);
+
+    if(parser->arena_root.type == SK_NONE_NODE) {
+        return NULL;
+    }
+
+    parser->arena_root.flags |= SK_NODE_POOLED;
+
+    return &parser->arena_root;
+}
@@ -0,0 +1,190 @@
+/* clang-format off */
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+#include "skerror.h"
+#include "skparser.h" /* Make sure skparser.h which includes sknode.h is included before skjson.h */
+#include "skjson.h"
+#include "skutils.h"
+#include <limits.h>
+/* clang-format on */
+
+/* Emits the event if the callback is set, returns from the driver if the callback aborted */
+#define sax_emit(sax, event, args)                                          \
+    do {                                                                    \
+        if(is_some(sax) && is_some((sax)->event) && !(sax)->event args) { \
+            return SKJS_SAX_ABORTED;                                        \
+        }                                                                   \
+    } while(0)
+
+/* Bit set of the open containers, bit is set if the container is an object */
+#define in_object(objects, depth) ((objects)[(depth) / CHAR_BIT] & (1 << ((depth) % CHAR_BIT)))
+
+/* What the driver expects to see next */
+typedef enum {
+    SAX_VALUE,
+    SAX_VALUE_OR_CLOSE, /* First element of the array or ']' */
+    SAX_KEY,
+    SAX_KEY_OR_CLOSE, /* First key of the object or '}' */
+    SAX_COLON,
+    SAX_NEXT, /* ',' or the end of the container */
+    SAX_DONE  /* Only whitespace can follow the root */
+} skSaxExpect;
+
+/* Drives the 'scanner' through the whole document firing the events of 'sax'.
+ * Nothing is allocated, open containers are tracked in a bit set on the stack. */
+static int skSax_run(skScanner* scanner, const skJsonSax* sax, void* ctx)
+{
+    unsigned char objects[SK_MAX_DEPTH / CHAR_BIT + 1];
+    skSaxExpect   expect;
+    skToken       token;
+    size_t        depth;
+
+    depth  = 0;
+    expect = SAX_VALUE;
+    skScanner_next(scanner);
+
+    for(;;) {
+        token = skScanner_peek(scanner);
+
+        switch(token.type) {
+            case SK_WS:
+            case SK_NL:
+                skScanner_next(scanner);
+                continue;
+            case SK_EOF:
+                return (expect == SAX_DONE) ? SKJS_SAX_OK : SKJS_SAX_INVALID;
+            default:
+                break;
+        }
+
+        switch(expect) {
+            case SAX_VALUE_OR_CLOSE:
+                if(token.type == SK_RBRACK) {
+                    goto close;
+                }
+                /* fall through */
+            case SAX_VALUE:
+                switch(token.type) {
+                    case SK_LCURLY:
+                    case SK_LBRACK:
+                        if(depth == SK_MAX_DEPTH) {
+                            return SKJS_SAX_INVALID;
+                        }
+                        if(token.type == SK_LCURLY) {
+                            objects[depth / CHAR_BIT] |= 1 << (depth % CHAR_BIT);
+                            sax_emit(sax, start_object, (ctx));
+                            expect = SAX_KEY_OR_CLOSE;
+                        } else {
+                            objects[depth / CHAR_BIT] &= ~(1 << (depth % CHAR_BIT));
+                            sax_emit(sax, start_array, (ctx));
+                            expect = SAX_VALUE_OR_CLOSE;
+                        }
+                        depth++;
+                        skScanner_next(scanner);
+                        continue;
+                    case SK_STRING:
+                        if(!skJsonString_isvalid(&token.lexeme)) {
+                            return SKJS_SAX_INVALID;
+                        }
+                        sax_emit(sax, string, (ctx, token.lexeme.ptr, token.lexeme.len));
+                        break;
+                    case SK_NUMBER:
+                        sax_emit(sax, number, (ctx, token.lexeme.ptr, token.lexeme.len));
+                        break;
+                    case SK_TRUE:
+                    case SK_FALSE:
+                        sax_emit(sax, boolean, (ctx, token.type == SK_TRUE));
+                        break;
+                    case SK_NULL:
+                        sax_emit(sax, null, (ctx));
+                        break;
+                    default:
+                        return SKJS_SAX_INVALID;
+                }
+                skScanner_next(scanner);
+                expect = (depth == 0) ? SAX_DONE : SAX_NEXT;
+                continue;
+            case SAX_KEY_OR_CLOSE:
+                if(token.type == SK_RCURLY) {
+                    goto close;
+                }
+                /* fall through */
+            case SAX_KEY:
+                if(token.type != SK_STRING || !skJsonString_isvalid(&token.lexeme)) {
+                    return SKJS_SAX_INVALID;
+                }
+                sax_emit(sax, key, (ctx, token.lexeme.ptr, token.lexeme.len));
+                skScanner_next(scanner);
+                expect = SAX_COLON;
+                continue;
+            case SAX_COLON:
+                if(token.type != SK_COLON) {
+                    return SKJS_SAX_INVALID;
+                }
+                skScanner_next(scanner);
+                expect = SAX_VALUE;
+                continue;
+            case SAX_NEXT:
+                if(token.type == SK_COMMA) {
+                    skScanner_next(scanner);
+                    expect = in_object(objects, depth - 1) ? SAX_KEY : SAX_VALUE;
+                    continue;
+                }
+                if(token.type == (in_object(objects, depth - 1) ? SK_RCURLY : SK_RBRACK)) {
+                    goto close;
+                }
+                return SKJS_SAX_INVALID;
+            case SAX_DONE:
+            default:
+                return SKJS_SAX_INVALID;
+        }
+
+    close:
+        depth--;
+        if(in_object(objects, depth)) {
+            sax_emit(sax, end_object, (ctx));
+        } else {
+            sax_emit(sax, end_array, (ctx));
+        }
+        skScanner_next(scanner);
+        expect = (depth == 0) ? SAX_DONE : SAX_NEXT;
+    }
+}
+
+PUBLIC(int) skJson_sax_parse(const char* buff, size_t bufsize, const skJsonSax* sax, void* ctx)
+{
+    skScanner scanner;
+
+    if(is_null(buff) || bufsize == 0) {
+        return SKJS_SAX_INVALID;
+    }
+
+    skScanner_init(&scanner, discard_const(buff), bufsize);
+    return skSax_run(&scanner, sax, ctx);
+}
+
+PUBLIC(skJsonBool) skJson_validate(const char* buff, size_t bufsize, size_t* err_offset)
+{
+    skScanner scanner;
+
+    if(is_null(buff) || bufsize == 0) {
+        if(is_some(err_offset)) {
+            *err_offset = 0;
+        }
+        return false;
+    }
+
+    skScanner_init(&scanner, discard_const(buff), bufsize);
+    if(skSax_run(&scanner, NULL, NULL) == SKJS_SAX_OK) {
+        return true;
+    }
+
+    /* Driver stops right at the offending token, there is none if the input ended early */
+    if(is_some(err_offset)) {
+        *err_offset = is_some(scanner.token_start) ? (size_t) (scanner.token_start - scanner.base)
+                                                   : bufsize;
+    }
+
+    return false;
+}
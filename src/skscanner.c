@@ -14,6 +14,13 @@
 /* clang-format on */
 
 #define in_iter_bounds(iter, bound) ((iter)->end >= (bound))
+/* Check if 'ptr' is within 'end' (inclusive) and points to a decimal digit */
+#define is_digit_at(ptr, end)       ((ptr) <= (end) && (unsigned) (*(ptr) - '0') < 10)
+/* Largest mantissa that can take one more digit without overflowing */
+#define MANTISSA_LIMIT              ((SK_U64_MAX - 9) / 10)
+/* Exponent digits past this value are not accumulated (the number is
+ * way out of double range either way) */
+#define EXPONENT_LIMIT              100000L
 
 skScanner* skScanner_new(void* buffer, size_t bufsize)
 {
@@ -31,12 +38,78 @@ skScanner* skScanner_new(void* buffer, size_t bufsize)
         return NULL;
     }
 
+    skScanner_init(scanner, buffer, bufsize);
+    return scanner;
+}
+
+void skScanner_init(skScanner* scanner, void* buffer, size_t bufsize)
+{
     /* Leave token field as random garbo */
-    scanner->iter = skCharIter_new(buffer, bufsize - 1);
+    scanner->iter        = skCharIter_new(buffer, bufsize - 1);
+    scanner->base        = buffer;
+    scanner->index       = NULL;
+    scanner->cursor      = 0;
+    scanner->container   = 0;
+    scanner->stack       = NULL;
+    scanner->pool        = NULL;
+    scanner->insitu      = false;
+    scanner->raw_numbers = false;
+    scanner->token_start = NULL;
+    scanner->origin      = 0;
+    scanner->depth       = 1;
+}
+
+skScanner* skScanner_new_indexed(void* buffer, size_t bufsize)
+{
+    skScanner* scanner;
+
+    if(is_null(scanner = skScanner_new(buffer, bufsize))) {
+        return NULL;
+    }
+
+    if(is_null(scanner->index = skStructIndex_new(buffer, bufsize))) {
+        free(scanner);
+        return NULL;
+    }
 
     return scanner;
 }
 
+void skScanner_drop(skScanner* scanner)
+{
+    if(is_some(scanner)) {
+        skStructIndex_drop(scanner->index);
+        free(scanner);
+    }
+}
+
+/* Returns the address of the first indexed byte at or after 'from',
+ * or one past the end of the buffer if there is none. */
+static char* skScanner_next_indexed(skScanner* scanner, const char* from)
+{
+    const size_t* offsets;
+    size_t        pos;
+
+    offsets = scanner->index->offsets;
+    pos     = from - scanner->base;
+
+    /* Terminates on the sentinel */
+    while(offsets[scanner->cursor] < pos) {
+        scanner->cursor++;
+    }
+
+    return scanner->base + offsets[scanner->cursor];
+}
+
+size_t skScanner_offset(const skScanner* scanner)
+{
+    const char* pos;
+
+    /* Token start is unset once the iterator is drained */
+    pos = is_some(scanner->token_start) ? scanner->token_start : scanner->iter.end + 1;
+    return scanner->origin + (pos - scanner->base);
+}
+
 skToken skScanner_peek(const skScanner* scanner)
 {
     return scanner->token;
@@ -98,6 +171,16 @@ void skScanner_skip_until(skScanner* scanner, size_t n, ...)
     }
 }
 
+static skToken skToken_new(skTokenType type, char* start, size_t len)
+{
+    skToken token;
+    token.type   = type;
+    token.lexeme = skSlice_new(start, len);
+    /* Only number tokens carry a value */
+    memset(&token.number, 0, sizeof(token.number));
+    return token;
+}
+
 static void skScanner_set_string_token(skScanner* scanner)
 {
     int         c;
@@ -112,27 +195,178 @@ static void skScanner_set_string_token(skScanner* scanner)
     token->lexeme.ptr = skCharIter_next_address(iterator);
     token->lexeme.len = 0;
 
-    iterator->state.in_jstring = true;
     /* Advance iterator until we hit closing quotes */
     for(len = 0; (c = skCharIter_next(iterator)) != '"'; len++) {
+        if(c == '\\') {
+            /* Escaped byte can't close the string */
+            c = skCharIter_next(iterator);
+            len++;
+        }
         if(c == EOF) {
             /* We reached end of file and string is invalid */
             scanner->token.type = SK_INVALID;
             return;
         }
     }
-    iterator->state.in_jstring = false;
 
     /* String is properly enclosed */
     token->lexeme.len = len;
 }
 
+static void skScanner_set_string_token_indexed(skScanner* scanner)
+{
+    char*       start;
+    char*       closing;
+    skToken*    token;
+    skCharIter* iterator;
+
+    token    = &scanner->token;
+    iterator = &scanner->iter;
+
+    token->type       = SK_STRING;
+    token->lexeme.ptr = start = skCharIter_next_address(iterator);
+    token->lexeme.len = 0;
+
+    /* Contents of the string are never indexed, the next offset
+     * is the closing quote if the string is enclosed. */
+    if(is_null(start) || (closing = skScanner_next_indexed(scanner, start)) > iterator->end) {
+        skCharIter_drain(iterator);
+        token->type = SK_INVALID;
+        return;
+    }
+#ifdef SK_DBUG
+    assert(*closing == '"');
+#endif
+
+    skCharIter_skip_to(iterator, closing + 1);
+
+    token->lexeme.len = closing - start;
+}
+
+static void skScanner_set_ws_token(skScanner* scanner, char* start, skTokenType type)
+{
+    char*       end;
+    skCharIter* iterator;
+
+    iterator = &scanner->iter;
+    end      = start + 1;
+
+    /* Whitespace is not indexed, jump over the whole run */
+    if(is_some(iterator->next)) {
+        end = skScanner_next_indexed(scanner, iterator->next);
+        skCharIter_skip_to(iterator, end);
+    }
+
+    scanner->token = skToken_new(type, start, end - start);
+}
+
+/* Scans the whole Json number starting at 'start' in a single pass,
+ * validating the grammar and accumulating its value into the token.
+ * -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+static void skScanner_set_number_token(skScanner* scanner, char* start)
+{
+    skNumber*   number;
+    const char* end;
+    const char* cur;
+    long        exp;
+    bool        exp_negative;
+
+    number = &scanner->token.number;
+    end    = scanner->iter.end;
+    cur    = start;
+
+    number->mantissa  = 0;
+    number->exponent  = 0;
+    number->negative  = false;
+    number->is_double = false;
+    number->truncated = false;
+
+    if(*cur == '-') {
+        number->negative = true;
+        cur++;
+    }
+
+    if(!is_digit_at(cur, end)) {
+        goto invalid;
+    }
+
+    /* Integer part, leading zeroes are not allowed */
+    if(*cur == '0') {
+        cur++;
+        if(is_digit_at(cur, end)) {
+            goto invalid;
+        }
+    } else {
+        for(; is_digit_at(cur, end); cur++) {
+            if(number->mantissa <= MANTISSA_LIMIT) {
+                number->mantissa = number->mantissa * 10 + (*cur - '0');
+            } else {
+                number->truncated = true;
+                number->exponent++;
+            }
+        }
+    }
+
+    /* Fraction part */
+    if(cur <= end && *cur == '.') {
+        number->is_double = true;
+        cur++;
+        if(!is_digit_at(cur, end)) {
+            goto invalid;
+        }
+        for(; is_digit_at(cur, end); cur++) {
+            if(number->mantissa <= MANTISSA_LIMIT) {
+                number->mantissa = number->mantissa * 10 + (*cur - '0');
+                number->exponent--;
+            } else {
+                number->truncated = true;
+            }
+        }
+    }
+
+    /* Exponent part */
+    if(cur <= end && (*cur == 'e' || *cur == 'E')) {
+        number->is_double = true;
+        exp_negative      = false;
+        exp               = 0;
+
+        if(++cur <= end && (*cur == '+' || *cur == '-')) {
+            exp_negative = (*cur++ == '-');
+        }
+        if(!is_digit_at(cur, end)) {
+            goto invalid;
+        }
+        for(; is_digit_at(cur, end); cur++) {
+            if(exp < EXPONENT_LIMIT) {
+                exp = exp * 10 + (*cur - '0');
+            }
+        }
+        number->exponent += (exp_negative) ? -exp : exp;
+    }
+
+    scanner->token.type = SK_NUMBER;
+    goto out;
+
+invalid:
+    /* Swallow the rest of the malformed number */
+    while(is_digit_at(cur, end)
+          || (cur <= end && (*cur == '+' || *cur == '-' || *cur == '.' || *cur == 'e' || *cur == 'E')))
+    {
+        cur++;
+    }
+    scanner->token.type = SK_INVALID;
+
+out:
+    scanner->token.lexeme = skSlice_new(start, cur - start);
+    skCharIter_skip_to(&scanner->iter, cur);
+}
+
 static void skScanner_set_bool_or_null_token(skScanner* scanner, char ch)
 {
     char*       start;
     skCharIter* iter;
 
-    start = skCharIter_next_address(&scanner->iter) - 1;
+    start = scanner->token_start;
     iter  = &scanner->iter;
 
     scanner->token.type       = SK_INVALID;
@@ -145,7 +379,7 @@ static void skScanner_set_bool_or_null_token(skScanner* scanner, char ch)
                 scanner->token.type = SK_TRUE;
                 skCharIter_advance(iter, 3);
 #ifdef SK_DBUG
-                assert(*(skCharIter_next_address(iter) - 1) == 'e');
+                assert(start[3] == 'e');
 #endif
                 scanner->token.lexeme.len = 4;
             } else {
@@ -157,7 +391,7 @@ static void skScanner_set_bool_or_null_token(skScanner* scanner, char ch)
                 scanner->token.type = SK_FALSE;
                 skCharIter_advance(iter, 4);
 #ifdef SK_DBUG
-                assert(*(skCharIter_next_address(iter) - 1) == 'e');
+                assert(start[4] == 'e');
 #endif
                 scanner->token.lexeme.len = 5;
             } else {
@@ -169,7 +403,7 @@ static void skScanner_set_bool_or_null_token(skScanner* scanner, char ch)
                 scanner->token.type = SK_NULL;
                 skCharIter_advance(iter, 3);
 #ifdef SK_DBUG
-                assert(*(skCharIter_next_address(iter) - 1) == 'l');
+                assert(start[3] == 'l');
 #endif
                 scanner->token.lexeme.len = 4;
             } else {
@@ -187,13 +421,6 @@ static void skScanner_set_bool_or_null_token(skScanner* scanner, char ch)
     }
 }
 
-static skToken skToken_new(skTokenType type, char* start, size_t len)
-{
-    skToken token;
-    token.type   = type;
-    token.lexeme = skSlice_new(start, len);
-    return token;
-}
 
 skToken skScanner_next(skScanner* scanner)
 {
@@ -201,7 +428,8 @@ skToken skScanner_next(skScanner* scanner)
     int      c;
     char*    ch;
 
-    ch = skCharIter_next_address(&scanner->iter);
+    ch                   = skCharIter_next_address(&scanner->iter);
+    scanner->token_start = ch;
     switch((c = skCharIter_next(&scanner->iter))) {
         case '{':
             *token = skToken_new(SK_LCURLY, ch, 1);
@@ -217,22 +445,25 @@ skToken skScanner_next(skScanner* scanner)
             break;
         case ' ':
         case '\t':
-            *token = skToken_new(SK_WS, ch, 1);
+            if(is_some(scanner->index)) {
+                skScanner_set_ws_token(scanner, ch, SK_WS);
+            } else {
+                *token = skToken_new(SK_WS, ch, 1);
+            }
             break;
         case '\n':
-            *token = skToken_new(SK_NL, ch, 1);
+            if(is_some(scanner->index)) {
+                skScanner_set_ws_token(scanner, ch, SK_NL);
+            } else {
+                *token = skToken_new(SK_NL, ch, 1);
+            }
             break;
         case '"':
-            skScanner_set_string_token(scanner);
-            break;
-        case '.':
-            *token = skToken_new(SK_DOT, ch, 1);
-            break;
-        case '-':
-            *token = skToken_new(SK_HYPHEN, ch, 1);
-            break;
-        case '+':
-            *token = skToken_new(SK_PLUS, ch, 1);
+            if(is_some(scanner->index)) {
+                skScanner_set_string_token_indexed(scanner);
+            } else {
+                skScanner_set_string_token(scanner);
+            }
             break;
         case ',':
             *token = skToken_new(SK_COMMA, ch, 1);
@@ -249,16 +480,11 @@ skToken skScanner_next(skScanner* scanner)
         case 'n':
             skScanner_set_bool_or_null_token(scanner, 'n');
             break;
-        case 'e':
-        case 'E':
-            *token = skToken_new(SK_EXP, ch, 1);
-            break;
         case EOF:
             *token = skToken_new(SK_EOF, NULL, 0);
             break;
+        case '-':
         case '0':
-            *token = skToken_new(SK_ZERO, ch, 1);
-            break;
         case '1':
         case '2':
         case '3':
@@ -268,7 +494,7 @@ skToken skScanner_next(skScanner* scanner)
         case '7':
         case '8':
         case '9':
-            *token = skToken_new(SK_DIGIT, ch, 1);
+            skScanner_set_number_token(scanner, ch);
             break;
         default:
             *token = skToken_new(SK_INVALID, ch, 1);
@@ -1,6 +1,7 @@
 #ifndef __SK_SCANNER_H__
 #define __SK_SCANNER_H__
 
+#include "skindex.h"
 #include "sktoken.h"
 #include "skvec.h"
 #include <stdio.h>
@@ -8,14 +9,51 @@
 typedef struct {
   skCharIter iter;
   skToken token;
+  /* Start of the scanned buffer */
+  char *base;
+  /* Optional structural index, when present whitespace runs and
+   * strings are skipped in one step instead of byte by byte. */
+  skStructIndex *index;
+  /* Position in the index of the next unconsumed offset */
+  size_t cursor;
+  /* Position in 'index->sizes' of the next container to be opened */
+  size_t container;
+  /* Stack of the open containers kept between the parses (see
+   * 'skJsonParser'), NULL if the parser allocates its own */
+  skVec *stack;
+  /* Pool the parsed tree is allocated from, NULL if it lives on the heap */
+  skPool *pool;
+  /* Strings are nul terminated in place and the tree borrows them from
+   * the scanned buffer instead of allocating copies */
+  bool insitu;
+  /* Numbers are kept as their source text instead of being converted */
+  bool raw_numbers;
+  /* First byte of the current token */
+  char *token_start;
+  /* Offset of 'base' in the whole document, the document might be
+   * scanned in parts (see 'skJsonParser') */
+  size_t origin;
+  /* Nesting depth of the current token, the top level is at depth 1 */
+  size_t depth;
 } skScanner;
 
 skScanner *skScanner_new(void *buffer, size_t bufsize);
 
+skScanner *skScanner_new_indexed(void *buffer, size_t bufsize);
+
+/* Initializes caller owned SCANNER (without the index) over non-empty BUFFER */
+void skScanner_init(skScanner *scanner, void *buffer, size_t bufsize);
+
+void skScanner_drop(skScanner *scanner);
+
 skToken skScanner_next(skScanner *scanner);
 
 skToken skScanner_peek(const skScanner *scanner);
 
+/* Offset of the current token in the whole document, at the end of the
+ * buffer it is the offset right past its last byte */
+size_t skScanner_offset(const skScanner *scanner);
+
 void skScanner_skip(skScanner *scanner, size_t n, ...);
 
 void skScanner_skip_until(skScanner *scanner, size_t n, ...);
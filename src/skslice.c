@@ -47,27 +47,13 @@ skSlice_len(const skStrSlice* slice)
     return (is_null(slice)) ? -1 : (long int) slice->len;
 }
 
-skJsonState
-skJsonState_new(void)
-{
-    skJsonState state;
-    state.ln         = 1;
-    state.col        = 1;
-    state.depth      = 1;
-    state.in_jstring = false;
-    return state;
-}
-
 skCharIter
 skCharIter_new(const char* ptr, size_t len)
 {
-    skCharIter  iter;
-    skJsonState state;
+    skCharIter iter;
 
-    state      = skJsonState_new();
-    iter.next  = (char*) ptr;
-    iter.end   = (char*) ptr + len;
-    iter.state = state;
+    iter.next = (char*) ptr;
+    iter.end  = (char*) ptr + len;
 
     return iter;
 }
@@ -75,13 +61,10 @@ skCharIter_new(const char* ptr, size_t len)
 skCharIter
 skCharIter_from_slice(skStrSlice* slice)
 {
-    skCharIter  iter;
-    skJsonState state;
+    skCharIter iter;
 
-    state      = skJsonState_new();
-    iter.next  = skSlice_start(slice);
-    iter.end   = skSlice_end(slice);
-    iter.state = state;
+    iter.next = skSlice_start(slice);
+    iter.end  = skSlice_end(slice);
 
     return iter;
 }
@@ -96,57 +79,16 @@ skCharIter_next_address(const skCharIter* iterator)
     return iterator->next;
 }
 
-static void
-skCharIter_update_state(skCharIter* iterator, char ch)
-{
-    switch(ch) {
-        case '{':
-            if(!iterator->state.in_jstring) {
-                iterator->state.depth++;
-            }
-            iterator->state.col++;
-            break;
-        case '}':
-            if(!iterator->state.in_jstring) {
-                iterator->state.depth--;
-            }
-            iterator->state.col++;
-            break;
-        case '[':
-            if(!iterator->state.in_jstring) {
-                iterator->state.depth++;
-            }
-            iterator->state.col++;
-            break;
-        case ']':
-            if(!iterator->state.in_jstring) {
-                iterator->state.depth--;
-            }
-            iterator->state.col++;
-            break;
-        case '\n':
-            if(!iterator->state.in_jstring) {
-                iterator->state.ln++;
-                iterator->state.col = 1;
-            } else {
-                iterator->state.col++;
-            }
-            break;
-        default:
-            iterator->state.col++;
-            break;
-    }
-}
-
 int
 skCharIter_next(skCharIter* iterator)
 {
-    char temp;
+    unsigned char temp;
 
     if(is_null(iterator) || is_null(iterator->next)) {
         return EOF;
     }
 
+    /* Byte 0xFF read as a plain char would equal EOF */
     temp = *iterator->next;
 
     if(iterator->next == iterator->end) {
@@ -155,45 +97,42 @@ skCharIter_next(skCharIter* iterator)
         iterator->next++;
     }
 
-    skCharIter_update_state(iterator, temp);
     return temp;
 }
 
 int
 skCharIter_advance(skCharIter* iterator, size_t amount)
 {
-    int c;
+    size_t available;
+    int    c;
 
     if(is_null(iterator) || is_null(iterator->next)) {
         return EOF;
     }
 
-    c = skCharIter_peek(iterator);
+    if(amount == 0) {
+        return skCharIter_peek(iterator);
+    }
 
-    while(amount--) {
-        if((c = skCharIter_next(iterator)) == EOF) {
-            break;
-        }
+    available = iterator->end - iterator->next + 1;
+    if(amount > available) {
+        iterator->next = NULL;
+        return EOF;
     }
 
+    c              = (unsigned char) iterator->next[amount - 1];
+    iterator->next = (amount == available) ? NULL : iterator->next + amount;
     return c;
 }
 
-/* Useless for now */
 void
-skCharIter_depth_above(skCharIter* iterator)
+skCharIter_skip_to(skCharIter* iterator, const char* target)
 {
-    size_t target_depth;
-
-    if(iterator->state.depth < 2) {
-        skCharIter_drain(iterator);
-    } else {
-        target_depth = iterator->state.depth - 1;
-
-        while(iterator->state.depth != target_depth) {
-            skCharIter_next(iterator);
-        }
+    if(is_null(iterator) || is_null(iterator->next)) {
+        return;
     }
+
+    iterator->next = (target > iterator->end) ? NULL : (char*) target;
 }
 
 void
@@ -211,5 +150,5 @@ skCharIter_peek(const skCharIter* iterator)
         return EOF;
     }
 
-    return *iterator->next;
+    return (unsigned char) *iterator->next;
 }
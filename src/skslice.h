@@ -43,26 +43,12 @@ char *skSlice_index(const skStrSlice *slice, size_t index);
  */
 long int skSlice_len(const skStrSlice *slice);
 
-/**
- * Struct containing debug information in case error occurs during
- * parsing, it is part of the 'skCharIter' because that is our
- * Json byte iterator.
- */
-typedef struct _skJsonState {
-  size_t depth;
-  size_t col;
-  size_t ln;
-  bool in_jstring;
-} skJsonState;
-
 /**
  * Iterator over char's (bytes).
- * Holds 'skJsonState' and updates it on every call to 'skCharIter_next'.
  */
 typedef struct {
   char *next;
   char *end;
-  skJsonState state;
 } skCharIter;
 
 /**
@@ -78,15 +64,16 @@ skCharIter skCharIter_new(const char *ptr, size_t len);
 skCharIter skCharIter_from_slice(skStrSlice *slice);
 
 /**
- * Returns the next char from ITERATOR, if ITERATOR is exhausted
- * (was already at the end) or ITERATOR is NULL then it returns EOF.
+ * Returns the next char from ITERATOR as unsigned char (so no byte equals EOF),
+ * if ITERATOR is exhausted (was already at the end) or ITERATOR is NULL then
+ * it returns EOF.
  */
 int skCharIter_next(skCharIter *iterator);
 
 /**
  * Peeks at the next char without advancing the iterator (consuming
  * the value).
- * Returns either a char that we peeked at or EOF is ITERATOR is NULL
+ * Returns either a char (as unsigned char) that we peeked at or EOF is ITERATOR is NULL
  * or ITERATOR is exhausted.
  */
 int skCharIter_peek(const skCharIter *iterator);
@@ -96,10 +83,17 @@ int skCharIter_peek(const skCharIter *iterator);
  */
 char *skCharIter_next_address(const skCharIter *iterator);
 
+/**
+ * Consumes AMOUNT chars from ITERATOR and returns the last one consumed
+ * (as unsigned char), or EOF if ITERATOR got exhausted before that.
+ */
 int skCharIter_advance(skCharIter *iterator, size_t amount);
 
-void skCharIter_drain(skCharIter *iterator);
+/**
+ * Advances the ITERATOR up to (but excluding) TARGET in one step.
+ */
+void skCharIter_skip_to(skCharIter *iterator, const char *target);
 
-void skCharIter_depth_above(skCharIter *iterator);
+void skCharIter_drain(skCharIter *iterator);
 
 #endif
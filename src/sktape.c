@@ -0,0 +1,524 @@
+/* clang-format off */
+#ifdef SK_DBUG
+#include <assert.h>
+#endif
+#include "skerror.h"
+#include "sknumber.h"
+#include "skparser.h" /* Make sure skparser.h which includes sknode.h is included before skjson.h */
+#include "skjson.h"
+#include "skutf8.h"
+#include "skutils.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+/* clang-format on */
+
+/* Tape is a flat array of 64-bit words, each element starts with a word
+ * holding its tag in the top byte and a payload in the remaining 56 bits:
+ *  '{' '[' payload is the position right past the matching closing word,
+ *  '}' ']' payload is the number of members/elements of the container,
+ *  '"'     payload is the offset of the string in the string buffer,
+ *          next word is its length (object keys are stored the same way),
+ *  'l' 'd' next word is the value (long or the bits of the double),
+ *  't' 'f' 'n' have no payload. */
+#define TAPE_TAG_SHIFT 56
+#define TAPE_PAYLOAD   SK_U64C(0x00FFFFFFUL, 0xFFFFFFFFUL)
+
+#define tape_word(tag, payload) (((skU64) (tag) << TAPE_TAG_SHIFT) | (skU64) (payload))
+#define tape_tag(word)          ((int) ((word) >> TAPE_TAG_SHIFT))
+#define tape_payload(word)      ((size_t) ((word) & TAPE_PAYLOAD))
+/* Tag of the element at 'ref' or 0 if 'ref' is not an element of any tape */
+#define ref_tag(ref)            (is_some((ref).tape) ? tape_tag((ref).tape->words[(ref).pos]) : 0)
+
+struct skJsonTape {
+    skU64* words;
+    size_t len;
+    size_t capacity;
+    char*  strings; /* Decoded strings, each one is nul-terminated */
+    size_t strings_len;
+};
+
+/* What the writer expects to see next */
+typedef enum {
+    TAPE_VALUE,
+    TAPE_VALUE_OR_CLOSE, /* First element of the array or ']' */
+    TAPE_KEY,
+    TAPE_KEY_OR_CLOSE, /* First key of the object or '}' */
+    TAPE_COLON,
+    TAPE_NEXT, /* ',' or the end of the container */
+    TAPE_DONE  /* Only whitespace can follow the root */
+} skTapeExpect;
+
+/* Makes room for 'additional' words on the 'tape' */
+static bool skJsonTape_reserve(skJsonTape* tape, size_t additional)
+{
+    skU64* words;
+    size_t cap;
+
+    if(tape->capacity - tape->len >= additional) {
+        return true;
+    }
+
+    cap = (tape->capacity == 0) ? 64 : tape->capacity * 2;
+    while(cap - tape->len < additional) {
+        cap *= 2;
+    }
+
+    if(is_null(words = realloc(tape->words, cap * sizeof(skU64)))) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        return false;
+    }
+
+    tape->words    = words;
+    tape->capacity = cap;
+    return true;
+}
+
+/* Decodes the string token of the 'scanner' into the string buffer and
+ * writes its two words, returns the parse error code or 0 */
+static int skJsonTape_write_string(skJsonTape* tape, const skScanner* scanner)
+{
+    const skStrSlice* slice;
+    char*             out;
+    size_t            len;
+
+    slice = &scanner->token.lexeme;
+    out   = tape->strings + tape->strings_len;
+
+    if(slice->len > 0 && !skJsonString_isvalid(slice)) {
+        return SK_PARSE_STRING;
+    }
+
+    if(is_null(memchr(slice->ptr, '\\', slice->len))) {
+        memcpy(out, slice->ptr, slice->len);
+        len = slice->len;
+    } else if((len = skUtf8_unescape(out, slice->ptr, slice->len)) == (size_t) -1) {
+        return SK_PARSE_STRING;
+    }
+
+    out[len] = '\0';
+
+    tape->words[tape->len++]  = tape_word('"', tape->strings_len);
+    tape->words[tape->len++]  = len;
+    tape->strings_len        += len + 1;
+    return 0;
+}
+
+/* Writes the scalar at the current token of the 'scanner', returns the parse error code or 0 */
+static int skJsonTape_write_scalar(skJsonTape* tape, const skScanner* scanner)
+{
+    const skToken* token;
+    long           integ;
+    double         dbl;
+    skU64          bits;
+
+    token = &scanner->token;
+
+    switch(token->type) {
+        case SK_STRING:
+            return skJsonTape_write_string(tape, scanner);
+        case SK_NUMBER:
+            if(skNumber_to_integer(&token->number, &integ)) {
+                tape->words[tape->len++] = tape_word('l', 0);
+                tape->words[tape->len++] = (skU64) integ;
+                return 0;
+            }
+            /* Same as the tree parser, out of range numbers are clamped */
+            dbl = skNumber_to_double(&token->number, &token->lexeme);
+            if(dbl > DBL_MAX || dbl < -DBL_MAX) {
+                dbl = (dbl < 0) ? -DBL_MAX : DBL_MAX;
+            }
+            memcpy(&bits, &dbl, sizeof(bits));
+            tape->words[tape->len++] = tape_word('d', 0);
+            tape->words[tape->len++] = bits;
+            return 0;
+        case SK_TRUE:
+            tape->words[tape->len++] = tape_word('t', 0);
+            return 0;
+        case SK_FALSE:
+            tape->words[tape->len++] = tape_word('f', 0);
+            return 0;
+        case SK_NULL:
+            tape->words[tape->len++] = tape_word('n', 0);
+            return 0;
+        default:
+            return SK_PARSE_TOKEN;
+    }
+}
+
+/* Writes the whole document the 'scanner' is at onto the 'tape'. Open containers
+ * keep their element count in the payload of their opening word until they are
+ * closed, 'open' holds the positions of those words. Returns the parse error code,
+ * 0 on success or -1 if allocation failed. */
+static int skJsonTape_write(skJsonTape* tape, skScanner* scanner, size_t* open)
+{
+    skTapeExpect expect;
+    skToken      token;
+    size_t       depth;
+    size_t       pos;
+    int          code;
+    int          tag;
+
+    depth  = 0;
+    expect = TAPE_VALUE;
+
+    for(;;) {
+        token = skScanner_peek(scanner);
+
+        if(token.type == SK_WS || token.type == SK_NL) {
+            skScanner_next(scanner);
+            continue;
+        }
+
+        /* Enough for any single element */
+        if(!skJsonTape_reserve(tape, 2)) {
+            return -1;
+        }
+
+        switch(expect) {
+            case TAPE_VALUE_OR_CLOSE:
+                if(token.type == SK_RBRACK) {
+                    goto close;
+                }
+                /* fall through */
+            case TAPE_VALUE:
+                /* Element of the array counts right away, member of the object counted its key */
+                if(depth > 0 && tape_tag(tape->words[open[depth - 1]]) == '[') {
+                    tape->words[open[depth - 1]]++;
+                }
+                if(token.type == SK_LCURLY || token.type == SK_LBRACK) {
+                    if(depth + 1 > SK_MAX_DEPTH) {
+                        return SK_PARSE_DEPTH;
+                    }
+                    scanner->depth++;
+                    open[depth++]            = tape->len;
+                    tape->words[tape->len++] = tape_word((token.type == SK_LCURLY) ? '{' : '[', 0);
+                    expect = (token.type == SK_LCURLY) ? TAPE_KEY_OR_CLOSE : TAPE_VALUE_OR_CLOSE;
+                    skScanner_next(scanner);
+                    continue;
+                }
+                if((code = skJsonTape_write_scalar(tape, scanner)) != 0) {
+                    return code;
+                }
+                skScanner_next(scanner);
+                expect = (depth == 0) ? TAPE_DONE : TAPE_NEXT;
+                continue;
+            case TAPE_KEY_OR_CLOSE:
+                if(token.type == SK_RCURLY) {
+                    goto close;
+                }
+                /* fall through */
+            case TAPE_KEY:
+                if(token.type != SK_STRING) {
+                    return SK_PARSE_OBJECT;
+                }
+                if((code = skJsonTape_write_string(tape, scanner)) != 0) {
+                    return code;
+                }
+                tape->words[open[depth - 1]]++;
+                skScanner_next(scanner);
+                expect = TAPE_COLON;
+                continue;
+            case TAPE_COLON:
+                if(token.type != SK_COLON) {
+                    return SK_PARSE_OBJECT;
+                }
+                skScanner_next(scanner);
+                expect = TAPE_VALUE;
+                continue;
+            case TAPE_NEXT:
+                tag = tape_tag(tape->words[open[depth - 1]]);
+                if(token.type == SK_COMMA) {
+                    skScanner_next(scanner);
+                    expect = (tag == '{') ? TAPE_KEY : TAPE_VALUE;
+                    continue;
+                }
+                if(token.type == ((tag == '{') ? SK_RCURLY : SK_RBRACK)) {
+                    goto close;
+                }
+                return (tag == '{') ? SK_PARSE_OBJECT : SK_PARSE_ARRAY;
+            case TAPE_DONE:
+            default:
+                return (token.type == SK_EOF) ? 0 : SK_PARSE_TOKEN;
+        }
+
+    close:
+        scanner->depth--;
+        pos                      = open[--depth];
+        tag                      = tape_tag(tape->words[pos]);
+        tape->words[tape->len++] = tape_word((tag == '{') ? '}' : ']', tape_payload(tape->words[pos]));
+        tape->words[pos]         = tape_word(tag, tape->len);
+        skScanner_next(scanner);
+        expect = (depth == 0) ? TAPE_DONE : TAPE_NEXT;
+    }
+}
+
+PUBLIC(skJsonTape*) skJsonTape_parse(const char* buff, size_t bufsize, skJsonError* err)
+{
+    skScanner     scanner;
+    skStructIndex index;
+    skJsonTape*   tape;
+    size_t*       open;
+    char*         strings;
+    int           code;
+
+    if(is_some(err)) {
+        memset(err, 0, sizeof(skJsonError));
+    }
+
+    if(is_null(buff) || bufsize == 0) {
+        return NULL;
+    }
+
+    tape = calloc(1, sizeof(skJsonTape));
+    open = malloc(SK_MAX_DEPTH * sizeof(size_t));
+    /* Decoded string and its nul always fit where the string and its quotes were */
+    strings = malloc(bufsize);
+
+    if(is_null(tape) || is_null(open) || is_null(strings)) {
+#ifdef SK_ERRMSG
+        THROW_ERR(OutOfMemory);
+#endif
+        free(tape);
+        free(open);
+        free(strings);
+        return NULL;
+    }
+
+    tape->strings = strings;
+    code          = -1;
+
+    /* One word per indexed byte is usually the whole tape */
+    skStructIndex_init(&index);
+    if(skStructIndex_build(&index, buff, bufsize) && skJsonTape_reserve(tape, index.len + 1)) {
+        skScanner_init(&scanner, discard_const(buff), bufsize);
+        scanner.index = &index;
+        skScanner_next(&scanner);
+
+        if((code = skJsonTape_write(tape, &scanner, open)) > 0 && is_some(err)) {
+            err->code   = code;
+            err->offset = skScanner_offset(&scanner);
+            err->depth  = scanner.depth;
+        }
+    }
+
+    free(open);
+    skStructIndex_release(&index);
+
+    if(code != 0) {
+        skJsonTape_drop(tape);
+        return NULL;
+    }
+
+    /* Give back what the strings didn't use */
+    if(tape->strings_len > 0 && is_some(strings = realloc(tape->strings, tape->strings_len))) {
+        tape->strings = strings;
+    }
+
+    return tape;
+}
+
+PUBLIC(void) skJsonTape_drop(skJsonTape* tape)
+{
+    if(is_some(tape)) {
+        free(tape->words);
+        free(tape->strings);
+        free(tape);
+    }
+}
+
+PUBLIC(skJsonTapeRef) skJsonTape_root(const skJsonTape* tape)
+{
+    skJsonTapeRef ref;
+
+    ref.tape = tape;
+    ref.pos  = 0;
+    return ref;
+}
+
+/* Returns the position right past the element at 'pos' */
+static size_t skJsonTape_skip(const skJsonTape* tape, size_t pos)
+{
+    switch(tape_tag(tape->words[pos])) {
+        case '{':
+        case '[':
+            return tape_payload(tape->words[pos]);
+        case '"':
+        case 'l':
+        case 'd':
+            return pos + 2;
+        default:
+            return pos + 1;
+    }
+}
+
+PUBLIC(int) skJsonTape_type(skJsonTapeRef ref)
+{
+    switch(ref_tag(ref)) {
+        case '{':
+            return SKJS_OBJ;
+        case '[':
+            return SKJS_ARR;
+        case '"':
+            return SKJS_STR;
+        case 'l':
+            return SKJS_INT;
+        case 'd':
+            return SKJS_DBL;
+        case 't':
+        case 'f':
+            return SKJS_BOOL;
+        case 'n':
+            return SKJS_NULL;
+        default:
+            return SKJS_NONE;
+    }
+}
+
+PUBLIC(size_t) skJsonTape_len(skJsonTapeRef ref)
+{
+    int tag;
+
+    if((tag = ref_tag(ref)) != '{' && tag != '[') {
+        return 0;
+    }
+
+    /* Closing word is the last one of the container */
+    return tape_payload(ref.tape->words[tape_payload(ref.tape->words[ref.pos]) - 1]);
+}
+
+/* Starts iterating the container at 'ref' if it is of 'tag' */
+static skJsonBool skJsonTape_iter_init(skJsonTapeRef ref, int tag, skJsonTapeIter* iter)
+{
+    if(is_null(iter) || ref_tag(ref) != tag) {
+        return false;
+    }
+
+    iter->tape = ref.tape;
+    iter->pos  = ref.pos + 1;
+    iter->end  = tape_payload(ref.tape->words[ref.pos]) - 1;
+    return true;
+}
+
+PUBLIC(skJsonBool) skJsonTape_array_iter(skJsonTapeRef array, skJsonTapeIter* iter)
+{
+    return skJsonTape_iter_init(array, '[', iter);
+}
+
+PUBLIC(skJsonBool) skJsonTape_object_iter(skJsonTapeRef object, skJsonTapeIter* iter)
+{
+    return skJsonTape_iter_init(object, '{', iter);
+}
+
+PUBLIC(skJsonBool) skJsonTape_iter_next(skJsonTapeIter* iter, const char** key, skJsonTapeRef* value)
+{
+    const skU64* words;
+
+    if(is_null(iter) || is_null(iter->tape) || iter->pos >= iter->end) {
+        return false;
+    }
+
+    words = iter->tape->words;
+
+    /* Members of the object start with the key */
+    if(tape_tag(words[iter->end]) == '}') {
+        if(is_some(key)) {
+            *key = iter->tape->strings + tape_payload(words[iter->pos]);
+        }
+        iter->pos += 2;
+    } else if(is_some(key)) {
+        *key = NULL;
+    }
+
+    if(is_some(value)) {
+        value->tape = iter->tape;
+        value->pos  = iter->pos;
+    }
+
+    iter->pos = skJsonTape_skip(iter->tape, iter->pos);
+    return true;
+}
+
+PUBLIC(skJsonBool) skJsonTape_object_get(skJsonTapeRef object, const char* key, skJsonTapeRef* value)
+{
+    const skU64* words;
+    const char*  strings;
+    size_t       len;
+    size_t       pos;
+    size_t       end;
+
+    if(is_null(key) || ref_tag(object) != '{') {
+        return false;
+    }
+
+    words   = object.tape->words;
+    strings = object.tape->strings;
+    len     = strlen(key);
+    end     = tape_payload(words[object.pos]) - 1;
+
+    /* Values of the other members are skipped whole */
+    for(pos = object.pos + 1; pos < end; pos = skJsonTape_skip(object.tape, pos + 2)) {
+        if(words[pos + 1] == len && memcmp(strings + tape_payload(words[pos]), key, len) == 0) {
+            if(is_some(value)) {
+                value->tape = object.tape;
+                value->pos  = pos + 2;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+PUBLIC(const char*) skJsonTape_string(skJsonTapeRef ref, size_t* len)
+{
+    if(ref_tag(ref) != '"') {
+        return NULL;
+    }
+
+    if(is_some(len)) {
+        *len = ref.tape->words[ref.pos + 1];
+    }
+
+    return ref.tape->strings + tape_payload(ref.tape->words[ref.pos]);
+}
+
+PUBLIC(long int) skJsonTape_integer(skJsonTapeRef ref, int* cntrl)
+{
+    if(ref_tag(ref) != 'l') {
+        *cntrl = -1;
+        return 0;
+    }
+
+    *cntrl = 0;
+    return (long) ref.tape->words[ref.pos + 1];
+}
+
+PUBLIC(double) skJsonTape_double(skJsonTapeRef ref, int* cntrl)
+{
+    double dbl;
+
+    if(ref_tag(ref) != 'd') {
+        *cntrl = -1;
+        return 0;
+    }
+
+    memcpy(&dbl, &ref.tape->words[ref.pos + 1], sizeof(dbl));
+    *cntrl = 0;
+    return dbl;
+}
+
+PUBLIC(skJsonBool) skJsonTape_bool(skJsonTapeRef ref, int* cntrl)
+{
+    int tag;
+
+    if((tag = ref_tag(ref)) != 't' && tag != 'f') {
+        *cntrl = -1;
+        return false;
+    }
+
+    *cntrl = 0;
+    return tag == 't';
+}
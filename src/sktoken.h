@@ -13,12 +13,7 @@ typedef enum {
   SK_NL,
   SK_STRING,
   SK_EOF,
-  SK_DIGIT,
-  SK_ZERO,
-  SK_DOT,
-  SK_HYPHEN,
-  SK_EXP,
-  SK_PLUS,
+  SK_NUMBER,
   SK_TRUE,
   SK_FALSE,
   SK_NULL,
@@ -26,9 +21,22 @@ typedef enum {
   SK_COLON
 } skTokenType;
 
+/* Value of the 'SK_NUMBER' token accumulated while scanning.
+ * Number equals 'mantissa' * 10^'exponent', if there were more significant
+ * digits than 'mantissa' can hold then 'truncated' is set and the value
+ * is only approximate. */
+typedef struct {
+  skU64 mantissa;
+  long exponent;
+  bool negative;
+  bool is_double; /* Has fraction and/or exponent part */
+  bool truncated;
+} skNumber;
+
 typedef struct {
   skTokenType type;
   skStrSlice lexeme;
+  skNumber number;
 } skToken;
 
 #endif
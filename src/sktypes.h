@@ -1,11 +1,28 @@
 #ifndef __SK_TYPES_H__
 #define __SK_TYPES_H__
 
+#include <limits.h>
+
 typedef long int skJsonInteger;
 typedef char *skJsonString;
 typedef double skJsonDouble;
 typedef int skJsonBool;
 
+/* Unsigned 64-bit integer, ANSI C has no 'long long' so 'unsigned long'
+ * is used wherever it is wide enough. SK_U64C builds a constant out of
+ * its high and low 32-bit halves. */
+#if (ULONG_MAX >> 31 >> 31) >= 3
+typedef unsigned long skU64;
+#elif defined(__GNUC__)
+__extension__ typedef unsigned long long skU64;
+#elif defined(_MSC_VER)
+typedef unsigned __int64 skU64;
+#else
+#error "skJson requires an unsigned 64-bit integer type"
+#endif
+#define SK_U64C(hi, lo) (((skU64)(hi) << 32) | (skU64)(lo))
+#define SK_U64_MAX      (~(skU64)0)
+
 typedef int (*CmpFn)(const void *, const void *);
 
 typedef void (*FreeFn)(void *);
@@ -0,0 +1,360 @@
+/* clang-format off */
+#include "skutf8.h"
+#include "skutils.h"
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SK_SSE2
+#endif
+/* clang-format on */
+
+/* Number of bytes classified at once */
+#define BLOCK_SIZE 32
+
+#if defined(__GNUC__)
+#define lowest_bit_pos(mask) __builtin_ctzl(mask)
+#else
+static int lowest_bit_pos(unsigned long mask)
+{
+    int pos;
+    for(pos = 0; !(mask & 1); pos++) {
+        mask >>= 1;
+    }
+    return pos;
+}
+#endif
+
+#define is_hex(c) \
+    (((c) >= '0' && (c) <= '9') || ((c) >= 'a' && (c) <= 'f') || ((c) >= 'A' && (c) <= 'F'))
+/* UTF-8 continuation byte 10xxxxxx */
+#define is_cont(c) (((c) & 0xC0) == 0x80)
+
+/* Returns the mask of bytes in the block that need a closer look: control
+ * characters, quotes, backslashes and all non-ASCII bytes. Signed comparison
+ * against ' ' catches both control characters and bytes with the high bit set. */
+#if defined(__AVX2__)
+static unsigned long skBlock_special(const char* bytes)
+{
+    __m256i block;
+    __m256i special;
+
+    block   = _mm256_loadu_si256((const __m256i*) bytes);
+    special = _mm256_or_si256(
+        _mm256_cmpgt_epi8(_mm256_set1_epi8(' '), block),
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('"')),
+                        _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\\'))));
+
+    return (unsigned long) (unsigned int) _mm256_movemask_epi8(special);
+}
+#elif defined(SK_SSE2)
+static unsigned long special_mask(__m128i block)
+{
+    __m128i special;
+
+    special = _mm_or_si128(_mm_cmplt_epi8(block, _mm_set1_epi8(' ')),
+                           _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+                                        _mm_cmpeq_epi8(block, _mm_set1_epi8('\\'))));
+
+    return (unsigned long) (unsigned int) _mm_movemask_epi8(special);
+}
+
+static unsigned long skBlock_special(const char* bytes)
+{
+    return special_mask(_mm_loadu_si128((const __m128i*) bytes))
+           | (special_mask(_mm_loadu_si128((const __m128i*) (bytes + 16))) << 16);
+}
+#else
+static unsigned long skBlock_special(const char* bytes)
+{
+    unsigned long mask;
+    unsigned char c;
+    int           i;
+
+    for(i = 0, mask = 0; i < BLOCK_SIZE; i++) {
+        c = bytes[i];
+        if(c < ' ' || c >= 0x80 || c == '"' || c == '\\') {
+            mask |= 1UL << i;
+        }
+    }
+
+    return mask;
+}
+#endif
+
+/* Returns the length of the escape sequence at 'str' (starting with the
+ * backslash) or 0 if it is invalid, 'len' is the number of bytes left. */
+static size_t skEscape_len(const unsigned char* str, size_t len)
+{
+    if(len < 2) {
+        return 0;
+    }
+
+    switch(str[1]) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            return 2;
+        case 'u':
+            if(len < 6 || !is_hex(str[2]) || !is_hex(str[3]) || !is_hex(str[4])
+               || !is_hex(str[5]))
+            {
+                return 0;
+            }
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+/* Returns the length of the multi byte UTF-8 sequence at 'str' or 0 if
+ * it is malformed (RFC 3629), 'len' is the number of bytes left. */
+static size_t skUtf8_sequence_len(const unsigned char* str, size_t len)
+{
+    unsigned char lead;
+    unsigned char lo, hi; /* Range of the second byte */
+    size_t        n;
+
+    lead = str[0];
+    lo   = 0x80;
+    hi   = 0xBF;
+
+    if(lead >= 0xC2 && lead <= 0xDF) {
+        n = 2;
+    } else if(lead >= 0xE0 && lead <= 0xEF) {
+        n = 3;
+        if(lead == 0xE0) {
+            lo = 0xA0; /* Overlong */
+        } else if(lead == 0xED) {
+            hi = 0x9F; /* Surrogates */
+        }
+    } else if(lead >= 0xF0 && lead <= 0xF4) {
+        n = 4;
+        if(lead == 0xF0) {
+            lo = 0x90; /* Overlong */
+        } else if(lead == 0xF4) {
+            hi = 0x8F; /* Above U+10FFFF */
+        }
+    } else {
+        /* Continuation byte, overlong 2 byte form or out of range */
+        return 0;
+    }
+
+    if(len < n || str[1] < lo || str[1] > hi) {
+        return 0;
+    }
+
+    if((n > 2 && !is_cont(str[2])) || (n > 3 && !is_cont(str[3]))) {
+        return 0;
+    }
+
+    return n;
+}
+
+/* Validates special byte at 'str' (see 'skBlock_special'), returns how many
+ * bytes it took or 0 if it is invalid. Unless 'json' is set only non-ASCII
+ * bytes are special and the rest is taken as it is. */
+static size_t skSpecial_len(const unsigned char* str, size_t len, bool json)
+{
+    if(*str >= 0x80) {
+        return skUtf8_sequence_len(str, len);
+    } else if(!json) {
+        return 1;
+    } else if(*str == '\\') {
+        return skEscape_len(str, len);
+    } else if(*str < ' ' || *str == '"') {
+        return 0;
+    }
+
+    return 1;
+}
+
+static bool skUtf8_validate(const char* str, size_t len, bool json)
+{
+    const unsigned char* bytes;
+    unsigned long        mask;
+    size_t               pos;
+    size_t               start;
+    size_t               taken;
+
+    bytes = (const unsigned char*) str;
+    pos   = 0;
+
+    while(len - pos >= BLOCK_SIZE) {
+        start = pos;
+        mask  = skBlock_special(str + start);
+
+        /* Jump from one special byte to the next one, sequence that
+         * crosses the end of the block is finished before moving on. */
+        while(mask) {
+            pos = start + lowest_bit_pos(mask);
+            if((taken = skSpecial_len(bytes + pos, len - pos, json)) == 0) {
+                return false;
+            }
+            if((pos += taken) >= start + BLOCK_SIZE) {
+                break;
+            }
+            mask &= ~0UL << (pos - start);
+        }
+
+        if(pos < start + BLOCK_SIZE) {
+            pos = start + BLOCK_SIZE;
+        }
+    }
+
+    /* Tail that doesn't fill the whole block */
+    while(pos < len) {
+        if((taken = skSpecial_len(bytes + pos, len - pos, json)) == 0) {
+            return false;
+        }
+        pos += taken;
+    }
+
+    return true;
+}
+
+bool skUtf8_isvalid_json(const char* str, size_t len)
+{
+    return skUtf8_validate(str, len, true);
+}
+
+bool skUtf8_isvalid(const char* str, size_t len)
+{
+    return skUtf8_validate(str, len, false);
+}
+
+/* Returns the value of 4 hexadecimal digits at 'hex' */
+static unsigned long hex_value(const char* hex)
+{
+    unsigned long value;
+    int           i;
+    char          c;
+
+    for(i = 0, value = 0; i < 4; i++) {
+        c     = hex[i];
+        value = value * 16
+                + ((c <= '9') ? c - '0' : (c <= 'F') ? c - 'A' + 10 : c - 'a' + 10);
+    }
+
+    return value;
+}
+
+/* Writes UTF-8 encoding of code point 'cp' into 'dst', returns its length */
+static size_t skUtf8_encode(char* dst, unsigned long cp)
+{
+    if(cp < 0x80) {
+        dst[0] = (char) cp;
+        return 1;
+    } else if(cp < 0x800) {
+        dst[0] = (char) (0xC0 | (cp >> 6));
+        dst[1] = (char) (0x80 | (cp & 0x3F));
+        return 2;
+    } else if(cp < 0x10000) {
+        dst[0] = (char) (0xE0 | (cp >> 12));
+        dst[1] = (char) (0x80 | ((cp >> 6) & 0x3F));
+        dst[2] = (char) (0x80 | (cp & 0x3F));
+        return 3;
+    }
+
+    dst[0] = (char) (0xF0 | (cp >> 18));
+    dst[1] = (char) (0x80 | ((cp >> 12) & 0x3F));
+    dst[2] = (char) (0x80 | ((cp >> 6) & 0x3F));
+    dst[3] = (char) (0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* Decodes the escape sequence at 'src' (past the backslash) into 'dst'. Sets
+ * '*taken' to the number of bytes consumed from 'src' and returns the number
+ * of bytes written or 0 if the escape encodes the nul character. */
+static size_t skEscape_decode(char* dst, const char* src, const char* end, size_t* taken)
+{
+    unsigned long cp, low;
+
+    *taken = 1;
+
+    switch(*src) {
+        case 'b':
+            *dst = '\b';
+            return 1;
+        case 'f':
+            *dst = '\f';
+            return 1;
+        case 'n':
+            *dst = '\n';
+            return 1;
+        case 'r':
+            *dst = '\r';
+            return 1;
+        case 't':
+            *dst = '\t';
+            return 1;
+        case 'u':
+            break;
+        default: /* '"', '\\' and '/' stand for themselves */
+            *dst = *src;
+            return 1;
+    }
+
+    cp     = hex_value(src + 1);
+    *taken = 5;
+
+    if(cp == 0) {
+        return 0;
+    }
+
+    if(cp >= 0xD800 && cp <= 0xDBFF) {
+        /* High surrogate must be followed by the escaped low surrogate */
+        if(end - src >= 11 && src[5] == '\\' && src[6] == 'u'
+           && (low = hex_value(src + 7)) >= 0xDC00 && low <= 0xDFFF)
+        {
+            cp     = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            *taken = 11;
+        } else {
+            cp = 0xFFFD;
+        }
+    } else if(cp >= 0xDC00 && cp <= 0xDFFF) {
+        cp = 0xFFFD;
+    }
+
+    return skUtf8_encode(dst, cp);
+}
+
+size_t skUtf8_unescape(char* dst, const char* src, size_t len)
+{
+    const char* end;
+    const char* backslash;
+    char*       out;
+    size_t      run;
+    size_t      taken;
+    size_t      written;
+
+    end = src + len;
+    out = dst;
+
+    while(src < end) {
+        /* Copy the whole run up to the next escape at once */
+        backslash = memchr(src, '\\', end - src);
+        run       = (is_some(backslash) ? backslash : end) - src;
+        memmove(out, src, run);
+        out += run;
+        src += run;
+
+        if(src == end) {
+            break;
+        }
+
+        if((written = skEscape_decode(out, src + 1, end, &taken)) == 0) {
+            return (size_t) -1;
+        }
+        out += written;
+        src += 1 + taken;
+    }
+
+    return out - dst;
+}
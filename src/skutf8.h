@@ -0,0 +1,34 @@
+#ifndef __SK_UTF8_H__
+#define __SK_UTF8_H__
+
+#include "sktypes.h"
+#include <stddef.h>
+
+/**
+ * Checks that LEN bytes at STR are valid contents of the Json string
+ * (without the enclosing quotes): well formed UTF-8 (no overlong forms,
+ * surrogates or code points above U+10FFFF), no control characters or
+ * unescaped quotes and every backslash starts a valid escape sequence.
+ * Input is classified block by block, runs of plain ASCII are skipped
+ * a whole block at a time.
+ */
+bool skUtf8_isvalid_json(const char *str, size_t len);
+
+/**
+ * Checks that LEN bytes at STR are well formed UTF-8, other than
+ * that any byte is allowed (decoded strings are escaped when serialized).
+ */
+bool skUtf8_isvalid(const char *str, size_t len);
+
+/**
+ * Decodes escape sequences of the Json string contents SRC of LEN bytes
+ * (that passed 'skUtf8_isvalid_json') into UTF-8 and writes the result
+ * into DST. Surrogate pairs are combined into a single code point, lone
+ * surrogates are replaced with U+FFFD. Decoded string is never longer
+ * than SRC so DST can be the same as SRC. Runs without escapes are copied
+ * at once. Returns the decoded length or (size_t) -1 if SRC contains
+ * the escaped nul character which nul terminated strings can't hold.
+ */
+size_t skUtf8_unescape(char *dst, const char *src, size_t len);
+
+#endif
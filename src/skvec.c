@@ -13,60 +13,129 @@ struct skVec {
     size_t         ele_size;
     size_t         capacity;
     size_t         len;
+    skPool*        pool; /* Storage is owned by the pool if set */
 };
 
-skVec* skVec_new(const size_t ele_size)
+/* Elements allocated together with the vector start right after the header,
+ * header is padded so they are aligned the same way as a separate allocation.
+ * Vectors made by 'skVec_with_slot' have the owner's pointer right after the
+ * vector itself, on 64-bit targets it fits into the padding. */
+#define VEC_ALIGN(size)      (((size) + 15) & ~(size_t) 15)
+#define VEC_HEADER_SIZE      VEC_ALIGN(sizeof(skVec))
+#define VEC_SLOT_HEADER_SIZE VEC_ALIGN(sizeof(skVec) + sizeof(void*))
+/* Storage allocated together with the vector, it is never freed on its own.
+ * Storage allocated separately can't start inside of the vector's own block,
+ * which always spans the whole header. */
+#define _skVec_inline(vec)                                                    \
+    ((vec)->allocation == (unsigned char*) (vec) + VEC_HEADER_SIZE            \
+     || (vec)->allocation == (unsigned char*) (vec) + VEC_SLOT_HEADER_SIZE)
+
+/* Allocates the vector and uninitialized storage for exactly 'capacity' elements
+ * in one block from the 'pool' or the heap if 'pool' is NULL. With 'slot' the
+ * block has room for the owner's pointer as well, it starts out as NULL. */
+static skVec*
+_skVec_alloc(const size_t ele_size, const size_t capacity, skPool* pool, bool slot)
 {
     skVec* vec;
+    size_t header;
+    size_t amount;
 
-    vec = malloc(sizeof(skVec));
-    if(is_null(vec)) {
+    if(capacity > 0 && ele_size == 0) {
+#ifdef SK_ERRMSG
+        THROW_ERR(ZeroSizedType);
+#endif
+        return NULL;
+    }
+
+    header = (slot) ? VEC_SLOT_HEADER_SIZE : VEC_HEADER_SIZE;
+
+    if(capacity > 0 && capacity > (INT_MAX - header) / ele_size) {
+#ifdef SK_ERRMSG
+        THROW_ERR(AllocationTooLarge);
+#endif
+        return NULL;
+    }
+
+    /* Whole header is allocated even without elements, so storage allocated
+     * later can't start where the inline one would */
+    amount = header + capacity * ele_size;
+
+    if(is_some(pool)) {
+        vec = skPool_alloc(pool, amount);
+    } else if(is_null(vec = malloc(amount))) {
 #ifdef SK_ERRMSG
         THROW_ERR(OutOfMemory);
 #endif
+    }
+
+    if(is_null(vec)) {
         return NULL;
     }
 
     vec->ele_size   = ele_size;
-    vec->capacity   = 0;
+    vec->capacity   = capacity;
     vec->len        = 0;
-    vec->allocation = NULL;
+    vec->allocation = (capacity > 0) ? (unsigned char*) vec + header : NULL;
+    vec->pool       = pool;
+
+    if(slot) {
+        *skVec_slot(vec) = NULL;
+    }
 
     return vec;
 }
 
-skVec* skVec_with_capacity(const size_t ele_size, const size_t capacity)
+skVec* skVec_new(const size_t ele_size)
 {
-    skVec* vec;
-    void*  allocation;
+    return _skVec_alloc(ele_size, 0, NULL, false);
+}
 
-    vec = skVec_new(ele_size);
+skVec* skVec_new_in(const size_t ele_size, skPool* pool)
+{
+    return _skVec_alloc(ele_size, 0, pool, false);
+}
+
+skPool* skVec_pool(const skVec* vec)
+{
     if(is_null(vec)) {
         return NULL;
     }
+    return vec->pool;
+}
 
-    allocation = calloc(capacity, ele_size);
-    if(is_null(allocation)) {
-#ifdef SK_ERRMSG
-        THROW_ERR(OutOfMemory);
-#endif
-        return NULL;
-    }
+skVec* skVec_with_capacity(const size_t ele_size, const size_t capacity)
+{
+    return _skVec_alloc(ele_size, capacity, NULL, false);
+}
 
-    vec->allocation = allocation;
-    vec->capacity   = capacity;
+skVec* skVec_with_capacity_in(const size_t ele_size, const size_t capacity, skPool* pool)
+{
+    /* Nothing to free on failure, pool owns the vector */
+    return _skVec_alloc(ele_size, capacity, pool, false);
+}
 
-    return vec;
+skVec* skVec_with_slot(const size_t ele_size, const size_t capacity, skPool* pool)
+{
+    return _skVec_alloc(ele_size, capacity, pool, true);
 }
 
-static int _skVec_maybe_grow(skVec* vec)
+void** skVec_slot(skVec* vec)
+{
+    return (void**) ((unsigned char*) vec + sizeof(skVec));
+}
+
+/* Grows the storage of 'vec' so that 'additional' more elements fit into it */
+static int _skVec_reserve(skVec* vec, const size_t additional)
 {
     size_t amount;
     size_t cap;
     void*  new_alloc;
 
-    if(vec->len == vec->capacity) {
+    if(vec->capacity - vec->len < additional) {
         cap = (vec->capacity == 0) ? 10 : vec->capacity * 2;
+        while(cap - vec->len < additional) {
+            cap *= 2;
+        }
 
         if((amount = cap * vec->ele_size) > INT_MAX) {
 #ifdef SK_ERRMSG
@@ -75,7 +144,20 @@ static int _skVec_maybe_grow(skVec* vec)
             return 1;
         }
 
-        new_alloc = realloc(vec->allocation, amount);
+        if(is_some(vec->pool)) {
+            /* Old storage stays in the pool until the pool is dropped */
+            if(is_some(new_alloc = skPool_alloc(vec->pool, amount)) && vec->len > 0) {
+                memcpy(new_alloc, vec->allocation, vec->len * vec->ele_size);
+            }
+        } else if(_skVec_inline(vec)) {
+            /* Inline storage stays with the header, elements move out of it */
+            if(is_some(new_alloc = malloc(amount)) && vec->len > 0) {
+                memcpy(new_alloc, vec->allocation, vec->len * vec->ele_size);
+            }
+        } else {
+            new_alloc = realloc(vec->allocation, amount);
+        }
+
         if(is_null(new_alloc)) {
 #ifdef SK_ERRMSG
             THROW_ERR(OutOfMemory);
@@ -90,6 +172,11 @@ static int _skVec_maybe_grow(skVec* vec)
     return 0;
 }
 
+static int _skVec_maybe_grow(skVec* vec)
+{
+    return _skVec_reserve(vec, 1);
+}
+
 static void* _skVec_get(const skVec* vec, const size_t index)
 {
     return (vec->allocation + (index * vec->ele_size));
@@ -188,6 +275,12 @@ void skVec_clear(skVec* vec, FreeFn free_fn)
         }
     }
 
+    if(is_some(vec->pool) || _skVec_inline(vec)) {
+        /* Pooled and inline storage can't be freed, keep it for reuse */
+        vec->len = 0;
+        return;
+    }
+
     free(vec->allocation);
     vec->allocation = NULL;
     vec->capacity   = 0;
@@ -324,6 +417,25 @@ void* skVec_index(const skVec* vec, const size_t index)
     return _skVec_get(vec, index);
 }
 
+bool skVec_append(skVec* vec, skVec* other)
+{
+    if(is_null(vec) || is_null(other) || vec->ele_size != other->ele_size) {
+        return false;
+    }
+
+    if(_skVec_reserve(vec, other->len) == 1) {
+        return false;
+    }
+
+    if(other->len > 0) {
+        memcpy(_skVec_get(vec, vec->len), other->allocation, other->len * other->ele_size);
+    }
+
+    vec->len   += other->len;
+    other->len  = 0;
+    return true;
+}
+
 bool skVec_pop(skVec* vec, void* dst)
 {
     if(is_null(vec) || vec->len == 0 || is_null(dst)) {
@@ -447,12 +559,16 @@ void skVec_drop(skVec* vec, FreeFn free_fn)
             assert(vec->len == 0);
 #endif
         }
-        free(vec->allocation);
+        if(is_null(vec->pool) && !_skVec_inline(vec)) {
+            free(vec->allocation);
+        }
     }
 
     vec->allocation = NULL;
     vec->capacity   = 0;
     vec->ele_size   = 0;
     vec->len        = 0;
-    free(vec);
+    if(is_null(vec->pool)) {
+        free(vec);
+    }
 }
@@ -1,6 +1,7 @@
 #ifndef __SK_VEC_H__
 #define __SK_VEC_H__
 
+#include "skpool.h"
 #include "sktypes.h"
 #include <stdio.h>
 
@@ -8,10 +9,38 @@ typedef struct skVec skVec;
 
 skVec *skVec_new(const size_t ele_size);
 
+/* Vector with uninitialized storage for exactly CAPACITY elements, allocated
+ * in one block with the vector. Elements move to a separate allocation only
+ * once the vector outgrows it. */
 skVec *skVec_with_capacity(const size_t ele_size, const size_t capacity);
 
+/* Vector that allocates itself and its storage from POOL, storage is never
+ * freed by the vector. */
+skVec *skVec_new_in(const size_t ele_size, skPool *pool);
+
+/* Same as 'skVec_with_capacity' but allocated from POOL. */
+skVec *skVec_with_capacity_in(const size_t ele_size, const size_t capacity,
+                              skPool *pool);
+
+/* Same as 'skVec_with_capacity_in' (heap if POOL is NULL) but the vector has
+ * room for one pointer of its owner, see 'skVec_slot'. */
+skVec *skVec_with_slot(const size_t ele_size, const size_t capacity,
+                       skPool *pool);
+
+/* Returns the owner's pointer of VEC made by 'skVec_with_slot', it is NULL
+ * until the owner sets it and the vector never touches it. Calling this on
+ * any other vector is undefined. */
+void **skVec_slot(skVec *vec);
+
+/* Returns the pool VEC allocates from or NULL if it uses the heap. */
+skPool *skVec_pool(const skVec *vec);
+
 bool skVec_push(skVec *vec, const void *element);
 
+/* Moves all elements of OTHER to the end of VEC, OTHER is left empty.
+ * Returns false if VEC could not grow, OTHER is left untouched then. */
+bool skVec_append(skVec *vec, skVec *other);
+
 bool skVec_pop(skVec *vec, void* dst);
 
 size_t skVec_len(const skVec *vec);
@@ -1,8 +1,11 @@
 /* clang-format off */
+#include "../src/skindex.h"
 #include "../src/skparser.h"
 #include "../src/skjson.h"
 #include <criterion/criterion.h>
 #include <fcntl.h>
+#include <float.h>
+#include <limits.h>
 #include <unistd.h>
 /* clang-format on */
 
@@ -141,17 +144,12 @@ Test(SkJson, ParseTokens)
     cr_assert(*(token.lexeme.ptr + token.lexeme.len - 1) == 'v');
     cr_assert(token.lexeme.len == 8);
 
-    skScanner_skip_until(scanner, 1, SK_DIGIT);
+    skScanner_skip_until(scanner, 1, SK_NUMBER);
     token = skScanner_peek(scanner);
-    cr_assert(SK_DIGIT == token.type);
-
-    token = skScanner_next(scanner);
-    cr_assert(SK_DIGIT == token.type);
-    cr_assert(SK_DIGIT == skScanner_peek(scanner).type);
-
-    token = skScanner_next(scanner);
-    cr_assert(SK_DIGIT == token.type);
-    cr_assert(SK_DIGIT == skScanner_peek(scanner).type);
+    cr_assert(SK_NUMBER == token.type);
+    cr_assert(token.lexeme.len == 3);
+    cr_assert(token.number.mantissa == 152);
+    cr_assert(!token.number.is_double);
 
     token = skScanner_next(scanner);
     cr_assert(SK_COMMA == token.type);
@@ -163,20 +161,11 @@ Test(SkJson, ParseTokens)
     cr_assert(SK_WS == (token = skScanner_next(scanner)).type);
     cr_assert(SK_COLON == (token = skScanner_next(scanner)).type);
     cr_assert(SK_WS == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_HYPHEN == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DOT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_EXP == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_PLUS == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_ZERO == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_ZERO == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_ZERO == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
+    cr_assert(SK_NUMBER == (token = skScanner_next(scanner)).type);
+    cr_assert(token.lexeme.len == 14);
+    cr_assert(token.number.negative && token.number.is_double);
+    cr_assert(token.number.mantissa == 12523);
+    cr_assert(token.number.exponent == 12);
     cr_assert(SK_COMMA == (token = skScanner_next(scanner)).type);
     cr_assert(SK_NL == (token = skScanner_next(scanner)).type);
     cr_assert(SK_WS == (token = skScanner_next(scanner)).type);
@@ -217,13 +206,11 @@ Test(SkJson, ParseTokens)
     cr_assert(SK_NULL == (token = skScanner_next(scanner)).type);
     cr_assert(strncmp(token.lexeme.ptr, "null", token.lexeme.len) == 0);
     cr_assert(SK_COMMA == (token = skScanner_next(scanner)).type);
-    skScanner_skip_until(scanner, 1, SK_ZERO);
+    /* Leading zero is not allowed, whole number is one invalid token */
+    skScanner_skip_until(scanner, 1, SK_INVALID);
     token = skScanner_peek(scanner);
-    cr_assert(SK_ZERO == token.type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DOT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
-    cr_assert(SK_DIGIT == (token = skScanner_next(scanner)).type);
+    cr_assert(SK_INVALID == token.type);
+    cr_assert(token.lexeme.len == 5);
     cr_assert(SK_COMMA == (token = skScanner_next(scanner)).type);
     cr_assert(SK_NL == (token = skScanner_next(scanner)).type);
 
@@ -245,14 +232,14 @@ Test(SkJson, ParsePrimitives)
 
     skJson str_node = skparse_json_string(scanner, NULL);
     cr_assert(str_node.type != SK_NONE_NODE);
-    cr_assert_eq(strcmp(str_node.data.j_string, "glossary"), 0);
+    cr_assert_eq(strcmp(Node_string(&str_node), "glossary"), 0);
     cr_assert(str_node.type == SK_STRING_NODE);
     skJson_drop(&str_node);
     cr_assert(str_node.type == SK_NONE_NODE);
 
-    skScanner_skip_until(scanner, 1, SK_DIGIT);
+    skScanner_skip_until(scanner, 1, SK_NUMBER);
     token = skScanner_peek(scanner);
-    cr_assert(SK_DIGIT == token.type);
+    cr_assert(SK_NUMBER == token.type);
 
     skJson num_node = skparse_json_number(scanner, NULL);
     cr_assert_eq(num_node.data.j_int, 152);
@@ -260,9 +247,9 @@ Test(SkJson, ParsePrimitives)
     skJson_drop(&num_node);
     cr_assert(num_node.type == SK_NONE_NODE);
 
-    skScanner_skip_until(scanner, 1, SK_HYPHEN);
+    skScanner_skip_until(scanner, 1, SK_NUMBER);
     token = skScanner_peek(scanner);
-    cr_assert_eq(token.type, SK_HYPHEN);
+    cr_assert_eq(token.type, SK_NUMBER);
 
     skJson dbl_node = skparse_json_number(scanner, NULL);
     cr_assert(dbl_node.type == SK_DOUBLE_NODE);
@@ -290,8 +277,8 @@ Test(SkJson, ParsePrimitives)
     skJson_drop(&null_node);
     cr_assert(null_node.type == SK_NONE_NODE);
 
-    skScanner_skip_until(scanner, 1, SK_ZERO);
-    cr_assert(SK_ZERO == (token = skScanner_peek(scanner)).type);
+    skScanner_skip_until(scanner, 1, SK_INVALID);
+    cr_assert(SK_INVALID == (token = skScanner_peek(scanner)).type);
 
     skJson err_node = skparse_json_number(scanner, NULL);
     cr_assert(SK_ERROR_NODE == err_node.type);
@@ -336,45 +323,31 @@ Test(skJsonComplex, ParseObjects)
     skJson* temp;
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 0)))->type == SK_STRING_NODE);
-    cr_assert_str_eq(temp->data.j_string, "one");
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert_str_eq(Node_string(temp), "one");
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 1)))->type == SK_STRING_NODE);
-    cr_assert_str_eq(temp->data.j_string, "two");
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert_str_eq(Node_string(temp), "two");
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 2)))->type == SK_INT_NODE);
     cr_assert(temp->data.j_int == 3);
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 3)))->type == SK_DOUBLE_NODE);
     cr_assert(temp->data.j_double == 4.0e+1);
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 4)))->type == SK_BOOL_NODE);
     cr_assert(temp->data.j_boolean == true);
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 5)))->type == SK_BOOL_NODE);
     cr_assert(temp->data.j_boolean == false);
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
 
     cr_assert((temp = ((skJson*) skVec_index(nodes, 6)))->type == SK_NULL_NODE);
-    cr_assert(temp->parent_arena.type == SK_ARRAY_NODE);
-    cr_assert(temp->parent_arena.ptr != NULL);
-    cr_assert(skVec_len((skVec*) temp->parent_arena.ptr) == 7);
+    cr_assert(temp->flags & SK_NODE_IN_ARRAY);
     skJson_drop(&arr_node);
     cr_assert(arr_node.type == SK_NONE_NODE);
 
@@ -389,8 +362,8 @@ Test(skJsonComplex, ParseObjects)
     skJson json_string = skJsonNode_parse(scanner, NULL);
     cr_assert(json_string.type != SK_NONE_NODE);
     cr_assert(json_string.type == SK_STRING_NODE);
-    cr_assert_str_eq(json_string.data.j_string, "obj");
-    cr_assert(json_string.parent_arena.ptr == NULL);
+    cr_assert_str_eq(Node_string(&json_string), "obj");
+    cr_assert(!(json_string.flags & SK_NODE_LINKED));
     skJson_drop(&json_string);
     cr_assert(json_string.type == SK_NONE_NODE);
 
@@ -401,7 +374,7 @@ Test(skJsonComplex, ParseObjects)
     skJson json_object = skJsonNode_parse(scanner, NULL);
     cr_assert(json_object.type != SK_NONE_NODE);
     cr_assert_eq(json_object.type, SK_OBJECT_NODE);
-    cr_assert(json_object.parent_arena.ptr == NULL);
+    cr_assert(!(json_object.flags & SK_NODE_LINKED));
 
     skVec* table = json_object.data.j_object;
     cr_assert(skVec_len(table) == 5);
@@ -446,7 +419,7 @@ Test(skJsonComplex, ParseWhole)
     skJson root = skJsonNode_parse(scanner, NULL);
     cr_assert(root.type != SK_NONE_NODE);
     cr_assert(root.type == SK_OBJECT_NODE);
-    cr_assert(root.parent_arena.ptr == NULL);
+    cr_assert(!(root.flags & SK_NODE_LINKED));
     cr_assert(root.data.j_object != NULL);
 
     skVec* table = root.data.j_object;
@@ -775,3 +748,1025 @@ Test(skJsonFinal, ParseComplete)
     cr_assert(out != NULL);
     free(out);
 }
+
+Test(skJsonIndex, Structurals)
+{
+    /* Escaped quote and structurals inside of the string are not indexed,
+     * input spans two 32 byte blocks. */
+    char            json[] = "{\"k\\\"ey\" : [true, -1.5e+3],\n \"s\": \"{[a long string,: ]}\"}";
+    size_t          expected[] = { 0, 1, 7, 9, 11, 12, 16, 18, 25, 26, 29, 31, 32, 34, 55, 56 };
+    skStructIndex*  index;
+    size_t          i;
+
+    index = skStructIndex_new(json, sizeof(json) - 1);
+    cr_assert(index != NULL);
+    cr_assert_eq(index->len, sizeof(expected) / sizeof(expected[0]));
+    for(i = 0; i < index->len; i++) {
+        cr_assert_eq(index->offsets[i], expected[i]);
+    }
+    /* Sentinel */
+    cr_assert_eq(index->offsets[index->len], sizeof(json) - 1);
+    skStructIndex_drop(index);
+
+    skJson root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(&root), SK_OBJECT_NODE);
+    cr_assert_eq(skJson_object_len(&root), 2);
+    cr_assert_str_eq(skJson_object_index(&root, 0)->key, "k\"ey");
+    cr_assert_eq(skJson_array_len(&skJson_object_index(&root, 0)->value), 2);
+    cr_assert_str_eq(
+        skJson_string_ref_unsafe(&skJson_object_index(&root, 1)->value),
+        "{[a long string,: ]}");
+    skJson_drop(&root);
+}
+
+Test(skJsonNode, Compact)
+{
+    char   json[] = "{\"a\": [1, 2], \"b\": null}";
+    skJson root, *array;
+
+    /* Type tag and flags in front of the payload, no parent pointer */
+    if(sizeof(void*) == 8) {
+        cr_assert_eq(sizeof(skJson), 16);
+        cr_assert_eq(sizeof(skObjTuple), 24);
+    }
+
+    root  = skJson_parse(json, sizeof(json) - 1);
+    array = skJson_objtuple_value(skJson_object_index(&root, 0));
+    cr_assert_eq(skJson_parent_type(&root), SK_NONE_NODE);
+    cr_assert_eq(skJson_parent_type(array), SK_OBJECT_NODE);
+    cr_assert_eq(skJson_parent_type(skJson_array_index(array, 1)), SK_ARRAY_NODE);
+
+    /* Contained elements are replaced with null in place */
+    skJson_drop(skJson_array_index(array, 0));
+    cr_assert_eq(skJson_type(skJson_array_index(array, 0)), SK_NULL_NODE);
+    skJson_drop(array);
+    cr_assert_eq(skJson_type(skJson_objtuple_value(skJson_object_index(&root, 0))), SK_NULL_NODE);
+    cr_assert_eq(skJson_object_len(&root), 2);
+    skJson_drop(&root);
+    cr_assert_eq(skJson_type(&root), SK_NONE_NODE);
+}
+
+Test(skJsonObject, HashIndex)
+{
+    skJson     object;
+    skObjTuple popped;
+    char       key[16];
+    int        cntrl;
+    long       i;
+
+    object = skJson_object_new();
+    for(i = 0; i < 100; i++) {
+        sprintf(key, "k%ld", i);
+        cr_assert(skJson_object_push_int(&object, key, i));
+    }
+
+    /* Unsorted object is looked up through the index regardless of 'sorted' */
+    cr_assert_eq(skJson_integer_value(skJson_objtuple_value(skJson_object_index_by_key(&object, "k42", true)), &cntrl), 42);
+    cr_assert_not(skJson_object_contains(&object, "k100", false));
+
+    /* Pushed members are picked up, last duplicate wins like with the scan */
+    cr_assert(skJson_object_push_int(&object, "k7", -7));
+    cr_assert_eq(skJson_integer_value(skJson_objtuple_value(skJson_object_index_by_key(&object, "k7", false)), &cntrl), -7);
+
+    /* Positions shift */
+    cr_assert(skJson_object_insert_null(&object, "first", 0));
+    cr_assert_eq(skJson_integer_value(skJson_objtuple_value(skJson_object_index_by_key(&object, "k99", false)), &cntrl), 99);
+    cr_assert(skJson_object_remove_by_key(&object, "k10", false));
+    cr_assert_not(skJson_object_contains(&object, "k10", false));
+    cr_assert_eq(skJson_integer_value(skJson_objtuple_value(skJson_object_index_by_key(&object, "k11", false)), &cntrl), 11);
+
+    cr_assert(skJson_object_sort(&object));
+    cr_assert_str_eq(skJson_objtuple_key_ref_unsafe(skJson_object_index_by_key(&object, "first", false)), "first");
+    cr_assert_eq(skJson_integer_value(skJson_objtuple_value(skJson_object_index_by_key(&object, "k55", true)), &cntrl), 55);
+
+    cr_assert(skJson_object_pop(&object, &popped));
+    cr_assert_not(skJson_object_contains(&object, popped.key, false));
+    free(popped.key);
+    skJson_drop(&popped.value);
+
+    skJson_object_clear(&object);
+    cr_assert_not(skJson_object_contains(&object, "k1", false));
+    skJson_drop(&object);
+}
+
+Test(skJsonVec, InlineStorage)
+{
+    skVec* vec;
+    skJson object;
+    long   i;
+
+    /* Storage comes with the vector and elements survive moving out of it */
+    vec = skVec_with_capacity(sizeof(long), 4);
+    for(i = 0; i < 100; i++) {
+        cr_assert(skVec_push(vec, &i));
+    }
+    cr_assert(skVec_capacity(vec) >= 100);
+    for(i = 0; i < 100; i++) {
+        cr_assert_eq(*(long*) skVec_index(vec, i), i);
+    }
+    skVec_clear(vec, NULL);
+    cr_assert_eq(skVec_len(vec), 0);
+    skVec_drop(vec, NULL);
+
+    /* Small containers built by hand never allocate their elements separately */
+    object = skJson_object_new();
+    cr_assert_eq(skVec_capacity(object.data.j_object), SK_CONTAINER_INLINE);
+    cr_assert(skJson_object_push_int(&object, "a", 1));
+    cr_assert(skJson_object_push_null(&object, "b"));
+    cr_assert_eq(skVec_capacity(object.data.j_object), SK_CONTAINER_INLINE);
+    skJson_object_clear(&object);
+    cr_assert_eq(skVec_capacity(object.data.j_object), SK_CONTAINER_INLINE);
+    skJson_drop(&object);
+}
+
+Test(skJsonNumber, Grammar)
+{
+    char   valid[]   = "[0, -0.5, 1e3, 1E-2, 9223372036854775807, -9223372036854775808]";
+    char*  invalid[] = { "[01]", "[1.]", "[-]", "[1e]", "[.5]", "[+1]", "[1.e5]" };
+    int    cntrl;
+    size_t i;
+
+    skJson root = skJson_parse(valid, sizeof(valid) - 1);
+    cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+    cr_assert_eq(skJson_array_len(&root), 6);
+    cr_assert_eq(skJson_integer_value(skJson_array_index(&root, 0), &cntrl), 0);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 1), &cntrl) == -0.5);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 2), &cntrl) == 1e3);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 3), &cntrl) == 1e-2);
+    cr_assert_eq(skJson_integer_value(skJson_array_index(&root, 4), &cntrl), LONG_MAX);
+    cr_assert_eq(skJson_integer_value(skJson_array_index(&root, 5), &cntrl), LONG_MIN);
+    skJson_drop(&root);
+
+    for(i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        root = skJson_parse(invalid[i], strlen(invalid[i]));
+        cr_assert_eq(skJson_type(&root), SK_ERROR_NODE);
+        skJson_drop(&root);
+    }
+}
+
+Test(skJsonNumber, Doubles)
+{
+    /* Fast path, Eisel-Lemire, subnormal, truncated mantissa that needs
+     * the slow path (exactly half-way plus a tiny bit) and overflow. */
+    char json[] = "[0.1, 1.7976931348623157e308, 4.9e-324, 2.2250738585072011e-308, "
+                  "9007199254740993.00000000000000000000000000000000000000001, 1e400]";
+    int  cntrl;
+
+    skJson root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 0), &cntrl) == 0.1);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 1), &cntrl) == DBL_MAX);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 2), &cntrl) == 4.9e-324);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 3), &cntrl) == 2.2250738585072011e-308);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 4), &cntrl) == 9007199254740994.0);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 5), &cntrl) == DBL_MAX);
+    skJson_drop(&root);
+}
+
+Test(skJsonNumber, Serialize)
+{
+    char           json[] = "[0.1, -2.5e-7, 1e300, 3.0, -9223372036854775808, 42]";
+    unsigned char* out;
+
+    skJson root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+    out = skJson_serialize(&root);
+    cr_assert(out != NULL);
+    cr_assert_str_eq((char*) out, "[0.1,-2.5e-7,1e300,3.0,-9223372036854775808,42]");
+    free(out);
+    skJson_drop(&root);
+}
+
+Test(skJsonNumber, Raw)
+{
+    char           json[]   = "[18446744073709551617, 0.10000000000000000001, -42, 1.5e2]";
+    char           insitu[] = "{\"id\": 123456789012345678901234567890, \"n\": 7}";
+    char           tail[]   = "-12";
+    const char*    text;
+    unsigned char* out;
+    size_t         len;
+    int            cntrl;
+
+    skJson root = skJson_parse_flags(json, sizeof(json) - 1, SKJS_RAW_NUMBERS);
+    cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+    cr_assert_eq(skJson_type(skJson_array_index(&root, 0)), SKJS_RAWNUM);
+    text = skJson_rawnum_value(skJson_array_index(&root, 1), &len);
+    cr_assert_eq(len, 22);
+    cr_assert_eq(strncmp(text, "0.10000000000000000001", len), 0);
+    cr_assert_eq(skJson_integer_value(skJson_array_index(&root, 2), &cntrl), -42);
+    cr_assert_eq(cntrl, 0);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 3), &cntrl) == 150.0);
+    /* Fraction or out of range can't be read as an integer */
+    skJson_integer_value(skJson_array_index(&root, 3), &cntrl);
+    cr_assert_eq(cntrl, -1);
+    skJson_integer_value(skJson_array_index(&root, 0), &cntrl);
+    cr_assert_eq(cntrl, -1);
+    cr_assert(skJson_double_value(skJson_array_index(&root, 0), &cntrl) == 18446744073709551616.0);
+    out = skJson_serialize(&root);
+    cr_assert_str_eq((char*) out, "[18446744073709551617,0.10000000000000000001,-42,1.5e2]");
+    free(out);
+    skJson_drop(&root);
+
+    /* Parsed in situ the text points into the buffer */
+    root = skJson_parse_flags(insitu, sizeof(insitu) - 1, SKJS_RAW_NUMBERS | SKJS_FILE_BORROW);
+    cr_assert_eq(skJson_type(&root), SK_OBJECT_NODE);
+    text = skJson_rawnum_value(skJson_objtuple_value(skJson_object_index(&root, 0)), &len);
+    cr_assert(text > insitu && text < insitu + sizeof(insitu));
+    cr_assert_eq(len, 30);
+    cr_assert_eq(skJson_integer_value(skJson_objtuple_value(skJson_object_index(&root, 1)), &cntrl), 7);
+    skJson_drop(&root);
+
+    /* Number at the very end of the buffer has nothing to stop at, it gets copied */
+    root = skJson_parse_flags(tail, sizeof(tail) - 1, SKJS_RAW_NUMBERS | SKJS_FILE_BORROW);
+    text = skJson_rawnum_value(&root, &len);
+    cr_assert(text != tail);
+    cr_assert_eq(skJson_integer_value(&root, &cntrl), -12);
+    skJson_drop(&root);
+
+    /* Without the flag integers out of range of 'long' become doubles */
+    root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(skJson_array_index(&root, 0)), SK_DOUBLE_NODE);
+    skJson_drop(&root);
+}
+
+Test(skJsonArena, ParseAndDrop)
+{
+    char       json[]    = "{\"name\": \"arena\", \"list\": [1, \"two\", {\"three\": 3.0}], \"none\": null}";
+    char       invalid[] = "{\"name\": \"arena\", \"list\": [1, 2,]}";
+    skJsonDoc* doc;
+    skJson*    root;
+    skJson*    list;
+    skJson     element;
+    int        cntrl;
+
+    doc = skJson_parse_arena(json, sizeof(json) - 1);
+    cr_assert(doc != NULL);
+    root = skJsonDoc_root(doc);
+    cr_assert_eq(skJson_type(root), SK_OBJECT_NODE);
+    cr_assert_str_eq(skJson_objtuple_key_ref_unsafe(skJson_object_index(root, 0)), "name");
+    cr_assert_str_eq(skJson_string_ref_unsafe(skJson_objtuple_value(skJson_object_index(root, 0))),
+                     "arena");
+
+    list = skJson_objtuple_value(skJson_object_index_by_key(root, "list", false));
+    cr_assert_eq(skJson_type(list), SK_ARRAY_NODE);
+    cr_assert_eq(skJson_array_len(list), 3);
+    cr_assert_eq(skJson_integer_value(skJson_array_index(list, 0), &cntrl), 1);
+    cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(list, 1)), "two");
+
+    /* Insertions are allocated from the arena, heap allocated elements with
+     * payload can't be moved in and transforms that allocate are refused */
+    cr_assert(skJson_array_push_str(list, "four"));
+    cr_assert(skJson_object_push_int(root, "five", 5));
+    cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(list, 3)), "four");
+    element = skJson_string_new("heap");
+    cr_assert(!skJson_array_push_element(list, &element));
+    skJson_drop(&element);
+    cr_assert(skJson_transform_into_string(skJson_array_index(list, 0), "one") == NULL);
+    cr_assert(skJson_array_remove(list, 1));
+    cr_assert_eq(skJson_array_len(list), 3);
+    skJsonDoc_drop(doc);
+
+    doc = skJson_parse_arena(invalid, sizeof(invalid) - 1);
+    cr_assert(doc != NULL);
+    cr_assert_eq(skJson_type(skJsonDoc_root(doc)), SK_ERROR_NODE);
+    cr_assert(skJson_error(skJsonDoc_root(doc)) != NULL);
+    skJsonDoc_drop(doc);
+}
+
+Test(skJsonInsitu, BorrowsBuffer)
+{
+    char    json[] = "{\"key\": \"value\", \"list\": [\"a\", \"b\\\"c\", \"\"], \"n\": 1}";
+    skJson  root;
+    skJson* list;
+    char*   value;
+
+    root = skJson_parse_insitu(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(&root), SK_OBJECT_NODE);
+
+    /* Keys and strings point into the parsed buffer */
+    cr_assert_eq(skJson_objtuple_key_ref_unsafe(skJson_object_index(&root, 0)), json + 2);
+    value = skJson_string_ref_unsafe(skJson_objtuple_value(skJson_object_index(&root, 0)));
+    cr_assert_eq(value, json + 9);
+    cr_assert_str_eq(value, "value");
+    cr_assert_eq(skJson_type(skJson_objtuple_value(skJson_object_index(&root, 0))), SK_REFERENCE_NODE);
+
+    list = skJson_objtuple_value(skJson_object_index_by_key(&root, "list", false));
+    cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(list, 1)), "b\"c");
+    cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(list, 2)), "");
+
+    /* Mixing in owned keys and strings */
+    cr_assert(skJson_object_push_string(&root, "owned", "string"));
+    cr_assert(skJson_object_remove(&root, 0));
+    skJson_drop(&root);
+}
+
+Test(skJsonError, Position)
+{
+    char        json[]   = "{\n  \"a\\\"{\": [1,\n    tru]\n}";
+    char        insitu[] = "{\n  \"a\\\"{\": [1,\n    tru]\n}";
+    char        msg[64];
+    skJson      root;
+    skJsonError err;
+
+    /* Error points at the offending token, quoted and escaped brackets
+     * don't count into the depth */
+    root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(&root), SK_ERROR_NODE);
+    cr_assert_str_eq(skJson_error(&root), "Invalid syntax/token while parsing");
+    cr_assert(skJson_error_info(&root, &err));
+    cr_assert_eq(err.code, SKJS_ERR_TOKEN);
+    cr_assert_eq(err.offset, (size_t) (strstr(json, "tru") - json));
+    cr_assert_eq(err.depth, 3);
+    cr_assert_eq(skJson_error_format(&root, msg, sizeof(msg)), 54);
+    cr_assert_str_eq(msg, "Invalid syntax/token while parsing: offset 20, depth 3");
+    /* Truncated but still terminated */
+    cr_assert_eq(skJson_error_format(&root, msg, 8), 54);
+    cr_assert_str_eq(msg, "Invalid");
+    skJson_drop(&root);
+
+    /* Strings decoded in place still end where they used to */
+    root = skJson_parse_insitu(insitu, sizeof(insitu) - 1);
+    cr_assert(skJson_error_info(&root, &err));
+    cr_assert_eq(err.code, SKJS_ERR_TOKEN);
+    cr_assert_eq(err.offset, 20);
+    cr_assert_eq(err.depth, 3);
+    skJson_drop(&root);
+
+    /* Input ended early, offset is the length of the input */
+    root = skJson_parse(json, 17);
+    cr_assert(skJson_error_info(&root, &err));
+    cr_assert_eq(err.code, SKJS_ERR_TOKEN);
+    cr_assert_eq(err.offset, 17);
+    cr_assert_eq(err.depth, 3);
+    skJson_drop(&root);
+
+    root = skJson_array_new();
+    cr_assert_not(skJson_error_info(&root, &err));
+    cr_assert_eq(skJson_error_format(&root, msg, sizeof(msg)), 0);
+    skJson_drop(&root);
+}
+
+Test(skJsonParser, MaxDepth)
+{
+    /* Deepest accepted document, one level too deep and hostile input
+     * that would overflow the stack of a recursive parser */
+    size_t depths[] = {SK_MAX_DEPTH, SK_MAX_DEPTH + 1, 1000000};
+    size_t i, n, depth;
+    char*  json;
+    skJson root;
+
+    for(i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        depth = depths[i];
+        json  = malloc(2 * depth);
+        cr_assert(json != NULL);
+        for(n = 0; n < depth; n++) {
+            json[n]                 = '[';
+            json[2 * depth - 1 - n] = ']';
+        }
+
+        root = skJson_parse(json, 2 * depth);
+        if(depth <= SK_MAX_DEPTH) {
+            cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+        } else {
+            cr_assert_eq(skJson_type(&root), SK_ERROR_NODE);
+            cr_assert(strstr(skJson_error(&root), "maximum nesting depth exceeded") != NULL);
+        }
+        skJson_drop(&root);
+        free(json);
+    }
+}
+
+Test(skJsonParser, Chunked)
+{
+    /* Splits inside of strings, escapes, numbers and literals */
+    const char* docs[] = {
+        "{\"key\": [1, -2.5e-3, true, false, null, \"s\\\"tr\"], \"o\": {\"n\": 12345}}",
+        "[1,\n 2,\n x]",
+        "{\"a\":}",
+        "[\"unterminated",
+        "[1\xff,2]", /* Byte 0xFF is not the end of the chunk */
+        "\xff[1]",
+    };
+    skJsonParser*  parser;
+    skJson         expected, root;
+    unsigned char *out_expected, *out;
+    skJsonError    err, err_expected;
+    char           copy[128];
+    size_t         i, cut, len;
+
+    parser = skJsonParser_new();
+    cr_assert(parser != NULL);
+
+    for(i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        len = strlen(docs[i]);
+        memcpy(copy, docs[i], len);
+        expected = skJson_parse(copy, len);
+
+        for(cut = 0; cut <= len; cut++) {
+            cr_assert(skJsonParser_feed(parser, docs[i], cut) || skJson_type(&expected) == SK_ERROR_NODE);
+            skJsonParser_feed(parser, docs[i] + cut, len - cut);
+            root = skJsonParser_finish(parser);
+
+            cr_assert_eq(skJson_type(&root), skJson_type(&expected));
+            if(skJson_type(&root) == SK_ERROR_NODE) {
+                cr_assert_str_eq(skJson_error(&root), skJson_error(&expected));
+                cr_assert(skJson_error_info(&root, &err));
+                cr_assert(skJson_error_info(&expected, &err_expected));
+                cr_assert_eq(err.offset, err_expected.offset);
+                cr_assert_eq(err.depth, err_expected.depth);
+            } else {
+                out_expected = skJson_serialize(&expected);
+                out          = skJson_serialize(&root);
+                cr_assert_str_eq((char*) out, (char*) out_expected);
+                free(out_expected);
+                free(out);
+            }
+            skJson_drop(&root);
+        }
+        skJson_drop(&expected);
+    }
+
+    skJsonParser_drop(parser);
+}
+
+Test(skJsonParser, LongTokens)
+{
+    /* Tokens spanning many chunks, escapes and digits split at every byte */
+    char           doc[4096];
+    char           copy[sizeof(doc)];
+    skJsonParser*  parser;
+    skJson         expected, root;
+    unsigned char *out_expected, *out;
+    size_t         i, len, chunk;
+
+    memcpy(doc, "{\"s\": \"", 7);
+    for(len = 7; len < 2000; len += 3) {
+        memcpy(doc + len, (len % 2) ? "a\\\"" : "\\\\b", 3);
+    }
+    memcpy(doc + len, "\", \"n\": [-", 10);
+    for(len += 10; len < 4000; len++) {
+        doc[len] = '0' + len % 10;
+    }
+    memcpy(doc + len, "e5]}", 4);
+    len += 4;
+
+    memcpy(copy, doc, len);
+    expected = skJson_parse(copy, len);
+    cr_assert_eq(skJson_type(&expected), SK_OBJECT_NODE);
+    out_expected = skJson_serialize(&expected);
+
+    parser = skJsonParser_new();
+    cr_assert(parser != NULL);
+
+    for(chunk = 1; chunk <= 7; chunk++) {
+        for(i = 0; i < len; i += chunk) {
+            cr_assert(skJsonParser_feed(parser, doc + i, (len - i < chunk) ? len - i : chunk));
+        }
+        root = skJsonParser_finish(parser);
+        out  = skJson_serialize(&root);
+        cr_assert_str_eq((char*) out, (char*) out_expected);
+        free(out);
+        skJson_drop(&root);
+    }
+
+    free(out_expected);
+    skJson_drop(&expected);
+    skJsonParser_drop(parser);
+}
+
+Test(skJsonParser, Reuse)
+{
+    const char* docs[] = {
+        "{\"id\": 1, \"method\": \"get\", \"params\": [\"a\", {\"b\": null}]}",
+        "[1, 2, [3, [4]]]",
+        "{\"a\":}",
+        "\"scalar\"",
+        "{\"id\": 2, \"method\": \"set\", \"params\": [true, false, 2.5]}",
+    };
+    skJsonParser*  parser;
+    skJson         expected, root;
+    skJson*        arena_root;
+    unsigned char *out_expected, *out;
+    char           copy[128];
+    size_t         i, len;
+
+    parser = skJsonParser_new();
+    cr_assert(parser != NULL);
+
+    /* Unfinished incremental document is abandoned by the next parse */
+    cr_assert(skJsonParser_feed(parser, "[1, 2", 5));
+
+    for(i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        len = strlen(docs[i]);
+        memcpy(copy, docs[i], len);
+        expected = skJson_parse(copy, len);
+
+        memcpy(copy, docs[i], len);
+        root = skJsonParser_parse(parser, copy, len);
+        memcpy(copy, docs[i], len);
+        arena_root = skJsonParser_parse_arena(parser, copy, len);
+        cr_assert(arena_root != NULL);
+
+        cr_assert_eq(skJson_type(&root), skJson_type(&expected));
+        cr_assert_eq(skJson_type(arena_root), skJson_type(&expected));
+        if(skJson_type(&root) == SK_ERROR_NODE) {
+            cr_assert_str_eq(skJson_error(&root), skJson_error(&expected));
+            cr_assert_str_eq(skJson_error(arena_root), skJson_error(&expected));
+        } else {
+            out_expected = skJson_serialize(&expected);
+            out          = skJson_serialize(&root);
+            cr_assert_str_eq((char*) out, (char*) out_expected);
+            free(out);
+            out = skJson_serialize(arena_root);
+            cr_assert_str_eq((char*) out, (char*) out_expected);
+            free(out);
+            free(out_expected);
+        }
+        skJson_drop(&root);
+        skJson_drop(&expected);
+    }
+
+    /* Parser can still be fed after parsing whole buffers */
+    cr_assert(skJsonParser_feed(parser, "[1]", 3));
+    root = skJsonParser_finish(parser);
+    cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+    skJson_drop(&root);
+
+    skJsonParser_drop(parser);
+}
+
+/* Appends the event into the log passed as 'ctx' */
+static void sax_log(void* ctx, const char* event, const char* slice, size_t len)
+{
+    char* log = ctx;
+    strcat(log, event);
+    if(slice != NULL) {
+        strncat(log, slice, len);
+    }
+    strcat(log, " ");
+}
+
+static skJsonBool sax_start_object(void* ctx) { sax_log(ctx, "{", NULL, 0); return true; }
+static skJsonBool sax_end_object(void* ctx) { sax_log(ctx, "}", NULL, 0); return true; }
+static skJsonBool sax_start_array(void* ctx) { sax_log(ctx, "[", NULL, 0); return true; }
+static skJsonBool sax_end_array(void* ctx) { sax_log(ctx, "]", NULL, 0); return true; }
+static skJsonBool sax_key(void* ctx, const char* key, size_t len) { sax_log(ctx, "k:", key, len); return true; }
+static skJsonBool sax_string(void* ctx, const char* str, size_t len) { sax_log(ctx, "s:", str, len); return true; }
+static skJsonBool sax_number(void* ctx, const char* num, size_t len) { sax_log(ctx, "n:", num, len); return true; }
+static skJsonBool sax_boolean(void* ctx, skJsonBool b) { sax_log(ctx, b ? "true" : "false", NULL, 0); return true; }
+/* Aborts the parsing on the first null */
+static skJsonBool sax_null(void* ctx) { sax_log(ctx, "null", NULL, 0); return false; }
+
+Test(skJsonParallel, MatchesSerial)
+{
+    const size_t   elements = 60000; /* Large enough to be split */
+    char*          buff;
+    size_t         i, len;
+    skJson         expected, root;
+    skJsonError    err, err_expected;
+    unsigned char *out_expected, *out;
+    unsigned int   threads;
+
+    cr_assert((buff = malloc(elements * 80)) != NULL);
+    len = sprintf(buff, "[");
+    for(i = 0; i < elements; i++) {
+        len += sprintf(buff + len, "%s{\"id\": %zu, \"tags\": [\"a,]\", %zu.5, [], {}], \"ok\": true}",
+                       (i == 0) ? "" : ",\n ", i, i);
+    }
+    len += sprintf(buff + len, "]  ");
+
+    expected = skJson_parse(buff, len);
+    cr_assert_eq(skJson_array_len(&expected), elements);
+    out_expected = skJson_serialize(&expected);
+
+    for(threads = 1; threads <= 4; threads += 3) {
+        root = skJson_parse_parallel(buff, len, threads);
+        cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+        cr_assert_eq(skJson_array_len(&root), elements);
+        cr_assert_eq(skJson_parent_type(skJson_array_index(&root, elements - 1)), SK_ARRAY_NODE);
+        out = skJson_serialize(&root);
+        cr_assert_str_eq((char*) out, (char*) out_expected);
+        free(out);
+        skJson_drop(&root);
+    }
+
+    free(out_expected);
+    skJson_drop(&expected);
+
+    /* Broken element close to the end is reported just like the serial parser does */
+    memcpy(strstr(buff + len - 200, "true"), "tru ", 4);
+    expected = skJson_parse(buff, len);
+    root     = skJson_parse_parallel(buff, len, 4);
+    cr_assert_eq(skJson_type(&root), SK_ERROR_NODE);
+    cr_assert(skJson_error_info(&root, &err));
+    cr_assert(skJson_error_info(&expected, &err_expected));
+    cr_assert_eq(err.code, err_expected.code);
+    cr_assert_eq(err.offset, err_expected.offset);
+    skJson_drop(&root);
+    skJson_drop(&expected);
+
+    free(buff);
+}
+
+Test(skJsonTape, Access)
+{
+    const char     json[] = " {\"name\": \"sk\\u00e9\", \"skip\": {\"deep\": [[1], {\"name\": 0}]},"
+                            " \"list\": [1, -2.5, true, null, \"s\", [], {}], \"big\": 1e400} ";
+    const char*    invalid[] = { "[1,]", "{\"a\" 1}", "[1 2]", "[\"\\u0000\"]", "[1] x", "[1]\xff garbage {", "" };
+    const char*    key;
+    skJsonTape*    tape;
+    skJsonTapeRef  root, value, item;
+    skJsonTapeIter iter;
+    skJsonError    err;
+    size_t         len, i;
+    int            cntrl;
+
+    tape = skJsonTape_parse(json, sizeof(json) - 1, &err);
+    cr_assert_not_null(tape);
+    root = skJsonTape_root(tape);
+    cr_assert_eq(skJsonTape_type(root), SKJS_OBJ);
+    cr_assert_eq(skJsonTape_len(root), 4);
+
+    /* Nested member with the same key is not found, the subtree is skipped */
+    cr_assert(skJsonTape_object_get(root, "name", &value));
+    cr_assert_str_eq(skJsonTape_string(value, &len), "sk\xc3\xa9");
+    cr_assert_eq(len, 4);
+    cr_assert_not(skJsonTape_object_get(root, "deep", &value));
+    cr_assert(skJsonTape_object_get(root, "big", &value));
+    cr_assert(skJsonTape_double(value, &cntrl) == DBL_MAX);
+
+    cr_assert(skJsonTape_object_get(root, "list", &value));
+    cr_assert_eq(skJsonTape_len(value), 7);
+    cr_assert(skJsonTape_array_iter(value, &iter));
+    cr_assert(skJsonTape_iter_next(&iter, &key, &item));
+    cr_assert_null(key);
+    cr_assert_eq(skJsonTape_integer(item, &cntrl), 1);
+    cr_assert(skJsonTape_iter_next(&iter, NULL, &item));
+    cr_assert(skJsonTape_double(item, &cntrl) == -2.5);
+    skJsonTape_integer(item, &cntrl);
+    cr_assert_eq(cntrl, -1);
+    cr_assert(skJsonTape_iter_next(&iter, NULL, &item));
+    cr_assert(skJsonTape_bool(item, &cntrl));
+    cr_assert(skJsonTape_iter_next(&iter, NULL, &item));
+    cr_assert_eq(skJsonTape_type(item), SKJS_NULL);
+    cr_assert(skJsonTape_iter_next(&iter, NULL, &item));
+    cr_assert_str_eq(skJsonTape_string(item, NULL), "s");
+    cr_assert(skJsonTape_iter_next(&iter, NULL, &item));
+    cr_assert_eq(skJsonTape_len(item), 0);
+    cr_assert(skJsonTape_iter_next(&iter, NULL, &item));
+    cr_assert_eq(skJsonTape_type(item), SKJS_OBJ);
+    cr_assert_not(skJsonTape_iter_next(&iter, NULL, &item));
+
+    cr_assert(skJsonTape_object_iter(root, &iter));
+    for(i = 0; skJsonTape_iter_next(&iter, &key, &value); i++) {
+        cr_assert_not_null(key);
+    }
+    cr_assert_eq(i, 4);
+    cr_assert_str_eq(key, "big");
+    skJsonTape_drop(tape);
+
+    for(i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        cr_assert_null(skJsonTape_parse(invalid[i], strlen(invalid[i]), &err));
+    }
+    cr_assert_null(skJsonTape_parse("[1,\n {\"a\": x}]", 15, &err));
+    cr_assert_eq(err.code, SKJS_ERR_TOKEN);
+    cr_assert_eq(err.offset, 11);
+    cr_assert_eq(err.depth, 3);
+}
+
+Test(skJsonSax, Events)
+{
+    const char json[] = " {\"a\": [1, -2.5e3, \"x\\ty\", true, {}], \"b\": false, \"c\": null, \"d\": 0} ";
+    skJsonSax  sax    = {sax_start_object, sax_end_object, sax_start_array, sax_end_array, sax_key,
+                         sax_string,       sax_number,     sax_boolean,     NULL};
+    char       log[256];
+
+    log[0] = '\0';
+    cr_assert_eq(skJson_sax_parse(json, sizeof(json) - 1, &sax, log), SKJS_SAX_OK);
+    cr_assert_str_eq(log, "{ k:a [ n:1 n:-2.5e3 s:x\\ty true { } ] k:b false k:c k:d n:0 } ");
+
+    /* Early abort from the callback */
+    log[0]   = '\0';
+    sax.null = sax_null;
+    cr_assert_eq(skJson_sax_parse(json, sizeof(json) - 1, &sax, log), SKJS_SAX_ABORTED);
+    cr_assert_str_eq(log, "{ k:a [ n:1 n:-2.5e3 s:x\\ty true { } ] k:b false k:c null ");
+
+    /* Events are optional, only the grammar is checked */
+    cr_assert_eq(skJson_sax_parse("[1, 2", 5, NULL, NULL), SKJS_SAX_INVALID);
+    cr_assert_eq(skJson_sax_parse("[1, 2]]", 7, NULL, NULL), SKJS_SAX_INVALID);
+    cr_assert_eq(skJson_sax_parse("{\"a\" 1}", 7, NULL, NULL), SKJS_SAX_INVALID);
+    cr_assert_eq(skJson_sax_parse("[01]", 4, NULL, NULL), SKJS_SAX_INVALID);
+    cr_assert_eq(skJson_sax_parse("[1]\xff garbage {", 14, NULL, NULL), SKJS_SAX_INVALID);
+}
+
+/* Counts records that arrived in order, stops after 'limit' records */
+typedef struct {
+    size_t limit;
+    size_t seen;
+} NdjsonCount;
+
+static skJsonBool ndjson_count(void* ctx, size_t index, skJson* record)
+{
+    NdjsonCount* count = ctx;
+    int          cntrl;
+
+    if(index == count->seen && (size_t) skJson_integer_value(record, &cntrl) == index) {
+        count->seen++;
+    }
+    skJson_drop(record);
+    return index + 1 < count->limit;
+}
+
+Test(skJsonNdjson, Ordered)
+{
+    const size_t records = 400000; /* Multiple units of work */
+    char*        buff;
+    size_t       i, len;
+    NdjsonCount  count;
+    skJson       all;
+    skJson*      record;
+    unsigned int threads;
+    int          cntrl;
+
+    cr_assert((buff = malloc(records * 16)) != NULL);
+    for(len = 0, i = 0; i < records; i++) {
+        /* Blank lines, CRLF and a broken record */
+        len += sprintf(buff + len, (i % 1000 == 999) ? "[%zu\n" : "%zu\r\n\n", i);
+    }
+
+    for(threads = 1; threads <= 4; threads += 3) {
+        all = skJson_parse_ndjson(buff, len, threads);
+        cr_assert_eq(skJson_type(&all), SK_ARRAY_NODE);
+        cr_assert_eq(skJson_array_len(&all), records);
+        for(i = 0; i < records; i++) {
+            record = skJson_array_index(&all, i);
+            if(i % 1000 == 999) {
+                cr_assert_eq(skJson_type(record), SK_ERROR_NODE);
+            } else {
+                cr_assert_eq((size_t) skJson_integer_value(record, &cntrl), i);
+            }
+        }
+        skJson_drop(&all);
+    }
+
+    /* Stopping in the middle */
+    count.limit = records / 2;
+    count.seen  = 0;
+    for(len = 0, i = 0; i < records; i++) {
+        len += sprintf(buff + len, "%zu\n", i);
+    }
+    cr_assert_not(skJson_parse_ndjson_each(buff, len, 4, ndjson_count, &count));
+    cr_assert_eq(count.seen, records / 2);
+    count.limit = (size_t) -1;
+    count.seen  = 0;
+    cr_assert(skJson_parse_ndjson_each(buff, len, 4, ndjson_count, &count));
+    cr_assert_eq(count.seen, records);
+
+    free(buff);
+}
+
+Test(skJsonFile, Mapped)
+{
+    const int      flags[] = {0, SKJS_FILE_ARENA, SKJS_FILE_BORROW, SKJS_FILE_ARENA | SKJS_FILE_BORROW};
+    char*          buff;
+    int            file, len;
+    size_t         i;
+    skJson         expected;
+    skJsonDoc*     doc;
+    unsigned char *out_expected, *out;
+
+    cr_assert((file = open("meta_github.json", O_RDONLY)) != -1);
+    cr_assert((len = lseek(file, 0, SEEK_END)) > 0);
+    cr_assert((buff = malloc(len)) != NULL);
+    cr_assert_neq(lseek(file, 0, SEEK_SET), -1);
+    cr_assert_eq(read(file, buff, len), len);
+    close(file);
+
+    expected     = skJson_parse(buff, len);
+    out_expected = skJson_serialize(&expected);
+    cr_assert(out_expected != NULL);
+
+    for(i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        doc = skJson_parse_file("meta_github.json", flags[i]);
+        cr_assert(doc != NULL);
+        out = skJson_serialize(skJsonDoc_root(doc));
+        cr_assert_str_eq((char*) out, (char*) out_expected);
+        free(out);
+        skJsonDoc_drop(doc);
+    }
+
+    cr_assert_null(skJson_parse_file("missing.json", 0));
+
+    free(out_expected);
+    skJson_drop(&expected);
+    free(buff);
+}
+
+Test(skJsonValidate, Offset)
+{
+    struct {
+        const char* json;
+        skJsonBool  valid;
+        size_t      offset;
+    } cases[] = {
+        {" {\"a\": [1, 2.5e-3, true, null, \"\\u00e9\"]}\n", true,  0},
+        {"{\"a\": [1, 2,]}",                                false, 12},
+        {"{\"a\": 01}",                                     false, 6 },
+        {"[\"bad \\x escape\"]",                            false, 1 },
+        {"[1, 2",                                           false, 5 },
+        {"[1] 2",                                           false, 4 },
+        {"[tru]",                                           false, 1 },
+        {"[1]\xff garbage {",                              false, 3 },
+    };
+    size_t i, offset;
+
+    for(i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        offset = 0;
+        cr_assert_eq(skJson_validate(cases[i].json, strlen(cases[i].json), &offset), cases[i].valid);
+        cr_assert_eq(offset, cases[i].offset);
+    }
+
+    cr_assert_not(skJson_validate("", 0, NULL));
+}
+
+Test(skJsonString, Utf8)
+{
+    const char* valid[] = {
+        "",
+        "plain ascii",
+        "h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80 \xef\xbf\xbf \xf4\x8f\xbf\xbf",
+        "escapes \\\" \\\\ \\/ \\b \\f \\n \\r \\t \\u00e9 \\uABCD",
+        "spans the block boundary............\xe2\x82\xac.....................\\u0041",
+    };
+    const char* invalid[] = {
+        "\\u12g4",                                   /* Every hex digit is checked */
+        "\\x",                                       /* Unknown escape */
+        "ends with \\",                              /* Incomplete escape */
+        "\x1f",                                      /* Control character */
+        "raw \" quote",                              /* Unescaped quote */
+        "\xc0\xaf",                                  /* Overlong */
+        "\xe0\x80\xaf",                              /* Overlong */
+        "\xed\xa0\x80",                              /* Surrogate */
+        "\xf4\x90\x80\x80",                          /* Above U+10FFFF */
+        "\x80",                                      /* Stray continuation byte */
+        "truncated \xe2\x82",                        /* Incomplete sequence */
+        "long valid prefix of more than one block \x01",
+    };
+    skStrSlice slice;
+    size_t     i;
+
+    for(i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+        slice = skSlice_new(valid[i], strlen(valid[i]));
+        cr_assert(skJsonString_isvalid(&slice), "%s", valid[i]);
+    }
+
+    for(i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        slice = skSlice_new(invalid[i], strlen(invalid[i]));
+        cr_assert_not(skJsonString_isvalid(&slice), "%s", invalid[i]);
+    }
+}
+
+Test(skJsonString, Inline)
+{
+    char            json[] = "[\"ok\", \"twelve bytes\", \"thirteen byte\", \"\\u00e9t\\u00e9\"]";
+    char            pair[] = "[\"ab\", 1]";
+    unsigned char*  out;
+    skJson          root;
+    skJson*         str;
+    skJsonDoc*      doc;
+
+    root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+
+    /* Short strings live in the node, longer ones on the heap */
+    str = skJson_array_index(&root, 1);
+    cr_assert(str->flags & SK_NODE_INLINE_VALUE);
+    cr_assert_str_eq(skJson_string_ref_unsafe(str), "twelve bytes");
+    str = skJson_array_index(&root, 2);
+    cr_assert_not(str->flags & SK_NODE_INLINE_VALUE);
+    cr_assert_str_eq(skJson_string_ref_unsafe(str), "thirteen byte");
+    cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(&root, 3)), "\xc3\xa9t\xc3\xa9");
+
+    /* Changing the string moves it in and out of the node */
+    str = skJson_array_index(&root, 0);
+    cr_assert(skJson_string_set(str, "a string too long for the node"));
+    cr_assert_not(str->flags & SK_NODE_INLINE_VALUE);
+    cr_assert(skJson_string_set(str, "id"));
+    cr_assert(str->flags & SK_NODE_INLINE_VALUE);
+    cr_assert_str_eq(skJson_string_ref_unsafe(str), "id");
+    cr_assert_not_null(skJson_transform_into_int(skJson_array_index(&root, 2), 1));
+    cr_assert_not_null(skJson_transform_into_string(skJson_array_index(&root, 2), "x"));
+
+    out = skJson_serialize(&root);
+    cr_assert_str_eq((char*) out, "[\"id\",\"twelve bytes\",\"x\",\"\xc3\xa9t\xc3\xa9\"]");
+    free(out);
+    skJson_drop(&root);
+
+    /* Dropped element keeps its flags, the string it is turned into next
+     * must not be read from the node */
+    root = skJson_parse(pair, sizeof(pair) - 1);
+    str  = skJson_array_index(&root, 0);
+    skJson_drop(str);
+    cr_assert_not(str->flags & SK_NODE_INLINE_VALUE);
+    cr_assert_not_null(skJson_transform_into_ref(str, "hello"));
+    cr_assert_str_eq(skJson_string_ref_unsafe(str), "hello");
+    out = skJson_serialize(&root);
+    cr_assert_str_eq((char*) out, "[\"hello\",1]");
+    free(out);
+    skJson_drop(&root);
+
+    doc = skJson_parse_arena(pair, sizeof(pair) - 1);
+    cr_assert(doc != NULL);
+    str = skJson_array_index(skJsonDoc_root(doc), 0);
+    cr_assert(str->flags & SK_NODE_INLINE_VALUE);
+    cr_assert_not_null(skJson_transform_into_ref(str, "hello"));
+    cr_assert_str_eq(skJson_string_ref_unsafe(str), "hello");
+    cr_assert(skJson_ref_set(str, "world"));
+    cr_assert_str_eq(skJson_string_ref_unsafe(str), "world");
+    skJsonDoc_drop(doc);
+}
+
+Test(skJsonString, Unescape)
+{
+    const char json[] = "[\"a\\n\\t\\\"\\\\\\/b\", \"\\u00e9\\u20AC\\ud83d\\ude00\", \"\\ud800x\\udc00\", \"plain\"]";
+    char       buff[sizeof(json)];
+    char       insitu[sizeof(json)];
+    skJson     root;
+    skJson     copy;
+    unsigned char* out;
+    int        pass;
+
+    for(pass = 0; pass < 2; pass++) {
+        memcpy(buff, json, sizeof(json));
+        memcpy(insitu, json, sizeof(json));
+        root = (pass == 0) ? skJson_parse(buff, sizeof(json) - 1)
+                           : skJson_parse_insitu(insitu, sizeof(json) - 1);
+        cr_assert_eq(skJson_type(&root), SK_ARRAY_NODE);
+        cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(&root, 0)), "a\n\t\"\\/b");
+        /* Surrogate pair is a single code point, lone surrogates are replaced */
+        cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(&root, 1)),
+                         "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+        cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(&root, 2)),
+                         "\xef\xbf\xbdx\xef\xbf\xbd");
+        cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(&root, 3)), "plain");
+
+        /* Serializer escapes what needs to be escaped */
+        out = skJson_serialize(&root);
+        cr_assert_str_eq((char*) out,
+                         "[\"a\\n\\t\\\"\\\\/b\",\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\","
+                         "\"\xef\xbf\xbdx\xef\xbf\xbd\",\"plain\"]");
+        copy = skJson_parse((char*) out, strlen((char*) out));
+        cr_assert_str_eq(skJson_string_ref_unsafe(skJson_array_index(&copy, 0)), "a\n\t\"\\/b");
+        skJson_drop(&copy);
+        free(out);
+        skJson_drop(&root);
+    }
+
+    /* Strings are nul terminated */
+    memcpy(buff, "[\"a\\u0000b\"]", 12);
+    root = skJson_parse(buff, 12);
+    cr_assert_eq(skJson_type(&root), SK_ERROR_NODE);
+    skJson_drop(&root);
+
+    /* Elements hold decoded strings, control characters are escaped on the way out */
+    root = skJson_string_new("quote \" and \x01");
+    cr_assert_eq(skJson_type(&root), SK_STRING_NODE);
+    out = skJson_serialize(&root);
+    cr_assert_str_eq((char*) out, "\"quote \\\" and \\u0001\"");
+    free(out);
+    skJson_drop(&root);
+}
+
+Test(skJsonIndex, ContainerSizes)
+{
+    char json[] = "{\"a\": [1, [], {\"b\": \",[\"}], \"c\": [[2, 3, 4]], \"d\": {}}";
+    size_t          expected[] = {3, 3, 0, 1, 1, 3, 0};
+    skStructIndex*  index;
+    skJson          root;
+    skObjTuple*     member;
+    skJson*         arr;
+    size_t          i;
+
+    index = skStructIndex_new(json, sizeof(json) - 1);
+    cr_assert_not_null(index);
+    cr_assert_eq(index->nsizes, sizeof(expected) / sizeof(expected[0]));
+    for(i = 0; i < index->nsizes; i++) {
+        cr_assert_eq(index->sizes[i], expected[i]);
+    }
+    skStructIndex_drop(index);
+
+    /* Containers are allocated exactly as large as they need to be */
+    root = skJson_parse(json, sizeof(json) - 1);
+    cr_assert_eq(root.type, SK_OBJECT_NODE);
+    cr_assert_eq(skVec_capacity(root.data.j_object), 3);
+    member = skVec_index(root.data.j_object, 0);
+    arr    = &member->value;
+    cr_assert_eq(skVec_capacity(arr->data.j_array), 3);
+    cr_assert_eq(skVec_len(arr->data.j_array), 3);
+    member = skVec_index(root.data.j_object, 1);
+    arr    = &member->value;
+    cr_assert_eq(skVec_capacity(arr->data.j_array), 1);
+    arr = skVec_index(arr->data.j_array, 0);
+    cr_assert_eq(skVec_capacity(arr->data.j_array), 3);
+    skJsonNode_drop(&root);
+}